@@ -0,0 +1,244 @@
+/*
+** gptlcmp: compare the binary summary dumps of several runs against a base run.
+**
+** Dumps are written by GPTLpr_summary_file() when GPTLdump_summary is set (see
+** GPTLsetoption). Regions are joined by name through a hash table, so the cost is
+** linear in the number of regions. For each region the mean across ranks of the
+** per-rank max time is compared: a change is significant if Welch's t statistic
+** is at least tmin (when both runs have a standard deviation, i.e. 2 or more ranks)
+** and the change is at least mindiff seconds. Significant changes are listed
+** largest absolute time delta first.
+**
+** Usage: gptlcmp [-m mindiff] [-n listmax] [-t tmin] base.bin run.bin [run.bin ...]
+**
+** Exit status: 0 if no run has a significant regression, 1 if one does, 2 on error.
+** This suits a nightly performance gate.
+*/
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>   /* getopt */
+#include <math.h>
+
+#include "private.h"
+
+typedef struct {
+  const char *file;   /* dump file name */
+  Dumphdr hdr;
+  Dumprec *recs;      /* hdr.nregions records */
+} Dump;
+
+typedef struct {
+  const Dumprec *base;
+  const Dumprec *run;
+  double delta;       /* run mean - base mean */
+  double t;           /* Welch's t statistic, or 0 if undefined */
+} Change;
+
+static int load (const char *, Dump *);
+static unsigned int hash (const char *);
+static int cmp_change (const void *, const void *);
+
+int main (int argc, char **argv)
+{
+  int c;                    /* for getopt parsing */
+  double mindiff = 0.01;    /* ignore changes smaller than this (seconds) */
+  double tmin = 3.;         /* min |t| for a change to be significant */
+  int listmax = 20;         /* max changes listed per run */
+  int ndumps;               /* number of dumps: base plus runs */
+  Dump *dumps;
+  const Dumprec **table;    /* open-addressing hash table of base records */
+  unsigned int tabsize;     /* power of 2, at least twice the base regions */
+  unsigned int h;
+  Change *changes;
+  int nchanges;
+  int nmatched;             /* regions present in both base and run */
+  int nregress;             /* significant increases */
+  int regressed = 0;        /* any run had a significant increase */
+  int d, n;
+  double var;
+
+  while ((c = getopt (argc, argv, "m:n:t:")) != -1) {
+    switch (c) {
+    case 'm':
+      mindiff = atof (optarg);
+      break;
+    case 'n':
+      if ((listmax = atoi (optarg)) < 1) {
+	fprintf (stderr, "-n listmax must be > 0\n");
+	return 2;
+      }
+      break;
+    case 't':
+      tmin = atof (optarg);
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-m mindiff] [-n listmax] [-t tmin] base.bin run.bin [run.bin ...]\n",
+	       argv[0]);
+      return 2;
+    }
+  }
+
+  if ((ndumps = argc - optind) < 2) {
+    fprintf (stderr, "Usage: %s [-m mindiff] [-n listmax] [-t tmin] base.bin run.bin [run.bin ...]\n",
+	     argv[0]);
+    return 2;
+  }
+
+  if ( ! (dumps = (Dump *) calloc (ndumps, sizeof (Dump)))) {
+    fprintf (stderr, "malloc failure\n");
+    return 2;
+  }
+  for (d = 0; d < ndumps; ++d)
+    if (load (argv[optind+d], &dumps[d]) != 0)
+      return 2;
+
+  /* Hash the base regions once; each run is then joined in one pass */
+  for (tabsize = 16; tabsize < 2 * dumps[0].hdr.nregions; tabsize *= 2)
+    ;
+  if ( ! (table = (const Dumprec **) calloc (tabsize, sizeof (Dumprec *)))) {
+    fprintf (stderr, "malloc failure\n");
+    return 2;
+  }
+  for (n = 0; n < (int) dumps[0].hdr.nregions; ++n) {
+    for (h = hash (dumps[0].recs[n].name) & (tabsize-1); table[h]; h = (h + 1) & (tabsize-1))
+      if (STRMATCH (table[h]->name, dumps[0].recs[n].name))
+	break;
+    if ( ! table[h])
+      table[h] = &dumps[0].recs[n];
+  }
+
+  printf ("Base: %s (%u ranks, %u regions)\n", dumps[0].file, dumps[0].hdr.nranks,
+	  dumps[0].hdr.nregions);
+  printf ("Significant: |delta| >= %g seconds and, where both runs have a std. dev.,\n"
+	  "|t| >= %g (Welch's t of the mean across ranks of per-rank max time)\n", mindiff, tmin);
+
+  for (d = 1; d < ndumps; ++d) {
+    if ( ! (changes = (Change *) malloc (MAX (dumps[d].hdr.nregions, 1) * sizeof (Change)))) {
+      fprintf (stderr, "malloc failure\n");
+      return 2;
+    }
+    nchanges = 0;
+    nmatched = 0;
+    nregress = 0;
+    for (n = 0; n < (int) dumps[d].hdr.nregions; ++n) {
+      const Dumprec *run = &dumps[d].recs[n];
+      const Dumprec *base;
+
+      for (h = hash (run->name) & (tabsize-1); table[h]; h = (h + 1) & (tabsize-1))
+	if (STRMATCH (table[h]->name, run->name))
+	  break;
+      if ( ! (base = table[h]))
+	continue;
+      ++nmatched;
+
+      changes[nchanges].base  = base;
+      changes[nchanges].run   = run;
+      changes[nchanges].delta = run->mean - base->mean;
+      changes[nchanges].t     = 0.;
+      if (fabs (changes[nchanges].delta) < mindiff || changes[nchanges].delta == 0.)
+	continue;
+
+      if (base->nranks > 1 && run->nranks > 1) {
+	var = base->stddev * base->stddev / base->nranks + run->stddev * run->stddev / run->nranks;
+	if (var > 0.) {
+	  changes[nchanges].t = changes[nchanges].delta / sqrt (var);
+	  if (fabs (changes[nchanges].t) < tmin)
+	    continue;
+	}
+      }
+      if (changes[nchanges].delta > 0.)
+	++nregress;
+      ++nchanges;
+    }
+    qsort (changes, nchanges, sizeof (Change), cmp_change);
+
+    printf ("\nRun: %s (%u ranks, %u regions)\n", dumps[d].file, dumps[d].hdr.nranks,
+	    dumps[d].hdr.nregions);
+    printf ("%d regions matched, %d only in base, %d only in run: "
+	    "%d significant changes, %d regressions\n",
+	    nmatched, (int) dumps[0].hdr.nregions - nmatched, (int) dumps[d].hdr.nregions - nmatched,
+	    nchanges, nregress);
+    if (nchanges > 0)
+      printf ("%-32s %11s %11s %11s %8s %8s\n", "name", "base_mean", "run_mean", "delta", "rel%", "t");
+    for (n = 0; n < MIN (nchanges, listmax); ++n) {
+      printf ("%-32s %11.3f %11.3f %+11.3f ", changes[n].run->name, changes[n].base->mean,
+	      changes[n].run->mean, changes[n].delta);
+      if (changes[n].base->mean > 0.)
+	printf ("%+8.1f ", 100. * changes[n].delta / changes[n].base->mean);
+      else
+	printf ("%8s ", "-");
+      if (changes[n].t != 0.)
+	printf ("%8.2f", changes[n].t);
+      else
+	printf ("%8s", "-");
+      printf (" %s\n", changes[n].delta > 0. ? "REGRESSION" : "improvement");
+    }
+    if (nregress > 0)
+      regressed = 1;
+    free (changes);
+  }
+  return regressed;
+}
+
+/*
+** load: read a dump file, checking that it was written with this layout
+**
+** Return value: 0 (success) or -1 (failure, with a message printed)
+*/
+static int load (const char *file, Dump *dump)
+{
+  FILE *fp;
+  size_t nread;
+
+  dump->file = file;
+  if ( ! (fp = fopen (file, "rb"))) {
+    fprintf (stderr, "Cannot open %s for reading\n", file);
+    return -1;
+  }
+  if (fread (&dump->hdr, sizeof (Dumphdr), 1, fp) != 1 ||
+      memcmp (dump->hdr.magic, DUMP_MAGIC, sizeof (dump->hdr.magic)) != 0) {
+    fprintf (stderr, "%s is not a GPTL summary dump\n", file);
+    fclose (fp);
+    return -1;
+  }
+  if (dump->hdr.byteorder != DUMP_BYTEORDER || dump->hdr.reclen != sizeof (Dumprec)) {
+    fprintf (stderr, "%s was written on an incompatible architecture or GPTL version\n", file);
+    fclose (fp);
+    return -1;
+  }
+  if ( ! (dump->recs = (Dumprec *) malloc (MAX (dump->hdr.nregions, 1) * sizeof (Dumprec)))) {
+    fprintf (stderr, "malloc failure reading %s\n", file);
+    fclose (fp);
+    return -1;
+  }
+  nread = fread (dump->recs, sizeof (Dumprec), dump->hdr.nregions, fp);
+  fclose (fp);
+  if (nread != dump->hdr.nregions) {
+    fprintf (stderr, "%s is truncated: %lu of %u regions\n", file, (unsigned long) nread,
+	     dump->hdr.nregions);
+    return -1;
+  }
+  return 0;
+}
+
+/* FNV-1a */
+static unsigned int hash (const char *name)
+{
+  unsigned int h = 2166136261u;
+
+  for ( ; *name; ++name)
+    h = (h ^ (unsigned char) *name) * 16777619u;
+  return h;
+}
+
+/* Sort key: absolute time delta, largest first */
+static int cmp_change (const void *a, const void *b)
+{
+  double da = fabs (((const Change *) a)->delta);
+  double db = fabs (((const Change *) b)->delta);
+
+  return (da < db) - (da > db);
+}
@@ -0,0 +1,153 @@
+/*
+** gptllive: print the live timers of a running process which set GPTLlive_stats.
+**
+** The process publishes its timers in the POSIX shared memory segment /gptl.<pid>
+** (layout in private.h, see Livehdr). This tool maps it read-only and copies each
+** record under its seqlock, so it never stops or slows the process. Running regions
+** show how long ago they were started, when the timer has a known epoch origin.
+**
+** Usage: gptllive [-i interval] [-n count] pid
+** prints count snapshots (default 1) every interval seconds (default 1).
+**
+** Exit status: 0 on success, 2 if the segment cannot be read.
+*/
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>   /* getopt, sleep */
+#include <sys/time.h> /* gettimeofday */
+
+#ifdef HAVE_SHM_OPEN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "private.h"
+
+#ifdef HAVE_SHM_OPEN
+static void snapshot (const Livehdr *);
+#endif
+
+int main (int argc, char **argv)
+{
+  int c;                    /* for getopt parsing */
+  int interval = 1;         /* seconds between snapshots */
+  int count = 1;            /* number of snapshots */
+#ifdef HAVE_SHM_OPEN
+  char segname[32];
+  int fd;
+  struct stat st;
+  const Livehdr *hdr;
+  int n;
+#endif
+
+  while ((c = getopt (argc, argv, "i:n:")) != -1) {
+    switch (c) {
+    case 'i':
+      if ((interval = atoi (optarg)) < 0) {
+	fprintf (stderr, "-i interval must be >= 0\n");
+	return 2;
+      }
+      break;
+    case 'n':
+      if ((count = atoi (optarg)) < 1) {
+	fprintf (stderr, "-n count must be > 0\n");
+	return 2;
+      }
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-i interval] [-n count] pid\n", argv[0]);
+      return 2;
+    }
+  }
+  if (argc - optind != 1) {
+    fprintf (stderr, "Usage: %s [-i interval] [-n count] pid\n", argv[0]);
+    return 2;
+  }
+
+#ifdef HAVE_SHM_OPEN
+  sprintf (segname, "/gptl.%d", atoi (argv[optind]));
+  if ((fd = shm_open (segname, O_RDONLY, 0)) < 0) {
+    fprintf (stderr, "Cannot open shared memory %s: is GPTLlive_stats set?\n", segname);
+    return 2;
+  }
+  if (fstat (fd, &st) != 0 || st.st_size < (off_t) sizeof (Livehdr) ||
+      (hdr = (const Livehdr *) mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+    fprintf (stderr, "Cannot map shared memory %s\n", segname);
+    close (fd);
+    return 2;
+  }
+  close (fd);
+
+  if (memcmp (hdr->magic, LIVE_MAGIC, sizeof (hdr->magic)) != 0) {
+    fprintf (stderr, "%s is not a GPTL live statistics segment, or is not ready yet\n", segname);
+    return 2;
+  }
+  if (hdr->byteorder != DUMP_BYTEORDER || hdr->reclen != sizeof (Liverec) ||
+      hdr->blocklen != sizeof (Liveblock) ||
+      st.st_size < (off_t) (sizeof (Livehdr) + hdr->maxthreads * sizeof (Liveblock))) {
+    fprintf (stderr, "%s was written by an incompatible GPTL version\n", segname);
+    return 2;
+  }
+
+  for (n = 0; n < count; ++n) {
+    if (n > 0)
+      sleep (interval);
+    snapshot (hdr);
+  }
+  return 0;
+#else
+  fprintf (stderr, "%s: GPTL was built without shm_open\n", argv[0]);
+  return 2;
+#endif
+}
+
+#ifdef HAVE_SHM_OPEN
+/* Print the regions of all threads */
+static void snapshot (const Livehdr *hdr)
+{
+  const Liveblock *blk;
+  Liverec rec;              /* consistent copy of a record */
+  unsigned int seq;
+  unsigned int nregions;
+  struct timeval tv;
+  double now;               /* epoch seconds */
+  int t, n;
+
+  gettimeofday (&tv, NULL);
+  now = tv.tv_sec + 1.e-6 * tv.tv_usec;
+  printf ("pid %d, %u threads, timer %s\n", hdr->pid, hdr->maxthreads, hdr->clock);
+  printf ("%6s %-32s %2s %10s %11s %11s %11s %11s\n", "thread", "name", "on", "calls",
+	  "wallclock", "max", "min", "running");
+
+  for (t = 0; t < (int) hdr->maxthreads; ++t) {
+    blk = (const Liveblock *) (hdr + 1) + t;
+    nregions = blk->nregions;
+    __sync_synchronize ();
+    for (n = 0; n < (int) nregions; ++n) {
+      /* Seqlock read: retry while the owning thread is changing the record */
+      do {
+	while ((seq = blk->rec[n].seq) & 1)
+	  ;
+	__sync_synchronize ();
+	memcpy (&rec, (const void *) &blk->rec[n], sizeof (Liverec));
+	__sync_synchronize ();
+      } while (blk->rec[n].seq != seq);
+
+      printf ("%6d %-32s %2s %10llu %11.3e %11.3e %11.3e ", t, rec.name, rec.onflg ? "y" : "n",
+	      rec.count, rec.accum, rec.max, rec.min);
+      if (rec.onflg && hdr->origin > 0.)
+	printf ("%11.3e\n", now - (hdr->origin + rec.last));
+      else
+	printf ("%11s\n", "-");
+    }
+    if (blk->dropped > 0)
+      printf ("%6d %u regions not shown: more than %d on the thread\n", t, blk->dropped,
+	      LIVE_NREGION);
+  }
+  fflush (stdout);
+}
+#endif
@@ -0,0 +1,196 @@
+/*
+** Benchmark the per-call cost of the components of GPTLstart/GPTLstop.
+**
+** GPTLpr_file() reports a single 1000-iteration estimate of each component, which
+** is noisy and can be near the resolution of coarse clocks. Here each estimate is
+** repeated ntrials times and summarized by its median and median absolute deviation
+** (MAD), for every available underlying timing routine, several hash table fill
+** levels and (when built with OpenMP) several thread counts.
+**
+** Output is one comma-separated line per measurement so results from different GPTL
+** versions can be compared mechanically:
+**   utr,nthreads,nfill,component,median,mad,ntrials
+** Times are seconds per call.
+**
+** Usage: bench_overhead [ntrials]    (or "make bench")
+*/
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#ifdef THREADED_OMP
+#include <omp.h>
+#endif
+
+#define MAXTRIALS 10000
+#define NPAIRS 1000      /* start/stop pairs per trial of the end-to-end measurement */
+
+typedef struct {
+  char *name;
+  int utr;
+} Vals;
+
+static const char *compnames[GPTLohd_ncomp+1] = {
+  "fortran", "thread", "genhashidx", "getentry", "utr", "misc", "papi", "getentry_instr",
+  "start_stop"   /* end-to-end GPTLstart+GPTLstop pair, timed independently of GPTL */
+};
+
+static int cmp (const void *, const void *);
+static void summarize (double *, int, double *, double *);
+static double now (void);
+static int run (const char *, int, int, int);
+
+int main (int argc, char **argv)
+{
+  Vals vals[] = {{"gettimeofday",   GPTLgettimeofday},
+		 {"nanotime",       GPTLnanotime},
+		 {"clockgettime",   GPTLclockgettime},
+		 {"papitime",       GPTLpapitime},
+		 {"read_real_time", GPTLread_real_time}};
+  static const int nvals = sizeof (vals) / sizeof (Vals);
+  static const int fills[] = {0, 100, 1000};    /* timers present in the hash table */
+  static const int nfills = sizeof (fills) / sizeof (int);
+  int ntrials = 51;
+  int maxthreads = 1;
+  int nthreads;
+  int n, f;
+
+  if (argc > 1)
+    ntrials = atoi (argv[1]);
+  if (ntrials < 1 || ntrials > MAXTRIALS) {
+    fprintf (stderr, "ntrials must be between 1 and %d\n", MAXTRIALS);
+    return 1;
+  }
+
+#ifdef THREADED_OMP
+  maxthreads = omp_get_max_threads ();
+#endif
+
+  printf ("utr,nthreads,nfill,component,median,mad,ntrials\n");
+  for (n = 0; n < nvals; n++) {
+    for (f = 0; f < nfills; f++) {
+      for (nthreads = 1; nthreads <= maxthreads; nthreads *= 2) {
+	if (GPTLsetutr (vals[n].utr) != 0)
+	  break;          /* timing routine not available */
+	if (GPTLinitialize () != 0) {
+	  fprintf (stderr, "GPTLinitialize failure\n");
+	  return 1;
+	}
+	if (run (vals[n].name, nthreads, fills[f], ntrials) != 0)
+	  return 1;
+	if (GPTLfinalize () != 0)
+	  return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/*
+** run: gather and print ntrials measurements of each component, using nthreads threads
+** each of whose hash tables holds nfill timers
+*/
+static int run (const char *utrname, int nthreads, int nfill, int ntrials)
+{
+  double *samples[GPTLohd_ncomp+1];  /* [component][thread*ntrials + trial] */
+  double median, mad;
+  int nsamples = nthreads * ntrials;
+  int c;
+  int ret = 0;
+
+  for (c = 0; c < GPTLohd_ncomp+1; c++) {
+    if ( ! (samples[c] = (double *) malloc (nsamples * sizeof (double)))) {
+      fprintf (stderr, "malloc failure\n");
+      return 1;
+    }
+  }
+
+#ifdef THREADED_OMP
+#pragma omp parallel num_threads (nthreads) private (c) reduction (+:ret)
+#endif
+  {
+    double comp[GPTLohd_ncomp];
+    double t1, t2;
+    char name[32];
+    int mythread = 0;
+    int i, trial;
+
+#ifdef THREADED_OMP
+    mythread = omp_get_thread_num ();
+#endif
+
+    /* Fill this thread's hash table */
+    for (i = 0; i < nfill; i++) {
+      sprintf (name, "fill%d", i);
+      ret += GPTLstart (name);
+      ret += GPTLstop (name);
+    }
+    ret += GPTLstart ("bench");
+    ret += GPTLstop ("bench");
+
+    for (trial = 0; trial < ntrials; trial++) {
+      if (GPTLget_overhead_components (comp, GPTLohd_ncomp) != GPTLohd_ncomp)
+	++ret;
+      for (c = 0; c < GPTLohd_ncomp; c++)
+	samples[c][mythread*ntrials + trial] = comp[c];
+
+      t1 = now ();
+      for (i = 0; i < NPAIRS; i++) {
+	ret += GPTLstart ("bench");
+	ret += GPTLstop ("bench");
+      }
+      t2 = now ();
+      samples[GPTLohd_ncomp][mythread*ntrials + trial] = (t2 - t1) / NPAIRS;
+    }
+  }
+
+  if (ret != 0) {
+    fprintf (stderr, "GPTL failure during benchmark\n");
+    return 1;
+  }
+
+  for (c = 0; c < GPTLohd_ncomp+1; c++) {
+    summarize (samples[c], nsamples, &median, &mad);
+    printf ("%s,%d,%d,%s,%.4e,%.4e,%d\n",
+	    utrname, nthreads, nfill, compnames[c], median, mad, nsamples);
+    free (samples[c]);
+  }
+  return 0;
+}
+
+/*
+** summarize: median and median absolute deviation of x. x is reordered.
+*/
+static void summarize (double *x, int n, double *median, double *mad)
+{
+  int i;
+
+  qsort (x, n, sizeof (double), cmp);
+  *median = (n % 2) ? x[n/2] : 0.5 * (x[n/2-1] + x[n/2]);
+
+  for (i = 0; i < n; i++)
+    x[i] = fabs (x[i] - *median);
+  qsort (x, n, sizeof (double), cmp);
+  *mad = (n % 2) ? x[n/2] : 0.5 * (x[n/2-1] + x[n/2]);
+}
+
+static int cmp (const void *a, const void *b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return (da > db) - (da < db);
+}
+
+/* Reference clock independent of the GPTL timing routine being measured */
+static double now (void)
+{
+  struct timespec ts;
+
+  (void) clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.e-9 * ts.tv_nsec;
+}
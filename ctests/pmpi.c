@@ -1,6 +1,7 @@
 #include "config.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>  /* usleep */
 #include <mpi.h>
 #include "gptl.h"
 
@@ -21,16 +22,28 @@ int main (int argc, char **argv)
   int sum;
   MPI_Status status;
   MPI_Request sendreq, recvreq;
+  MPI_Comm revcomm;                   /* comm with ranks in reverse order */
+  MPI_Request reqs[2];
+  MPI_Win win;
+  MPI_File fh;
+  int flag;
+  int indx;
+  int reviam;
   int dest;
   int source;
   int resultlen;                      /* returned length of string from MPI routine */
   int provided;                       /* level of threading support in this MPI lib */
+  double offset, drift;               /* clock offset from rank 0 */
   char string[MPI_MAX_ERROR_STRING];  /* character string returned from MPI routine */
   const char *mpiroutine[] = {"MPI_Ssend", "MPI_Send", "MPI_Recv", "MPI_Sendrecv", "MPI_Irecv",
 			      "MPI_Isend", "MPI_Waitall", "MPI_Barrier", "MPI_Bcast", "MPI_Allreduce",
-			      "MPI_Gather", "MPI_Scatter", "MPI_Alltoall", "MPI_Reduce", "MPI_Issend"};
+			      "MPI_Gather", "MPI_Scatter", "MPI_Alltoall", "MPI_Reduce", "MPI_Issend",
+			      "MPI_Iallreduce", "MPI_Waitany", "MPI_Ibcast", "MPI_Testall",
+			      "MPI_Reduce_scatter_block", "MPI_Win_fence", "MPI_Put", "MPI_Get",
+			      "MPI_File_open", "MPI_File_write_at", "MPI_File_read_at", "MPI_File_close"};
   const int nroutines = sizeof (mpiroutine) / sizeof (char *);
   double wallclock;
+  char outfile[32];                   /* timing.pmpi.<rank>, apart from other tests' timing.<rank> */
 
   void chkbuf (const char *, int *, const int, const int);
 
@@ -43,6 +56,11 @@ int main (int argc, char **argv)
   ret = GPTLsetoption (GPTLoverhead, 0);       /* Don't print overhead stats */
   ret = GPTLsetoption (GPTLpercent, 0);        /* Don't print percentage stats */
   ret = GPTLsetoption (GPTLabort_on_error, 1); /* Abort on any GPTL error */
+  ret = GPTLsetoption (GPTLcomm_stats, 1);     /* MPI stats by communicator */
+  ret = GPTLsetoption (GPTLpeer_stats, 1);     /* MPI stats by peer */
+  ret = GPTLsetoption (GPTLreq_stats, 1);      /* Nonblocking request overlap */
+  ret = GPTLsetoption (GPTLlate_stats, 1);     /* Wait for late ranks in collectives */
+  ret = GPTLsetoption (GPTLclock_sync, 2);     /* Align clocks to rank 0, fit drift */
 
   /* 
   ** Only initialize GPTL if ENABLE_PMPI is false.
@@ -63,6 +81,14 @@ int main (int argc, char **argv)
   ret = MPI_Comm_rank (comm, &iam);            /* Get my rank */
   ret = MPI_Comm_size (comm, &commsize);       /* Get communicator size */
 
+#ifdef ENABLE_PMPI
+  /* Rank 0 is the reference clock */
+  if (GPTLget_clock_offset (&offset, &drift) != 0 || (iam == 0 && offset != 0.)) {
+    printf ("%s: bad clock offset %g from GPTLget_clock_offset\n", argv[0], offset);
+    MPI_Abort (comm, -1);
+  }
+#endif
+
   if (iam == 0) {
     printf ("%s: testing suite of MPI routines for auto-instrumentation via GPTL PMPI layer\n", argv[0]);
     switch (provided) {
@@ -140,6 +166,16 @@ int main (int argc, char **argv)
   ret = MPI_Waitall (1, &sendreq, &status);
   chkbuf ("MPI_Waitall", recvbuf, count, source);
 
+  /* Overlap an exchange with "computation": the requests are in flight while sleeping */
+  ret = MPI_Irecv (recvbuf, count, MPI_INT, source, tag, comm, &reqs[0]);
+  ret = MPI_Isend (sendbuf, count, MPI_INT, dest, tag, comm, &reqs[1]);
+  usleep (10000);
+  ret = MPI_Waitall (2, reqs, MPI_STATUSES_IGNORE);
+  chkbuf ("MPI_Isend + MPI_Irecv overlapped", recvbuf, count, source);
+
+  /* The other ranks wait for a late rank 1 */
+  if (iam == 1)
+    usleep (50000);
   ret = MPI_Barrier (comm);
 
   ret = MPI_Bcast (sendbuf, count, MPI_INT, 0, comm);
@@ -199,12 +235,75 @@ int main (int argc, char **argv)
     chkbuf ("MPI_Reduce", recvbuf, count, sum);
   }
 
+  /* Nonblocking collectives, completed by MPI_Waitany and MPI_Testall */
+  ret = MPI_Iallreduce (sendbuf, recvbuf, count, MPI_INT, MPI_SUM, comm, &reqs[0]);
+  ret = MPI_Waitany (1, reqs, &indx, &status);
+  chkbuf ("MPI_Iallreduce + MPI_Waitany", recvbuf, count, sum);
+
+  for (i = 0; i < count; ++i)
+    recvbuf[i] = iam;
+  ret = MPI_Ibcast (recvbuf, count, MPI_INT, 0, comm, &reqs[0]);
+  reqs[1] = MPI_REQUEST_NULL;
+  do {
+    ret = MPI_Testall (2, reqs, &flag, MPI_STATUSES_IGNORE);
+  } while ( ! flag);
+  chkbuf ("MPI_Ibcast + MPI_Testall", recvbuf, count, 0);
+
+  /* Each rank gets its own block of the sum */
+  for (i = 0; i < commsize; ++i)
+    atoabufsend[i] = iam;
+  ret = MPI_Reduce_scatter_block (atoabufsend, recvbuf, 1, MPI_INT, MPI_SUM, comm);
+  chkbuf ("MPI_Reduce_scatter_block", recvbuf, 1, sum);
+
+  /* One-sided: put my rank into dest's window, then get it back */
+  for (i = 0; i < count; ++i)
+    recvbuf[i] = -1;
+  ret = MPI_Win_create (recvbuf, count * sizeof (int), sizeof (int), MPI_INFO_NULL, comm, &win);
+  ret = MPI_Win_fence (0, win);
+  ret = MPI_Put (sendbuf, count, MPI_INT, dest, 0, count, MPI_INT, win);
+  ret = MPI_Win_fence (0, win);
+  chkbuf ("MPI_Put", recvbuf, count, source);
+  ret = MPI_Get (gsbuf, count, MPI_INT, dest, 0, count, MPI_INT, win);
+  ret = MPI_Win_fence (0, win);
+  chkbuf ("MPI_Get", gsbuf, count, iam);
+  ret = MPI_Win_free (&win);
+
+  /* MPI-IO: each rank writes and reads back its own block of a scratch file */
+  ret = MPI_File_open (comm, "pmpi_io.tmp", MPI_MODE_CREATE | MPI_MODE_RDWR | MPI_MODE_DELETE_ON_CLOSE,
+		       MPI_INFO_NULL, &fh);
+  if (ret != MPI_SUCCESS) {
+    printf ("iam=%d MPI_File_open failed\n", iam);
+    MPI_Abort (comm, -1);
+  }
+  ret = MPI_File_write_at (fh, (MPI_Offset) iam * count * sizeof (int), sendbuf, count, MPI_INT,
+			   &status);
+  ret = MPI_File_read_at (fh, (MPI_Offset) iam * count * sizeof (int), recvbuf, count, MPI_INT,
+			  &status);
+  chkbuf ("MPI_File_write_at + MPI_File_read_at", recvbuf, count, iam);
+  ret = MPI_File_close (&fh);
+
+  /* Peer ranks in revcomm must be reported as MPI_COMM_WORLD ranks */
+  ret = MPI_Comm_split (comm, 0, commsize - 1 - iam, &revcomm);
+  ret = MPI_Comm_rank (revcomm, &reviam);
+  ret = MPI_Sendrecv (sendbuf, count, MPI_INT, (reviam + 1)%commsize, tag,
+		      recvbuf, count, MPI_INT, (reviam + commsize - 1)%commsize, tag,
+		      revcomm, &status);
+  chkbuf ("MPI_Sendrecv on revcomm", recvbuf, count, dest);
+  ret = MPI_Allreduce (sendbuf, recvbuf, count, MPI_INT, MPI_SUM, revcomm);
+  ret = MPI_Comm_free (&revcomm);
+
   ret = MPI_Finalize ();          /* Clean up MPI */
 
 #ifndef ENABLE_PMPI
   ret = GPTLstop ("total");
-  ret = GPTLpr (iam);             /* Print the results */
 #endif
+  /* 
+  ** Print the results after MPI_Finalize, which fits the clock drift and flushes the
+  ** collective wait estimates. With ENABLE_PMPI it has also written timing.<rank>, but
+  ** other tests run at the same time write those files too.
+  */
+  sprintf (outfile, "timing.pmpi.%d", iam);
+  ret = GPTLpr_file (outfile);
 
   /* Check that PMPI entries were generated for all expected routines */
   if (iam == 0) {
@@ -0,0 +1,30 @@
+#!/bin/sh
+# This is a test script for the GPTL package. It tests the binary
+# summary dump and the gptlcmp run-to-run comparison tool.
+
+set -e
+echo
+echo "Testing run-to-run comparison of summary dumps..."
+./tst_dump timing.cmp_base 2000
+./tst_dump timing.cmp_same 2000
+./tst_dump timing.cmp_slow 60000
+
+# A run against itself has no changes.
+../bin/gptlcmp timing.cmp_base.bin timing.cmp_base.bin > timing.cmp_out
+grep -q "0 significant changes" timing.cmp_out
+
+# The slowed region is reported first as a regression, and the exit
+# status tells a nightly gate to fail.
+if ../bin/gptlcmp timing.cmp_base.bin timing.cmp_same.bin timing.cmp_slow.bin > timing.cmp_out; then
+    echo "gptlcmp missed a regression"
+    exit 1
+fi
+grep -A 1 "^name " timing.cmp_out | grep -q "^slow .*REGRESSION"
+
+# Text summaries are rejected.
+if ../bin/gptlcmp timing.cmp_base timing.cmp_base.bin > timing.cmp_out 2>&1; then
+    echo "gptlcmp accepted a text summary"
+    exit 1
+fi
+echo "SUCCESS!"
+exit 0
@@ -8,5 +8,26 @@ set -e
 echo
 echo "Testing MPI functionality..."
 mpiexec -n 2 ./pmpi
+echo "Testing MPI message size histograms..."
+grep -q "MPI message size histograms" timing.pmpi.0
+grep -A 2 "^MPI_Allreduce:" timing.pmpi.0 | grep -q "4K - <8K"
+echo "Testing MPI stats by communicator and peer..."
+grep -q "^comm 0 MPI_COMM_WORLD: 2 ranks" timing.pmpi.0
+grep -A 4 "^comm 1: 2 ranks" timing.pmpi.0 | grep -q "MPI_Allreduce"
+sed -n '/^comm 0 /,/^$/p' timing.pmpi.0 | grep -q "MPI_Iallreduce"
+sed -n '/^comm 0 /,/^$/p' timing.pmpi.0 | grep -q "MPI_File_open"
+# Rank 0 only talks to MPI_COMM_WORLD rank 1, also through the reordered comm
+sed -n '/^MPI point-to-point/,/^$/p' timing.pmpi.0 | grep -q "^ *1 "
+! sed -n '/^MPI point-to-point/,/^$/p' timing.pmpi.0 | grep -q "^ *0 "
+echo "Testing MPI nonblocking request overlap..."
+sed -n '/^MPI nonblocking requests/,/^$/p' timing.pmpi.0 | grep -q "^ *MPI_Irecv  *3 "
+sed -n '/^MPI nonblocking requests/,/^$/p' timing.pmpi.0 | grep -q "^ *MPI_Iallreduce  *1 "
+echo "Testing MPI collective wait for late ranks..."
+# Rank 0 waited about 50 ms in MPI_Barrier for rank 1
+sed -n '/^MPI collective wait/,/^$/p' timing.pmpi.0 | awk '$1 == "MPI_Barrier" && $4 > 0.03 {found = 1} END {exit !found}'
+sed -n '/^MPI collective wait/,/^$/p' timing.pmpi.1 | awk '$1 == "MPI_Barrier" && $4 < 0.03 {found = 1} END {exit !found}'
+echo "Testing clock offset from rank 0..."
+grep -q "^Clock offset from rank 0 by ping-pong: 0.000000e+00 seconds" timing.pmpi.0
+grep "^Clock offset from rank 0 by ping-pong" timing.pmpi.1 | grep -q "drift [-0-9]"
 echo "SUCCESS!"
 exit 0
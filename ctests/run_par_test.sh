@@ -8,5 +8,9 @@ set -e
 echo
 echo "Testing MPI summary..."
 mpiexec -n 2 ./summary
+echo "Testing load imbalance report..."
+mpiexec -n 3 ./tst_imbalance
+echo "Testing shared output file..."
+mpiexec -n 3 ./tst_shared
 echo "SUCCESS!"
 exit 0
@@ -0,0 +1,69 @@
+/* Write a summary and its binary dump (GPTLdump_summary) for
+ * run_cmp_test.sh, which compares dumps of several runs with gptlcmp.
+ *
+ * Usage: tst_dump outfile usec
+ * where usec is how long the "slow" region sleeps. */
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>  /* usleep */
+
+#ifdef HAVE_LIBMPI
+#include <mpi.h>
+#endif
+
+/* This macro prints an error message with line number and name of
+ * test program. */
+#define ERR do { \
+fflush(stdout); /* Make sure our stdout is synced with stderr. */ \
+fprintf(stderr, "Sorry! Unexpected result, %s, line: %d\n", \
+	__FILE__, __LINE__);				    \
+fflush(stderr);                                             \
+return 2;                                                   \
+} while (0)
+
+int
+main(int argc, char **argv)
+{
+   FILE *fp;
+   char dumpfile[256];
+   int usec;
+
+   if (argc != 3) ERR;
+   usec = atoi(argv[2]);
+
+   if (GPTLsetoption(GPTLdump_summary, 1)) ERR;
+#ifdef HAVE_LIBMPI
+   if (MPI_Init(&argc, &argv) != MPI_SUCCESS) ERR;
+#endif
+   /* With the PMPI layer, MPI_Init already initialized GPTL. */
+#if !defined(ENABLE_PMPI) || !defined(HAVE_LIBMPI)
+   if (GPTLinitialize()) ERR;
+#endif
+
+   if (GPTLstart("steady")) ERR;
+   usleep(2000);
+   if (GPTLstop("steady")) ERR;
+   if (GPTLstart("slow")) ERR;
+   usleep(usec);
+   if (GPTLstop("slow")) ERR;
+
+#ifdef HAVE_LIBMPI
+   if (GPTLpr_summary_file(MPI_COMM_WORLD, argv[1])) ERR;
+#else
+   if (GPTLpr_summary_file(argv[1])) ERR;
+#endif
+
+   /* The dump is written next to the text summary. */
+   sprintf(dumpfile, "%s.bin", argv[1]);
+   if (!(fp = fopen(dumpfile, "rb"))) ERR;
+   fclose(fp);
+
+#ifdef HAVE_LIBMPI
+   if (MPI_Finalize() != MPI_SUCCESS) ERR;
+#endif
+   if (GPTLfinalize()) ERR;
+   return 0;
+}
@@ -0,0 +1,130 @@
+/* Test exclusive (self) time for GPTL. The exclusive time of a
+ * region is its wallclock time minus that of its children. */
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <math.h>
+#include <unistd.h>  /* usleep */
+
+/* This macro prints an error message with line number and name of
+ * test program. */
+#define ERR do { \
+fflush(stdout); /* Make sure our stdout is synced with stderr. */ \
+fprintf(stderr, "Sorry! Unexpected result, %s, line: %d\n", \
+	__FILE__, __LINE__);				    \
+fflush(stderr);                                             \
+return 2;                                                   \
+} while (0)
+
+#define TOL 1.e-9
+
+int
+main(int argc, char **argv)
+{
+   printf("\n*** Testing GPTL exclusive time.\n");
+   printf("*** testing exclusive time of nested timers...");
+   {
+      double outer, inner1, inner2, leaf;
+      double outer_excl, inner1_excl, inner2_excl, leaf_excl;
+      int i;
+
+      if (GPTLinitialize()) ERR;
+      for (i = 0; i < 3; i++) {
+	 if (GPTLstart("outer")) ERR;
+	 usleep(1000);
+	 if (GPTLstart("inner1")) ERR;
+	 usleep(1000);
+	 if (GPTLstart("leaf")) ERR;
+	 usleep(1000);
+	 if (GPTLstop("leaf")) ERR;
+	 if (GPTLstop("inner1")) ERR;
+	 if (GPTLstart("inner2")) ERR;
+	 usleep(1000);
+	 if (GPTLstop("inner2")) ERR;
+	 if (GPTLstop("outer")) ERR;
+      }
+
+      if (GPTLget_wallclock("outer", 0, &outer)) ERR;
+      if (GPTLget_wallclock("inner1", 0, &inner1)) ERR;
+      if (GPTLget_wallclock("inner2", 0, &inner2)) ERR;
+      if (GPTLget_wallclock("leaf", 0, &leaf)) ERR;
+      if (GPTLget_exclusive("outer", 0, &outer_excl)) ERR;
+      if (GPTLget_exclusive("inner1", 0, &inner1_excl)) ERR;
+      if (GPTLget_exclusive("inner2", 0, &inner2_excl)) ERR;
+      if (GPTLget_exclusive("leaf", 0, &leaf_excl)) ERR;
+
+      /* Leaf regions have no children. */
+      if (fabs(leaf_excl - leaf) > TOL) ERR;
+      if (fabs(inner2_excl - inner2) > TOL) ERR;
+
+      /* Parents lose exactly the time of their direct children. */
+      if (fabs(inner1_excl - (inner1 - leaf)) > TOL) ERR;
+      if (fabs(outer_excl - (outer - inner1 - inner2)) > TOL) ERR;
+      if (outer_excl <= 0. || inner1_excl <= 0.) ERR;
+
+      /* Unknown timers are an error. */
+      if (GPTLget_exclusive("nosuchtimer", 0, &outer_excl) != -1) ERR;
+
+      if (GPTLpr_file("timing.exclusive")) ERR;
+      if (GPTLfinalize()) ERR;
+   }
+   printf("ok\n");
+   printf("*** testing exclusive time after GPTLstartstop_val...");
+   {
+      double excl;
+
+      if (GPTLinitialize()) ERR;
+      if (GPTLstartstop_val("userval", 2.5)) ERR;
+      if (GPTLstartstop_val("userval", 1.5)) ERR;
+      if (GPTLget_exclusive("userval", 0, &excl)) ERR;
+      if (fabs(excl - 4.0) > TOL) ERR;
+      if (GPTLfinalize()) ERR;
+   }
+   printf("ok\n");
+   printf("*** testing subtraction of estimated overhead...");
+   {
+      double outer, child, outer_excl, child_excl, raw;
+      int count, onflg;
+      long usr, sys;
+      long long papicounters[1];
+      int i;
+
+      if (GPTLsetoption(GPTLsubtract_ohd, 1)) ERR;
+      if (GPTLinitialize()) ERR;
+      if (GPTLstart("outer")) ERR;
+      /* Give outer self time well above the overhead estimate, so its
+       * adjusted exclusive time is never clipped at zero. */
+      usleep(1000);
+      for (i = 0; i < 20; i++) {
+	 if (GPTLstart("child")) ERR;
+	 usleep(100);
+	 if (GPTLstop("child")) ERR;
+      }
+      if (GPTLstop("outer")) ERR;
+
+      if (GPTLget_wallclock("outer", 0, &outer)) ERR;
+      if (GPTLget_wallclock("child", 0, &child)) ERR;
+      if (GPTLget_exclusive("outer", 0, &outer_excl)) ERR;
+      if (GPTLget_exclusive("child", 0, &child_excl)) ERR;
+
+      /* GPTLquery reports the raw time, which includes overhead. */
+      if (GPTLquery("outer", 0, &count, &onflg, &raw, &usr, &sys, papicounters, 0)) ERR;
+      if (outer > raw || outer <= 0.) ERR;
+
+      /* Adjusted times still add up: outer = its own time + child. */
+      if (fabs(outer - (outer_excl + child)) > TOL) ERR;
+      if (fabs(child - child_excl) > TOL) ERR;
+
+      /* Printing does not change the estimates which were subtracted. */
+      if (GPTLpr_file("timing.exclusive_ohd")) ERR;
+      if (GPTLget_wallclock("outer", 0, &raw)) ERR;
+      if (raw != outer) ERR;
+      if (GPTLget_exclusive("child", 0, &raw)) ERR;
+      if (raw != child_excl) ERR;
+      if (GPTLfinalize()) ERR;
+   }
+   printf("ok\n");
+   printf("\n*** SUCCESS!\n");
+   return 0;
+}
@@ -0,0 +1,122 @@
+/* Test the hotspot report of GPTLpr_file(): regions ranked by
+ * exclusive time, inclusive time, calls and overhead fraction, and
+ * the warning list of overhead-dominated regions. */
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>  /* usleep */
+
+/* This macro prints an error message with line number and name of
+ * test program. */
+#define ERR do { \
+fflush(stdout); /* Make sure our stdout is synced with stderr. */ \
+fprintf(stderr, "Sorry! Unexpected result, %s, line: %d\n", \
+	__FILE__, __LINE__);				    \
+fflush(stderr);                                             \
+return 2;                                                   \
+} while (0)
+
+#define FILE_NAME "timing.hotspots"
+#define MAX_LINE 256
+
+/* Return the name in the first row of the table following "heading",
+ * or NULL if the heading is not in the file. */
+static char *
+first_row(const char *heading, char *name)
+{
+   FILE *fp;
+   char line[MAX_LINE];
+   char *ret = NULL;
+
+   if (!(fp = fopen(FILE_NAME, "r")))
+      return NULL;
+   while (fgets(line, MAX_LINE, fp))
+      if (strstr(line, heading))
+	 break;
+   /* Skip the column titles. */
+   if (!feof(fp) && fgets(line, MAX_LINE, fp) && fgets(line, MAX_LINE, fp))
+      if (sscanf(line, "%s", name) == 1)
+	 ret = name;
+   fclose(fp);
+   return ret;
+}
+
+/* Return 1 if "name" is listed among the overhead-dominated regions. */
+static int
+in_warnings(const char *name)
+{
+   FILE *fp;
+   char line[MAX_LINE];
+   char word[MAX_LINE];
+   int inlist = 0;
+   int ret = 0;
+
+   if (!(fp = fopen(FILE_NAME, "r")))
+      return 0;
+   while (fgets(line, MAX_LINE, fp)) {
+      if (strstr(line, "consider removing these timers")) {
+	 inlist = 1;
+	 continue;
+      }
+      /* The list ends with a blank line. */
+      if (inlist && sscanf(line, "%s", word) != 1)
+	 break;
+      if (inlist && !strcmp(word, name))
+	 ret = 1;
+   }
+   fclose(fp);
+   return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+   printf("\n*** Testing GPTL hotspot report.\n");
+   printf("*** testing hotspot option...");
+   {
+      if (GPTLsetoption(GPTLhotspots, -1) != -1) ERR;
+      if (GPTLsetoption(GPTLhotspots, 2)) ERR;
+      if (GPTLsetoption(GPTLohdwarn, -1) != -1) ERR;
+      if (GPTLsetoption(GPTLohdwarn, 10)) ERR;
+   }
+   printf("ok\n");
+   printf("*** testing hotspot rankings...");
+   {
+      char name[MAX_LINE];
+      int i;
+
+      if (GPTLinitialize()) ERR;
+      if (GPTLstart("outer")) ERR;
+      for (i = 0; i < 100; i++) {
+	 if (GPTLstart("many")) ERR;
+	 if (GPTLstop("many")) ERR;
+      }
+      if (GPTLstart("slow")) ERR;
+      usleep(20000);
+      if (GPTLstop("slow")) ERR;
+      if (GPTLstop("outer")) ERR;
+
+      if (GPTLpr_file(FILE_NAME)) ERR;
+
+      /* "slow" holds nearly all the time but "outer" includes it. */
+      if (!first_row("Sorted by exclusive time", name)) ERR;
+      if (strcmp(name, "slow")) ERR;
+      if (!first_row("Sorted by inclusive time", name)) ERR;
+      if (strcmp(name, "outer")) ERR;
+      if (!first_row("Sorted by number of calls", name)) ERR;
+      if (strcmp(name, "many")) ERR;
+      if (!first_row("Sorted by overhead fraction", name)) ERR;
+      if (strcmp(name, "many")) ERR;
+
+      /* Empty start/stop pairs are dominated by overhead; "slow" is not. */
+      if (!first_row("consider removing these timers", name)) ERR;
+      if (strcmp(name, "many")) ERR;
+      if (in_warnings("slow")) ERR;
+      if (GPTLfinalize()) ERR;
+   }
+   printf("ok\n");
+   printf("\n*** SUCCESS!\n");
+   return 0;
+}
@@ -0,0 +1,143 @@
+/* Test the load imbalance ranking of GPTLpr_summary_file(): regions
+ * ranked by the time lost waiting on the slowest rank (or thread). */
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>  /* usleep, getpid */
+
+#ifdef HAVE_LIBMPI
+#include <mpi.h>
+#endif
+#ifdef THREADED_OMP
+#include <omp.h>
+#endif
+
+/* This macro prints an error message with line number and name of
+ * test program. */
+#define ERR do { \
+fflush(stdout); /* Make sure our stdout is synced with stderr. */ \
+fprintf(stderr, "Sorry! Unexpected result, %s, line: %d\n", \
+	__FILE__, __LINE__);				    \
+fflush(stderr);                                             \
+return 2;                                                   \
+} while (0)
+
+#define MAX_LINE 512
+
+/* Each run needs its own file: make -j check runs the test alone and
+ * under mpiexec at the same time, and without MPI each copy started by
+ * mpiexec is a run of its own. */
+static char file_name[MAX_LINE];
+
+/* Return the name in the first row of the imbalance table, or NULL
+ * if there is no imbalance table in the file. */
+static char *
+first_row(char *name)
+{
+   FILE *fp;
+   char line[MAX_LINE];
+   char *ret = NULL;
+   int insection = 0;
+
+   if (!(fp = fopen(file_name, "r")))
+      return NULL;
+   while (!ret && fgets(line, MAX_LINE, fp)) {
+      if (strstr(line, "Load imbalance: top"))
+	 insection = 1;
+      /* The row after the column titles. */
+      else if (insection && !strncmp(line, "name ", 5) && fgets(line, MAX_LINE, fp) &&
+	       sscanf(line, "%s", name) == 1)
+	 ret = name;
+   }
+   fclose(fp);
+   return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+   int iam = 0;
+   int nranks = 1;
+   long pid = (long)getpid();
+   int nthreads = 1;
+
+   printf("\n*** Testing GPTL load imbalance report.\n");
+   printf("*** testing imbalance option...");
+   {
+      if (GPTLsetoption(GPTLimbalance, -1) != -1) ERR;
+      if (GPTLsetoption(GPTLimbalance, 5)) ERR;
+   }
+   printf("ok\n");
+
+#ifdef HAVE_LIBMPI
+   if (MPI_Init(&argc, &argv) != MPI_SUCCESS) ERR;
+   if (MPI_Comm_rank(MPI_COMM_WORLD, &iam) != MPI_SUCCESS) ERR;
+   if (MPI_Comm_size(MPI_COMM_WORLD, &nranks) != MPI_SUCCESS) ERR;
+   /* All ranks write the one file named after rank 0's pid. */
+   if (MPI_Bcast(&pid, 1, MPI_LONG, 0, MPI_COMM_WORLD) != MPI_SUCCESS) ERR;
+#endif
+   sprintf(file_name, "timing.imbalance.%ld", pid);
+#ifdef THREADED_OMP
+   nthreads = omp_get_max_threads();
+#endif
+
+   printf("*** testing imbalance ranking over %d ranks, %d threads...", nranks, nthreads);
+   {
+      char name[MAX_LINE];
+      int ret = 0;
+
+      /* With the PMPI layer, MPI_Init already initialized GPTL. */
+#if !defined(ENABLE_PMPI) || !defined(HAVE_LIBMPI)
+      if (GPTLinitialize()) ERR;
+#endif
+
+      /* Every rank and thread does the same "balanced" work, but
+       * "unbalanced" work grows with the rank and thread number. */
+#ifdef THREADED_OMP
+#pragma omp parallel reduction(+:ret)
+#endif
+      {
+	 int worker = iam * nthreads;
+
+#ifdef THREADED_OMP
+	 worker += omp_get_thread_num();
+#endif
+	 ret += GPTLstart("balanced");
+	 usleep(5000);
+	 ret += GPTLstop("balanced");
+	 ret += GPTLstart("unbalanced");
+	 usleep(5000 * (worker + 1));
+	 ret += GPTLstop("unbalanced");
+      }
+      if (ret) ERR;
+
+#ifdef HAVE_LIBMPI
+      if (GPTLpr_summary_file(MPI_COMM_WORLD, file_name)) ERR;
+#else
+      if (GPTLpr_summary_file(file_name)) ERR;
+#endif
+
+      /* Imbalance is across ranks, or across threads without MPI. */
+#ifdef HAVE_LIBMPI
+      if (!iam && nranks > 1) {
+#else
+      if (nthreads > 1) {
+#endif
+	 if (!first_row(name)) ERR;
+	 if (strcmp(name, "unbalanced")) ERR;
+      } else if (!iam) {
+	 /* With only one rank or thread there is nothing to rank. */
+	 if (first_row(name)) ERR;
+      }
+   }
+   printf("ok\n");
+
+#ifdef HAVE_LIBMPI
+   if (MPI_Finalize() != MPI_SUCCESS) ERR;
+#endif
+   if (GPTLfinalize()) ERR;
+   printf("\n*** SUCCESS!\n");
+   return 0;
+}
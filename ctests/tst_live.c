@@ -0,0 +1,96 @@
+/* Test the live statistics segment (GPTLlive_stats): read the timers
+ * of this process with bin/gptllive while a region is running. */
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>  /* usleep, getpid */
+
+/* This macro prints an error message with line number and name of
+ * test program. */
+#define ERR do { \
+fflush(stdout); /* Make sure our stdout is synced with stderr. */ \
+fprintf(stderr, "Sorry! Unexpected result, %s, line: %d\n", \
+	__FILE__, __LINE__);				    \
+fflush(stderr);                                             \
+return 2;                                                   \
+} while (0)
+
+#define MAX_LINE 512
+
+/* Find the row of region name in the gptllive output. Return 0 if
+ * found, with its on flag and number of calls. */
+static int
+find_row(const char *file, const char *name, char *on, long *calls)
+{
+   FILE *fp;
+   char line[MAX_LINE];
+   char rowname[MAX_LINE];
+   int thread;
+   int ret = -1;
+
+   if (!(fp = fopen(file, "r")))
+      return -1;
+   while (ret && fgets(line, MAX_LINE, fp))
+      if (sscanf(line, "%d %s %c %ld", &thread, rowname, on, calls) == 4 &&
+	  !strcmp(rowname, name))
+	 ret = 0;
+   fclose(fp);
+   return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+   char cmd[MAX_LINE];
+   char file[MAX_LINE];
+   char on;
+   long calls;
+   int i;
+
+   printf("\n*** Testing GPTL live statistics segment.\n");
+#ifndef HAVE_SHM_OPEN
+   printf("*** shm_open is not available: skipping\n");
+   return 0;
+#endif
+
+   printf("*** testing gptllive on a running process...");
+   {
+      if (GPTLsetoption(GPTLlive_stats, 1)) ERR;
+      if (GPTLinitialize()) ERR;
+
+      if (GPTLstart("outer")) ERR;
+      for (i = 0; i < 10; i++) {
+	 if (GPTLstart("inner")) ERR;
+	 usleep(1000);
+	 if (GPTLstop("inner")) ERR;
+      }
+
+      /* "outer" is still running while gptllive reads the segment. */
+      sprintf(file, "timing.live.%ld", (long)getpid());
+      sprintf(cmd, "../bin/gptllive %ld > %s", (long)getpid(), file);
+      if (system(cmd)) ERR;
+      if (find_row(file, "outer", &on, &calls)) ERR;
+      if (on != 'y' || calls != 0) ERR;
+      if (find_row(file, "inner", &on, &calls)) ERR;
+      if (on != 'n' || calls != 10) ERR;
+
+      /* A reset is published too. */
+      if (GPTLstop("outer")) ERR;
+      if (GPTLreset()) ERR;
+      if (system(cmd)) ERR;
+      if (find_row(file, "inner", &on, &calls)) ERR;
+      if (calls != 0) ERR;
+      remove(file);
+
+      /* GPTLfinalize removes the segment. */
+      if (GPTLfinalize()) ERR;
+      sprintf(cmd, "../bin/gptllive %ld > /dev/null 2>&1", (long)getpid());
+      if (!system(cmd)) ERR;
+   }
+   printf("ok\n");
+   printf("\n*** SUCCESS!\n");
+   return 0;
+}
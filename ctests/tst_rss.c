@@ -0,0 +1,83 @@
+/* Test the per-region RSS change (GPTLrss_delta): a region which
+ * touches new memory is charged for it, its siblings are not. */
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>  /* getpid */
+
+/* This macro prints an error message with line number and name of
+ * test program. */
+#define ERR do { \
+fflush(stdout); /* Make sure our stdout is synced with stderr. */ \
+fprintf(stderr, "Sorry! Unexpected result, %s, line: %d\n", \
+	__FILE__, __LINE__);				    \
+fflush(stderr);                                             \
+return 2;                                                   \
+} while (0)
+
+#define MAX_LINE 512
+#define NBYTES (64*1024*1024)
+
+/* Find the first row of region name in the timing file. Return 0 if
+ * found, with its RSS change and largest growth in MB. */
+static int
+find_row(const char *file, const char *name, double *delta, double *max)
+{
+   FILE *fp;
+   char line[MAX_LINE];
+   char rowname[MAX_LINE];
+   char recurse[MAX_LINE];
+   long calls;
+   int ret = -1;
+
+   if (!(fp = fopen(file, "r")))
+      return -1;
+   while (ret && fgets(line, MAX_LINE, fp))
+      if (sscanf(line, "%s %ld %s %lf %lf", rowname, &calls, recurse, delta, max) == 5 &&
+	  !strcmp(rowname, name))
+	 ret = 0;
+   fclose(fp);
+   return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+   char file[MAX_LINE];
+   char *buf;
+   double delta, max;
+
+   printf("\n*** Testing GPTL RSS change per region.\n");
+   printf("*** testing RSS_delta column...");
+   {
+      /* Only the RSS columns follow the call counts. */
+      if (GPTLsetoption(GPTLrss_delta, 1)) ERR;
+      if (GPTLsetoption(GPTLwall, 0)) ERR;
+      if (GPTLinitialize()) ERR;
+
+      if (GPTLstart("grow")) ERR;
+      if (!(buf = malloc(NBYTES))) ERR;
+      memset(buf, 1, NBYTES);
+      if (GPTLstop("grow")) ERR;
+
+      if (GPTLstart("flat")) ERR;
+      if (GPTLstop("flat")) ERR;
+
+      sprintf(file, "timing.rss.%ld", (long)getpid());
+      if (GPTLpr_file(file)) ERR;
+      if (find_row(file, "grow", &delta, &max)) ERR;
+      if (delta < 32. || max != delta) ERR;
+      if (find_row(file, "flat", &delta, &max)) ERR;
+      if (delta > 1. || delta < -1.) ERR;
+
+      free(buf);
+      remove(file);
+      if (GPTLfinalize()) ERR;
+   }
+   printf("ok\n");
+   printf("\n*** SUCCESS!\n");
+   return 0;
+}
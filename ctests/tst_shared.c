@@ -0,0 +1,121 @@
+/* Test GPTLpr_shared_file(), which writes the reports of all ranks
+ * into one indexed file, and GPTLextract_shared(), which reads one
+ * rank's report back out of it. */
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>  /* getpid */
+
+#ifdef HAVE_LIBMPI
+#include <mpi.h>
+#endif
+
+/* This macro prints an error message with line number and name of
+ * test program. */
+#define ERR do { \
+fflush(stdout); /* Make sure our stdout is synced with stderr. */ \
+fprintf(stderr, "Sorry! Unexpected result, %s, line: %d\n", \
+	__FILE__, __LINE__);				    \
+fflush(stderr);                                             \
+return 2;                                                   \
+} while (0)
+
+#define MAX_LINE 256
+
+/* Each run needs its own files: make -j check runs the test alone and
+ * under mpiexec at the same time, and without MPI each copy started by
+ * mpiexec is a run of its own. */
+static char file_name[MAX_LINE];
+
+/* Return 1 if some line of "file" contains "str". */
+static int
+contains(const char *file, const char *str)
+{
+   FILE *fp;
+   char line[MAX_LINE];
+   int ret = 0;
+
+   if (!(fp = fopen(file, "r")))
+      return 0;
+   while (!ret && fgets(line, MAX_LINE, fp))
+      if (strstr(line, str))
+	 ret = 1;
+   fclose(fp);
+   return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+   int iam = 0;
+   int nranks = 1;
+   long pid = (long)getpid();
+
+#ifdef HAVE_LIBMPI
+   if (MPI_Init(&argc, &argv) != MPI_SUCCESS) ERR;
+   if (MPI_Comm_rank(MPI_COMM_WORLD, &iam) != MPI_SUCCESS) ERR;
+   if (MPI_Comm_size(MPI_COMM_WORLD, &nranks) != MPI_SUCCESS) ERR;
+   /* All ranks write the one file named after rank 0's pid. */
+   if (MPI_Bcast(&pid, 1, MPI_LONG, 0, MPI_COMM_WORLD) != MPI_SUCCESS) ERR;
+#endif
+   sprintf(file_name, "timing.shared.%ld", pid);
+
+   if (!iam)
+      printf("\n*** Testing GPTL shared output file.\n");
+   {
+      char region[MAX_LINE];
+      char outfile[MAX_LINE];
+      char badfile[MAX_LINE];
+      int r;
+
+      /* With the PMPI layer, MPI_Init already initialized GPTL. */
+#if !defined(ENABLE_PMPI) || !defined(HAVE_LIBMPI)
+      if (GPTLinitialize()) ERR;
+#endif
+      /* Each rank times a region named after itself. */
+      sprintf(region, "region_on_rank_%d", iam);
+      if (GPTLstart(region)) ERR;
+      if (GPTLstop(region)) ERR;
+
+#ifdef HAVE_LIBMPI
+      if (GPTLpr_shared_file(MPI_COMM_WORLD, file_name)) ERR;
+      if (MPI_Barrier(MPI_COMM_WORLD) != MPI_SUCCESS) ERR;
+#else
+      if (GPTLpr_shared_file(file_name)) ERR;
+#endif
+
+      /* Every rank's report can be extracted and holds only its own
+       * region. */
+      if (!iam) {
+	 printf("*** testing extraction of %d ranks...", nranks);
+	 for (r = 0; r < nranks; r++) {
+	    sprintf(outfile, "%s.%d", file_name, r);
+	    if (GPTLextract_shared(file_name, r, outfile)) ERR;
+	    sprintf(region, "region_on_rank_%d", r);
+	    if (!contains(outfile, region)) ERR;
+	    if (!contains(outfile, "Stats for thread 0:")) ERR;
+	    if (contains(outfile, "GPTL timing for rank")) ERR;
+	    if (r > 0 && contains(outfile, "region_on_rank_0")) ERR;
+	 }
+	 printf("ok\n");
+
+	 printf("*** testing bad arguments...");
+	 sprintf(badfile, "%s.bad", file_name);
+	 if (GPTLextract_shared(file_name, nranks, badfile) == 0) ERR;
+	 if (GPTLextract_shared(file_name, -1, badfile) == 0) ERR;
+	 sprintf(outfile, "%s.0", file_name);
+	 if (GPTLextract_shared(outfile, 0, badfile) == 0) ERR;
+	 printf("ok\n");
+      }
+   }
+
+#ifdef HAVE_LIBMPI
+   if (MPI_Finalize() != MPI_SUCCESS) ERR;
+#endif
+   if (GPTLfinalize()) ERR;
+   if (!iam)
+      printf("\n*** SUCCESS!\n");
+   return 0;
+}
@@ -0,0 +1,106 @@
+/* Test the on-demand snapshot (GPTLsignal_dump): SIGUSR1 appends the
+ * stats of all timers, and the regions currently on, to
+ * timing.snapshot.<pid> without stopping the process. */
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>  /* usleep, getpid */
+
+/* This macro prints an error message with line number and name of
+ * test program. */
+#define ERR do { \
+fflush(stdout); /* Make sure our stdout is synced with stderr. */ \
+fprintf(stderr, "Sorry! Unexpected result, %s, line: %d\n", \
+	__FILE__, __LINE__);				    \
+fflush(stderr);                                             \
+return 2;                                                   \
+} while (0)
+
+#define MAX_LINE 512
+
+/* Wait up to 5 seconds for the snapshot thread to finish a snapshot,
+ * which ends with an empty line. Return the number of lines which
+ * contain str, or -1 if there is no complete snapshot. */
+static int
+count_lines(const char *file, const char *str)
+{
+   FILE *fp;
+   char line[MAX_LINE];
+   int n = -1;
+   int i;
+
+   for (i = 0; i < 500 && n < 0; i++) {
+      usleep(10000);
+      if (!(fp = fopen(file, "r")))
+	 continue;
+      n = 0;
+      while (fgets(line, MAX_LINE, fp))
+	 if (strstr(line, str))
+	    ++n;
+      /* Complete once the empty line after the snapshot is written. */
+      if (strcmp(line, "\n"))
+	 n = -1;
+      fclose(fp);
+   }
+   return n;
+}
+
+int
+main(int argc, char **argv)
+{
+   char file[MAX_LINE];
+   struct sigaction act;
+   int i;
+
+   printf("\n*** Testing GPTL on-demand snapshot.\n");
+#ifndef HAVE_LIBPTHREAD
+   printf("*** pthreads are not available: skipping\n");
+   return 0;
+#endif
+
+   printf("*** testing snapshot on SIGUSR1...");
+   {
+      sprintf(file, "timing.snapshot.%ld", (long)getpid());
+      remove(file);
+
+      if (GPTLsetoption(GPTLsignal_dump, 1)) ERR;
+      if (GPTLinitialize()) ERR;
+
+      if (GPTLstart("outer")) ERR;
+      for (i = 0; i < 3; i++) {
+	 if (GPTLstart("done")) ERR;
+	 if (GPTLstop("done")) ERR;
+      }
+      if (GPTLstart("inner")) ERR;
+      usleep(1000);
+
+      /* Both running regions are listed, innermost indented further. */
+      if (raise(SIGUSR1)) ERR;
+      if (count_lines(file, "GPTL snapshot of pid") != 1) ERR;
+      if (count_lines(file, "Regions on, outermost first") != 1) ERR;
+      if (count_lines(file, "  outer ") != 1) ERR;
+      if (count_lines(file, "    inner ") != 1) ERR;
+      if (count_lines(file, "done ") != 1) ERR;
+
+      /* The process went on, and a second signal appends a snapshot. */
+      if (GPTLstop("inner")) ERR;
+      if (GPTLstop("outer")) ERR;
+      if (raise(SIGUSR1)) ERR;
+      for (i = 0; i < 500 && count_lines(file, "GPTL snapshot of pid") < 2; i++)
+	 ;
+      if (count_lines(file, "GPTL snapshot of pid") != 2) ERR;
+      if (count_lines(file, "Regions on, outermost first") != 1) ERR;
+
+      /* GPTLfinalize restores the default SIGUSR1 action. */
+      if (GPTLfinalize()) ERR;
+      if (sigaction(SIGUSR1, NULL, &act)) ERR;
+      if (act.sa_handler != SIG_DFL) ERR;
+      remove(file);
+   }
+   printf("ok\n");
+   printf("\n*** SUCCESS!\n");
+   return 0;
+}
@@ -0,0 +1,104 @@
+/* Test the hang and straggler watchdog (GPTLwatchdog): a region on
+ * longer than registered, or far longer than its earlier calls, is
+ * reported once on stderr with its call stack. */
+
+#include "config.h"
+#include "gptl.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>  /* usleep, getpid, dup, dup2 */
+
+/* This macro prints an error message with line number and name of
+ * test program. */
+#define ERR do { \
+fflush(stdout); /* Make sure our stdout is synced with stderr. */ \
+fprintf(stderr, "Sorry! Unexpected result, %s, line: %d\n", \
+	__FILE__, __LINE__);				    \
+fflush(stderr);                                             \
+return 2;                                                   \
+} while (0)
+
+#define MAX_LINE 512
+
+/* Return the number of lines of file which contain str. */
+static int
+count_lines(const char *file, const char *str)
+{
+   FILE *fp;
+   char line[MAX_LINE];
+   int n = 0;
+
+   if (!(fp = fopen(file, "r")))
+      return -1;
+   while (fgets(line, MAX_LINE, fp))
+      if (strstr(line, str))
+	 ++n;
+   fclose(fp);
+   return n;
+}
+
+int
+main(int argc, char **argv)
+{
+   char file[MAX_LINE];
+   int saved;
+   int i;
+
+   printf("\n*** Testing GPTL watchdog.\n");
+#ifndef HAVE_LIBPTHREAD
+   printf("*** pthreads are not available: skipping\n");
+   return 0;
+#endif
+
+   printf("*** testing watchdog reports...");
+   {
+      if (GPTLsetoption(GPTLwatchdog, -1) == 0) ERR;
+      if (GPTLwatchdog_expect("slow", -1.) == 0) ERR;
+
+      /* Capture the reports, which go to stderr. */
+      sprintf(file, "timing.watchdog.%ld", (long)getpid());
+      fflush(stderr);
+      if ((saved = dup(fileno(stderr))) < 0) ERR;
+      if (!freopen(file, "w", stderr)) ERR;
+
+      if (GPTLsetoption(GPTLwatchdog, 50)) ERR;
+      if (GPTLwatchdog_expect("slow", 0.1)) ERR;
+      if (GPTLinitialize()) ERR;
+
+      /* A registered limit: reported once although late for many periods. */
+      if (GPTLstart("main")) ERR;
+      if (GPTLstart("slow")) ERR;
+      usleep(400000);
+      if (GPTLstop("slow")) ERR;
+
+      /* A straggler among calls which take about a millisecond. */
+      for (i = 0; i < 20; i++) {
+	 if (GPTLstart("steady")) ERR;
+	 usleep(1000);
+	 if (GPTLstop("steady")) ERR;
+      }
+      if (GPTLstart("steady")) ERR;
+      usleep(500000);
+      if (GPTLstop("steady")) ERR;
+      if (GPTLstop("main")) ERR;
+      if (GPTLfinalize()) ERR;
+
+      fflush(stderr);
+      if (dup2(saved, fileno(stderr)) < 0) ERR;
+      close(saved);
+
+      if (count_lines(file, "GPTL watchdog:") != 2) ERR;
+      if (count_lines(file, "region slow on for") != 1) ERR;
+      if (count_lines(file, "(registered)") != 1) ERR;
+      if (count_lines(file, "region steady on for") != 1) ERR;
+      if (count_lines(file, "(mean + 10 sigma of completed calls)") != 1) ERR;
+      if (count_lines(file, "call stack: main > slow") != 1) ERR;
+      if (count_lines(file, "call stack: main > steady") != 1) ERR;
+      /* "main" is late only because of its children, and has no limit. */
+      if (count_lines(file, "region main") != 0) ERR;
+      remove(file);
+   }
+   printf("ok\n");
+   printf("\n*** SUCCESS!\n");
+   return 0;
+}
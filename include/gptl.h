@@ -31,6 +31,22 @@ typedef enum {
   GPTLdopr_multparent = 14, /* Print multiple parent info (true) */
   GPTLdopr_collision  = 15, /* Print hastable collision info (true) */
   GPTLdopr_memusage   = 27, /* Call GPTLprint_memusage when auto-instrumented */
+  GPTLexclusive       = 28, /* Add a column for exclusive (self) wallclock time (true) */
+  GPTLhotspots        = 29, /* Number of regions listed in each hotspot ranking (10, 0=none) */
+  GPTLohdwarn         = 30, /* Warn about regions with mean time < this x overhead (10, 0=none) */
+  GPTLsubtract_ohd    = 31, /* Subtract estimated GPTL overhead from reported times (false) */
+  GPTLshared_output   = 32, /* MPI_Finalize writes one indexed timing.shared (PMPI-mode only) (false) */
+  GPTLimbalance       = 33, /* Number of regions listed in the summary's load imbalance ranking (10, 0=none) */
+  GPTLdump_summary    = 34, /* GPTLpr_summary also writes a binary <file>.bin for gptlcmp (false) */
+  GPTLcomm_stats      = 35, /* Also print MPI stats by communicator (PMPI-mode only) (false) */
+  GPTLpeer_stats      = 36, /* Also print point-to-point MPI stats by peer (PMPI-mode only) (false) */
+  GPTLreq_stats       = 37, /* Also print overlap of nonblocking MPI requests (PMPI-mode only) (false) */
+  GPTLlate_stats      = 38, /* Also estimate wait for late ranks in MPI collectives (PMPI-mode only) (false) */
+  GPTLclock_sync      = 39, /* Align clocks to rank 0 by ping-pong, 2=also fit drift (PMPI-mode only) (0) */
+  GPTLlive_stats      = 40, /* Publish timers in shared memory /gptl.<pid> for live monitoring (false) */
+  GPTLsignal_dump     = 41, /* SIGUSR1 appends a snapshot of all timers to timing.snapshot.<pid> (false) */
+  GPTLwatchdog        = 42, /* Period (ms) of scans for regions on far longer than expected (0=none) */
+  GPTLrss_delta       = 43, /* Print the change in process RSS between start and stop (false) */
   GPTLprint_method    = 16, /* Tree print method: first parent, last parent
 			       most frequent, or full tree (most frequent) */
   GPTLtablesize       = 50, /* per-thread size of hash table */
@@ -77,6 +93,23 @@ typedef enum {
   GPTLfull_tree     = 4   /* complete call tree */
 } Method;
 
+/*
+** Components of the per-call cost of GPTLstart/GPTLstop, in the order returned by
+** GPTLget_overhead_components()
+*/
+
+typedef enum {
+  GPTLohd_fortran        = 0, /* Fortran wrapper layer */
+  GPTLohd_thread         = 1, /* get thread number */
+  GPTLohd_genhashidx     = 2, /* generate hash index */
+  GPTLohd_getentry       = 3, /* find hashtable entry */
+  GPTLohd_utr            = 4, /* underlying timing routine */
+  GPTLohd_misc           = 5, /* misc start/stop computations */
+  GPTLohd_papi           = 6, /* read PAPI counters */
+  GPTLohd_getentry_instr = 7, /* find hashtable entry for auto-instrumented calls */
+  GPTLohd_ncomp          = 8  /* number of components */
+} Ohdcomp;
+
 /*
 ** Function prototypes
 */
@@ -97,12 +130,14 @@ extern int GPTLpr (const int);
 extern int GPTLpr_file (const char *);
 
 /*
-** Use K&R prototype for these 3 because they require MPI
+** Use K&R prototype for these 4 because they require MPI
 ** C++ compilers can encounter problems
 */
 extern int GPTLpr_summary ();
 extern int GPTLpr_summary_file ();
+extern int GPTLpr_shared_file ();
 extern int GPTLbarrier ();
+extern int GPTLextract_shared (const char *, const int, const char *);
 
 extern int GPTLreset (void);
 extern int GPTLreset_timer (char *);
@@ -118,6 +153,7 @@ extern int GPTLquery (const char *, int, int *, int *, double *, double *, doubl
 extern int GPTLquerycounters (const char *, int, long long *);
 extern int GPTLget_wallclock (const char *, int, double *);
 extern int GPTLget_wallclock_latest (const char *, int, double *);
+extern int GPTLget_exclusive (const char *, int, double *);
 extern int GPTLget_threadwork (const char *, double *, double *);
 extern int GPTLstartstop_val (const char *, double);
 extern int GPTLget_eventvalue (const char *, const char *, int, double *);
@@ -129,6 +165,9 @@ extern int GPTLevent_code_to_name (const int, char *);
 extern int GPTLnum_errors (void);
 extern int GPTLnum_warn (void);
 extern int GPTLget_count (const char *, int, int *);
+extern int GPTLget_overhead_components (double *, const int);
+extern int GPTLget_clock_offset (double *, double *);
+extern int GPTLwatchdog_expect (const char *, const double);
 
 #ifdef __cplusplus
 };
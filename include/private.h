@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <sys/time.h>
+#include <stdint.h>       /* uintptr_t */
 
 #ifndef MIN
 #define MIN(X,Y) ((X) < (Y) ? (X) : (Y))
@@ -58,10 +59,22 @@ typedef struct {
   double last;              /* timestamp from last call */
   double latest;            /* most recent delta */
   double accum;             /* accumulated time */
-  float max;                /* longest time for start/stop pair */
-  float min;                /* shortest time for start/stop pair */
+  double excl;              /* accumulated exclusive (self) time: accum minus time in children */
+  double sumsq;             /* sum of squared start/stop times, for the watchdog's std. dev. */
+  unsigned long nchild;     /* start/stop pairs of direct children (for overhead subtraction) */
+  unsigned long ndesc;      /* start/stop pairs of all descendants */
+  unsigned long ndesc_start;/* ndesc when the timer was last started */
+  double max;               /* longest time for start/stop pair */
+  double min;               /* shortest time for start/stop pair */
 } Wallstats;
 
+typedef struct {
+  double last;              /* process RSS (MB) at "start" */
+  double accum;             /* accumulated RSS change over start/stop pairs (MB) */
+  double max;               /* largest growth in one start/stop pair (MB) */
+  unsigned long count;      /* start/stop pairs sampled: a failed RSS read skips the pair */
+} Rssstats;
+
 typedef struct {
   long long last[MAX_AUX];  /* array of saved counters from "start" */
   long long accum[MAX_AUX]; /* accumulator for counters */
@@ -81,18 +94,74 @@ typedef struct {
   int denomidx;     /* derived event: PAPI counter array index for denominator */
 } Pr_event;
 
+/* MPI message size histogram: bucket 0 is 0 bytes, bucket b is [2^(b-1), 2^b) */
+#define MSGHIST_NBUCKET 32
+
+typedef struct {
+  unsigned long count[MSGHIST_NBUCKET]; /* calls per size bucket */
+  double time[MSGHIST_NBUCKET];         /* wallclock per size bucket */
+} Msghist;
+
+/*
+** Live statistics segment (GPTLlive_stats, see live.c): POSIX shared memory named
+** "/gptl.<pid>" which a monitoring agent on the node maps read-only to see the timers of
+** the running process, e.g. bin/gptllive. A Livehdr is followed by maxthreads Liveblocks.
+** Block t holds the regions of thread t in the order they were first started; its first
+** nregions records are valid. Only thread t writes them (or the master thread in
+** GPTLreset, when the others are idle), each under a seqlock: seq is odd while the
+** record changes, so a reader copies the record between two reads of seq and retries
+** if seq was odd or changed. magic is written last, once the segment is ready.
+*/
+#define LIVE_MAGIC "GPTLliv1"
+#define LIVE_NREGION 1024
+
+typedef struct {
+  volatile unsigned int seq;   /* seqlock sequence number */
+  int onflg;                   /* region is running, since timestamp last */
+  unsigned long long count;    /* completed start/stop pairs */
+  double accum;                /* wallclock of completed start/stop pairs */
+  double max;                  /* longest start/stop pair */
+  double min;                  /* shortest start/stop pair */
+  double latest;               /* most recent start/stop pair */
+  double last;                 /* timestamp of the most recent start */
+  int padding[2];
+  char name[MAX_CHARS+1];      /* region name */
+} Liverec;
+
+typedef struct {
+  volatile unsigned int nregions;  /* valid records, only ever grows */
+  unsigned int dropped;            /* regions not published because the block was full */
+  int padding[14];                 /* keep the count off the cache line of the records */
+  Liverec rec[LIVE_NREGION];
+} Liveblock;
+
+typedef struct {
+  char magic[8];            /* LIVE_MAGIC, not NUL-terminated */
+  unsigned int byteorder;   /* DUMP_BYTEORDER as written */
+  unsigned int reclen;      /* sizeof (Liverec) */
+  unsigned int blocklen;    /* sizeof (Liveblock) */
+  unsigned int maxthreads;  /* number of blocks */
+  int pid;                  /* process writing the segment */
+  int padding;
+  double origin;            /* epoch seconds of timestamp 0, or 0 if unknown */
+  char clock[24];           /* name of the underlying timing routine */
+} Livehdr;
+
 typedef struct TIMER {
 #ifdef ENABLE_PMPI
   double nbytes;            /* number of bytes for MPI call */
+  Msghist *msghist;         /* message sizes of MPI call, allocated on first use */
 #endif
 #ifdef HAVE_PAPI
   Papistats aux;            /* PAPI stats  */
 #endif 
   Cpustats cpu;             /* cpu stats */
   Wallstats wall;           /* wallclock stats */
+  Rssstats rss;             /* RSS change stats */
   unsigned long count;      /* number of start/stop calls */
   unsigned long nrecurse;   /* number of recursive start/stop calls */
   void *address;            /* address of timer: used only by _instr routines */
+  Liverec *live;            /* record in the live statistics segment, or NULL */
   struct TIMER *next;       /* next timer in linked list */
   struct TIMER **parent;    /* array of parents */
   struct TIMER **children;  /* array of children */
@@ -105,11 +174,200 @@ typedef struct TIMER {
   char name[MAX_CHARS+1];   /* timer name (user input) */
 } Timer;
 
+#ifdef ENABLE_PMPI
+/*
+** Table of the routines wrapped in pmpi.c (and f_wrappers_pmpi.c for Fortran), and of
+** the routines which get a sync_ timer when GPTLsync_mpi is set. Each has a timer slot
+** (see GPTLstart_slot): the wrappers start and stop their timers through the slots
+** rather than by name, so after a thread's first call of a routine there is no hashing
+** or string compare. A new wrapper must be added here.
+*/
+#define PMPI_ROUTINES(X)						\
+  /* Point-to-point */							\
+  X(Send) X(Recv) X(Sendrecv) X(Isend) X(Issend) X(Irecv) X(Ssend)	\
+  X(Iprobe) X(Probe)							\
+  /* Completion */							\
+  X(Wait) X(Waitall) X(Waitany) X(Waitsome)				\
+  X(Test) X(Testall) X(Testany) X(Testsome)				\
+  /* Collectives */							\
+  X(Barrier) X(Bcast) X(Allreduce) X(Reduce) X(Gather) X(Gatherv)	\
+  X(Scatter) X(Scatterv) X(Allgather) X(Allgatherv) X(Alltoall)		\
+  X(Alltoallv) X(Reduce_scatter) X(Reduce_scatter_block) X(Scan)	\
+  X(Exscan)								\
+  /* Nonblocking collectives */						\
+  X(Ibarrier) X(Ibcast) X(Iallreduce) X(Ireduce) X(Igather)		\
+  X(Igatherv) X(Iscatter) X(Iscatterv) X(Iallgather) X(Iallgatherv)	\
+  X(Ialltoall) X(Ialltoallv)						\
+  /* Neighborhood collectives */					\
+  X(Neighbor_allgather) X(Neighbor_alltoall) X(Neighbor_alltoallv)	\
+  /* One-sided */							\
+  X(Put) X(Get) X(Accumulate) X(Win_fence) X(Win_lock) X(Win_unlock)	\
+  X(Win_flush) X(Win_post) X(Win_start) X(Win_complete) X(Win_wait)	\
+  /* MPI-IO */								\
+  X(File_open) X(File_close) X(File_sync) X(File_set_view)		\
+  X(File_read) X(File_write) X(File_read_at) X(File_write_at)		\
+  X(File_read_all) X(File_write_all) X(File_read_at_all)		\
+  X(File_write_at_all) X(File_iread_at) X(File_iwrite_at)
+
+#define PMPI_SYNC_ROUTINES(X)						\
+  X(Recv) X(Bcast) X(Allreduce) X(Reduce) X(Gather) X(Gatherv)		\
+  X(Scatter) X(Scatterv) X(Allgather) X(Allgatherv) X(Alltoall)		\
+  X(Alltoallv)
+
+#define PMPI_SLOT(r) SLOT_##r,
+#define PMPI_SYNC_SLOT(r) SLOT_sync_##r,
+enum {
+  PMPI_ROUTINES (PMPI_SLOT)
+  PMPI_SYNC_ROUTINES (PMPI_SYNC_SLOT)
+  NSLOT
+};
+#undef PMPI_SLOT
+#undef PMPI_SYNC_SLOT
+
+/* Datatype sizes cached per thread by the PMPI wrappers. Must be a power of 2 */
+#define PMPI_NTYPE 32
+
+/* Communicators with their own stats (GPTLcomm_stats); later ones are lumped together */
+#define COMM_MAX 64
+
+/* Peers with their own stats per thread (GPTLpeer_stats); must be a power of 2 */
+#define PEER_MAX 1024
+
+/* Nonblocking requests tracked in flight per thread (GPTLreq_stats); must be a power of 2 */
+#define REQ_MAX 4096
+
+/* A nonblocking request in flight, from its post to the wait or test which completes it */
+typedef struct {
+  uintptr_t req;                  /* MPI_Request handle, 0 if unused */
+  int slot;                       /* slot of the routine which posted it */
+  double post;                    /* wallclock time at the end of the post */
+  double blocked;                 /* time in wait and test calls on it so far */
+} Reqinfo;
+
+/* Completed nonblocking requests of one thread, indexed by slot of the posting routine */
+typedef struct {
+  unsigned long count[NSLOT];     /* requests completed */
+  double inflight[NSLOT];         /* post to completion */
+  double blocked[NSLOT];          /* in wait and test calls */
+} Reqstats;
+
+/* Per-communicator stats of one thread, indexed by timer slot */
+typedef struct {
+  unsigned long count[NSLOT];     /* calls */
+  double time[NSLOT];             /* wallclock */
+  double bytes[NSLOT];            /* bytes, estimated as for Timer.nbytes */
+} Commstats;
+
+/* Point-to-point stats of one thread with one peer */
+typedef struct {
+  int rank1;                      /* MPI_COMM_WORLD rank of the peer plus 1, 0 if unused */
+  unsigned long nsend;            /* sends to the peer */
+  unsigned long nrecv;            /* receives from the peer */
+  double sendbytes;
+  double recvbytes;
+  double sendtime;
+  double recvtime;
+} Peerstats;
+
+/*
+** Per-thread state of the PMPI wrappers. A routine's slot holds the thread's timer
+** once the routine has been called, so the wrappers skip the hash and bucket scan
+** of GPTLstart/GPTLstop. Being per-thread, none of the tables need locking.
+*/
+typedef struct {
+  int t;                          /* thread index */
+  Timer *slot[NSLOT];             /* timer of each wrapped routine, NULL until first call */
+  uintptr_t type[PMPI_NTYPE];     /* datatype handle, 0 if unused */
+  int typesize[PMPI_NTYPE];       /* its size in bytes, or -1 if not a predefined type */
+  Commstats *comm;                /* COMM_MAX+1 entries by communicator index, the last
+				     for all others. Allocated on first use */
+  Peerstats *peer;                /* PEER_MAX hashed entries by peer rank plus one for all
+				     others. Allocated on first use */
+  int npeer;                      /* used hashed entries of peer */
+  Reqinfo *req;                   /* REQ_MAX hashed requests in flight. Allocated on first use */
+  int nreq;                       /* used entries of req */
+  unsigned long untracked;        /* requests not tracked because req was 3/4 full */
+  Reqstats *reqstats;             /* allocated with req */
+  uintptr_t *reqkey;              /* scratch copy of the request handles of a wait or test */
+  int maxreqkey;                  /* size of reqkey */
+} Pmpithread;
+#endif
+
 typedef struct {
   Timer **entries;          /* array of timers hashed to the same value */
   unsigned int nument;      /* number of entries hashed to the same value */
 } Hashentry;
 
+/* Max centroids in a quantile sketch: quantiles are exact up to this many values */
+#define SKETCH_SIZE 32
+
+typedef struct {
+  double mean;              /* mean of the values in the centroid */
+  double weight;            /* number of values in the centroid */
+} Centroid;
+
+typedef struct {
+  Centroid c[SKETCH_SIZE];  /* centroids sorted by mean */
+  int n;                    /* number of centroids in use */
+} Sketch;
+
+typedef struct {
+  const char *name;         /* region name */
+  double incl;              /* inclusive wallclock time summed over threads (and tasks) */
+  double excl;              /* exclusive (self) wallclock time summed likewise */
+  double ohd;               /* estimated GPTL overhead attributable to the region */
+  unsigned long long count; /* number of start/stop calls */
+} Hotspot;
+
+typedef struct {
+  const char *name;         /* region name */
+  double max;               /* max time across ranks (or threads) */
+  double mean;              /* mean time across ranks (or threads) */
+  unsigned int n;           /* number of ranks (or threads) which invoked the region */
+  int maxp;                 /* rank producing max */
+  int maxt;                 /* thread producing max */
+  int minp;                 /* rank producing the min */
+  int mint;                 /* thread producing the min */
+} Imbal;
+
+/*
+** Binary summary dump written next to timing.summary (see dump.c) and read by gptlcmp.
+** A header followed by nregions fixed-size records, in the writer's native layout:
+** byteorder and reclen let a reader reject a dump from a different architecture.
+*/
+#define DUMP_MAGIC "GPTLdmp1"
+#define DUMP_BYTEORDER 0x01020304u
+
+typedef struct {
+  char magic[8];            /* DUMP_MAGIC, not NUL-terminated */
+  unsigned int byteorder;   /* DUMP_BYTEORDER as written */
+  unsigned int reclen;      /* sizeof (Dumprec) */
+  unsigned int nregions;    /* number of records following */
+  unsigned int nranks;      /* ranks in the summary communicator */
+} Dumphdr;
+
+typedef struct {
+  char name[MAX_CHARS+1];   /* region name */
+  unsigned int nranks;      /* number of ranks which invoked the region */
+  unsigned long long ncalls;/* calls across ranks and threads */
+  double mean;              /* mean across ranks of per-rank max time over threads */
+  double stddev;            /* standard deviation of the same */
+  double median;            /* median of the same */
+  double p95;               /* 95th percentile of the same */
+  double wallmax;           /* max time across ranks and threads */
+  double wallmin;           /* min time across ranks and threads */
+} Dumprec;
+
+typedef struct {
+  const char *outfile;      /* name of file being written */
+  FILE *fp;                 /* stream the report is formatted into */
+  int fd;                   /* descriptor of outfile */
+  bool inmem;               /* fp is an open_memstream: write buf to fd at close */
+  char *buf;                /* in-memory report */
+  size_t len;               /* bytes in buf */
+  char *iobuf;              /* stdio buffer when formatting directly to outfile */
+} Outbuf;
+
 /* Require external data items */
 /* array of thread ids */
 #if ( defined THREADED_OMP )
@@ -142,11 +400,45 @@ extern int GPTLget_overhead (FILE *,                       /* file descriptor */
 			     const int,                    /* tablesize */
 			     bool,                         /* dousepapi */
 			     int,                          /* imperfect_nest */
+			     const int,                    /* thread index */
 			     double *,                     /* self_ohd */
-			     double *);                    /* parent_ohd */
+			     double *,                     /* parent_ohd */
+			     double *);                    /* components (or NULL) */
 extern void GPTLprint_hashstats (FILE *, int, Hashentry **, int);
 extern void GPTLprint_memstats (FILE *, Timer **, int, int, int);
+extern void GPTLprint_hotspots (FILE *, Hotspot *, const int, const char *);
+extern void GPTLprint_ohdwarn (FILE *, Hotspot *, const int, const double);
+extern int GPTLhotspots_setoption (const int, const int);
+extern void GPTLprint_imbalance (FILE *, Imbal *, const int, const char *, const int, const int);
+extern int GPTLimbalance_setoption (const int, const int);
+#ifdef ENABLE_PMPI
+extern void GPTLmsghist_add (Timer *, const double);
+extern void GPTLprint_msghist (FILE *, Timer **, const int, Timer *(const int, const Timer *));
+#endif
+extern int GPTLlive_setoption (const int, const int);
+extern int GPTLlive_init (const int, const char *);
+extern void GPTLlive_finalize (void);
+extern Liverec *GPTLlive_add (const int, const char *);
+extern void GPTLlive_start (const Timer *);
+extern void GPTLlive_stop (const Timer *);
+extern int GPTLdump_setoption (const int, const int);
+extern int GPTLdump_enabled (void);
+extern int GPTLwrite_dump (const char *, const Dumprec *, const int, const int);
+extern int GPTLget_overhead_est (double *, double *);      /* per-call overhead, no printing */
+extern void GPTLget_wallstats_adj (const Timer *, const int, double *, double *);
+extern FILE *GPTLoutbuf_open (Outbuf *, const char *);   /* open report file */
+extern int GPTLoutbuf_close (Outbuf *);                    /* write and close report file */
+extern FILE *GPTLoutbuf_openmem (Outbuf *);              /* format report in memory */
+extern int GPTLoutbuf_closemem (Outbuf *);                 /* caller then owns ob->buf */
+extern int GPTLwrite_all (const int, const char *, size_t);
+extern int GPTLprint_report (FILE *);                      /* body of GPTLpr_file */
+extern void GPTLsketch_init (Sketch *, const double);
+extern void GPTLsketch_merge (Sketch *, const Sketch *);
+extern double GPTLsketch_quantile (const Sketch *, const double);
 extern int GPTLget_nthreads (void);
+extern double GPTLtime_origin (void);                      /* epoch seconds of timestamp 0 */
+extern double GPTLtime_now (void);                         /* wallclock timestamp */
+extern double GPTLget_rss (void);                          /* process RSS in MB, cheaply */
 extern Timer **GPTLget_timersaddr (void);
 
 #ifdef __cplusplus
@@ -184,8 +476,14 @@ extern int GPTLcreate_and_start_events (const int);
 
 #ifdef ENABLE_PMPI
 extern Timer *GPTLgetentry (const char *);
+extern Pmpithread *GPTLstart_slot (const char *, const int);
+extern Timer *GPTLstop_slot (Pmpithread *, const int);
 extern int GPTLpmpi_setoption (const int, const int);
+extern void GPTLprint_commstats (FILE *, const Pmpithread *, const int);
+extern void GPTLprint_reqstats (FILE *, const Pmpithread *, const int);
+extern void GPTLprint_latestats (FILE *);
 extern int GPTLpr_has_been_called (void);      /* needed by MPI_Finalize wrapper*/
+extern int GPTLis_disabled (void);             /* needed by MPI_Finalize wrapper */
 #endif
 
 #endif /* _GPTL_PRIVATE_ */
@@ -0,0 +1,82 @@
+/*
+** dump.c
+**
+** Binary dump of the summary stats of GPTLpr_summary_file(), for run-to-run comparison
+** by the gptlcmp tool. Parsing thousands of text summaries is slow and fragile (names
+** with spaces, columns which change between versions), while the dump is a header and
+** an array of fixed-size records which a reader can load with one read.
+*/
+
+#include "config.h" /* Must be first include. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>         /* open */
+#include <unistd.h>        /* close */
+
+#include "private.h"
+#include "gptl.h"
+
+static bool dodump = false;   /* write <outfile>.bin alongside each summary */
+
+int GPTLdump_setoption (const int option,
+			const int val)
+{
+  switch (option) {
+  case GPTLdump_summary:
+    dodump = (bool) val;
+    return 0;
+  default:
+    break;
+  }
+  return 1;
+}
+
+int GPTLdump_enabled ()
+{
+  return dodump;
+}
+
+/*
+** GPTLwrite_dump: Write summary records to the binary dump file <outfile>.bin
+**
+** Input arguments:
+**   outfile:  name of the text summary being written
+**   recs:     one record per region
+**   nrecs:    number of entries in recs
+**   nranks:   number of ranks summarized
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+int GPTLwrite_dump (const char *outfile, const Dumprec *recs, const int nrecs, const int nranks)
+{
+  Dumphdr hdr;
+  char *dumpfile;    /* outfile with .bin appended */
+  int fd;
+  int ret = 0;
+  static const char *thisfunc = "GPTLwrite_dump";
+
+  if ( ! (dumpfile = (char *) GPTLallocate (strlen (outfile) + 5, thisfunc)))
+    return -1;
+  sprintf (dumpfile, "%s.bin", outfile);
+
+  memset (&hdr, 0, sizeof (hdr));
+  memcpy (hdr.magic, DUMP_MAGIC, sizeof (hdr.magic));
+  hdr.byteorder = DUMP_BYTEORDER;
+  hdr.reclen    = sizeof (Dumprec);
+  hdr.nregions  = nrecs;
+  hdr.nranks    = nranks;
+
+  if ((fd = open (dumpfile, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0) {
+    ret = GPTLerror ("%s: cannot open %s for writing\n", thisfunc, dumpfile);
+  } else {
+    if (GPTLwrite_all (fd, (const char *) &hdr, sizeof (hdr)) != 0 ||
+	GPTLwrite_all (fd, (const char *) recs, nrecs * sizeof (Dumprec)) != 0)
+      ret = GPTLerror ("%s: error writing %s\n", thisfunc, dumpfile);
+    if (close (fd) != 0 && ret == 0)
+      ret = GPTLerror ("%s: error closing %s\n", thisfunc, dumpfile);
+  }
+  free (dumpfile);
+  return ret;
+}
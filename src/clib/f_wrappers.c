@@ -25,6 +25,8 @@
 #define gptlpr_file gptlpr_file_
 #define gptlpr_summary gptlpr_summary_
 #define gptlpr_summary_file gptlpr_summary_file_
+#define gptlpr_shared_file gptlpr_shared_file_
+#define gptlextract_shared gptlextract_shared_
 #define gptlbarrier gptlbarrier_
 #define gptlreset gptlreset_
 #define gptlreset_timer gptlreset_timer_
@@ -42,6 +44,7 @@
 #define gptlquerycounters gptlquerycounters_
 #define gptlget_wallclock gptlget_wallclock_
 #define gptlget_wallclock_latest gptlget_wallclock_latest_
+#define gptlget_exclusive gptlget_exclusive_
 #define gptlget_threadwork gptlget_threadwork_
 #define gptlstartstop_val gptlstartstop_val_
 #define gptlget_eventvalue gptlget_eventvalue_
@@ -53,6 +56,9 @@
 #define gptlnum_errors gptlnum_errors_
 #define gptlnum_warn gptlnum_warn_
 #define gptlget_count gptlget_count_
+#define gptlget_overhead_components gptlget_overhead_components_
+#define gptlget_clock_offset gptlget_clock_offset_
+#define gptlwatchdog_expect gptlwatchdog_expect_
 #define gptl_papilibraryinit gptl_papilibraryinit_
 #define gptlevent_name_to_code gptlevent_name_to_code_
 #define gptlevent_code_to_name gptlevent_code_to_name_
@@ -65,6 +71,8 @@
 #define gptlpr_file gptlpr_file__
 #define gptlpr_summary gptlpr_summary__
 #define gptlpr_summary_file gptlpr_summary_file__
+#define gptlpr_shared_file gptlpr_shared_file__
+#define gptlextract_shared gptlextract_shared__
 #define gptlbarrier gptlbarrier_
 #define gptlreset gptlreset_
 #define gptlreset_timer gptlreset_timer__
@@ -82,6 +90,7 @@
 #define gptlquerycounters gptlquerycounters_
 #define gptlget_wallclock gptlget_wallclock__
 #define gptlget_wallclock_latest gptlget_wallclock_latest__
+#define gptlget_exclusive gptlget_exclusive__
 #define gptlget_threadwork gptlget_threadwork__
 #define gptlstartstop_val gptlstartstop_val__
 #define gptlget_eventvalue gptlget_eventvalue__
@@ -93,6 +102,9 @@
 #define gptlnum_errors gptlnum_errors__
 #define gptlnum_warn gptlnum_warn__
 #define gptlget_count gptlget_count__
+#define gptlget_overhead_components gptlget_overhead_components__
+#define gptlget_clock_offset gptlget_clock_offset__
+#define gptlwatchdog_expect gptlwatchdog_expect__
 #define gptl_papilibraryinit gptl_papilibraryinit__
 #define gptlevent_name_to_code gptlevent_name_to_code__
 #define gptlevent_code_to_name gptlevent_code_to_name__
@@ -107,12 +119,15 @@ int gptlpr_file (char *file, int nc);
 #ifdef HAVE_LIBMPI
 int gptlpr_summary (int *fcomm);
 int gptlpr_summary_file (int *fcomm, char *name, int nc);
+int gptlpr_shared_file (int *fcomm, char *name, int nc);
 int gptlbarrier (int *fcomm, char *name, int nc);
 #else
 int gptlpr_summary (void);
 int gptlpr_summary_file (char *name, int nc);
+int gptlpr_shared_file (char *name, int nc);
 int gptlbarrier (void);
 #endif
+int gptlextract_shared (char *infile, int *rank, char *outfile, int nc1, int nc2);
 int gptlreset (void);
 int gptlreset_timer (char *name, int nc);
 int gptlstamp (double *wall, double *usr, double *sys);
@@ -131,6 +146,7 @@ int gptlquery (const char *name, int *t, int *count, int *onflg, double *wallclo
 int gptlquerycounters (const char *name, int *t, long long *papicounters_out, int nc);
 int gptlget_wallclock (const char *name, int *t, double *value, int nc);
 int gptlget_wallclock_last (const char *name, int *t, double *value, int nc);
+int gptlget_exclusive (const char *name, int *t, double *value, int nc);
 int gptlget_threadwork (const char *name, double *maxwork, double *imbal, int nc);
 int gptlstartstop_val (const char *name, double *value, int nc);
 int gptlget_eventvalue (const char *timername, const char *eventname, int *t, double *value, 
@@ -143,6 +159,9 @@ int gptlprint_rusage (const char *str, int nc);
 int gptlnum_errors (void);
 int gptlnum_warn (void);
 int gptlget_count (char *, int *, int *, int);
+int gptlget_overhead_components (double *comp, int *ncomp);
+int gptlget_clock_offset (double *offset, double *drift);
+int gptlwatchdog_expect (char *name, double *maxsec, int nc);
 #ifdef HAVE_PAPI
 int gptl_papilibraryinit (void);
 int gptlevent_name_to_code (const char *str, int *code, int nc);
@@ -208,6 +227,22 @@ int gptlpr_summary_file (int *fcomm, char *outfile, int nc)
   return ret;
 }
 
+int gptlpr_shared_file (int *fcomm, char *outfile, int nc)
+{
+  MPI_Comm ccomm;
+  char locfile[nc+1];
+
+  snprintf (locfile, nc+1, "%s", outfile);
+
+#ifdef HAVE_COMM_F2C
+  ccomm = MPI_Comm_f2c (*fcomm);
+#else
+  /* Punt and try just casting the Fortran communicator */
+  ccomm = (MPI_Comm) *fcomm;
+#endif
+  return GPTLpr_shared_file (ccomm, locfile);
+}
+
 int gptlbarrier (int *fcomm, char *name, int nc)
 {
   MPI_Comm ccomm;
@@ -241,6 +276,14 @@ int gptlpr_summary_file (char *outfile, int nc)
   return ret;
 }
 
+int gptlpr_shared_file (char *outfile, int nc)
+{
+  char locfile[nc+1];
+
+  snprintf (locfile, nc+1, "%s", outfile);
+  return GPTLpr_shared_file (locfile);
+}
+
 int gptlbarrier (void)
 {
   return GPTLerror ("gptlbarrier: Need to build GPTL with #define HAVE_LIBMPI to enable this routine\n");
@@ -248,6 +291,15 @@ int gptlbarrier (void)
 
 #endif
 
+int gptlextract_shared (char *infile, int *rank, char *outfile, int nc1, int nc2)
+{
+  char locinfile[nc1+1];
+  char locoutfile[nc2+1];
+
+  snprintf (locinfile, nc1+1, "%s", infile);
+  snprintf (locoutfile, nc2+1, "%s", outfile);
+  return GPTLextract_shared (locinfile, *rank, locoutfile);
+}
 
 int gptlreset (void)
 {
@@ -373,6 +425,16 @@ int gptlget_wallclock_latest (const char *name, int *t, double *value, int nc)
   return GPTLget_wallclock_latest (cname, *t, value);
 }
 
+int gptlget_exclusive (const char *name, int *t, double *value, int nc)
+{
+  char cname[nc+1];
+
+  strncpy (cname, name, nc);
+  cname[nc] = '\0';
+
+  return GPTLget_exclusive (cname, *t, value);
+}
+
 int gptlget_threadwork (const char *name, double *maxwork, double *imbal, int nc)
 {
   char cname[nc+1];
@@ -468,6 +530,26 @@ int gptlget_count (char *name, int *t, int *count, int nc)
   return GPTLget_count (cname, *t, count);
 }
 
+int gptlget_overhead_components (double *comp, int *ncomp)
+{
+  return GPTLget_overhead_components (comp, *ncomp);
+}
+
+int gptlget_clock_offset (double *offset, double *drift)
+{
+  return GPTLget_clock_offset (offset, drift);
+}
+
+int gptlwatchdog_expect (char *name, double *maxsec, int nc)
+{
+  char cname[nc+1];
+
+  strncpy (cname, name, nc);
+  cname[nc] = '\0';
+
+  return GPTLwatchdog_expect (cname, *maxsec);
+}
+
 #ifdef HAVE_PAPI
 #include <papi.h>
 
@@ -1,6 +1,7 @@
 #include "config.h" /* Must be first include. */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef HAVE_LIBMPI
 #include <mpi.h>
@@ -37,6 +38,55 @@
 #define mpi_alltoallv mpi_alltoallv_
 #define mpi_scatterv mpi_scatterv_
 #define mpi_test mpi_test_
+#define mpi_waitany mpi_waitany_
+#define mpi_waitsome mpi_waitsome_
+#define mpi_testall mpi_testall_
+#define mpi_testany mpi_testany_
+#define mpi_testsome mpi_testsome_
+#define mpi_reduce_scatter mpi_reduce_scatter_
+#define mpi_reduce_scatter_block mpi_reduce_scatter_block_
+#define mpi_scan mpi_scan_
+#define mpi_exscan mpi_exscan_
+#define mpi_ibarrier mpi_ibarrier_
+#define mpi_ibcast mpi_ibcast_
+#define mpi_iallreduce mpi_iallreduce_
+#define mpi_ireduce mpi_ireduce_
+#define mpi_igather mpi_igather_
+#define mpi_igatherv mpi_igatherv_
+#define mpi_iscatter mpi_iscatter_
+#define mpi_iscatterv mpi_iscatterv_
+#define mpi_iallgather mpi_iallgather_
+#define mpi_iallgatherv mpi_iallgatherv_
+#define mpi_ialltoall mpi_ialltoall_
+#define mpi_ialltoallv mpi_ialltoallv_
+#define mpi_neighbor_allgather mpi_neighbor_allgather_
+#define mpi_neighbor_alltoall mpi_neighbor_alltoall_
+#define mpi_neighbor_alltoallv mpi_neighbor_alltoallv_
+#define mpi_put mpi_put_
+#define mpi_get mpi_get_
+#define mpi_accumulate mpi_accumulate_
+#define mpi_win_fence mpi_win_fence_
+#define mpi_win_lock mpi_win_lock_
+#define mpi_win_unlock mpi_win_unlock_
+#define mpi_win_flush mpi_win_flush_
+#define mpi_win_post mpi_win_post_
+#define mpi_win_start mpi_win_start_
+#define mpi_win_complete mpi_win_complete_
+#define mpi_win_wait mpi_win_wait_
+#define mpi_file_open mpi_file_open_
+#define mpi_file_set_view mpi_file_set_view_
+#define mpi_file_close mpi_file_close_
+#define mpi_file_sync mpi_file_sync_
+#define mpi_file_read mpi_file_read_
+#define mpi_file_write mpi_file_write_
+#define mpi_file_read_at mpi_file_read_at_
+#define mpi_file_write_at mpi_file_write_at_
+#define mpi_file_read_all mpi_file_read_all_
+#define mpi_file_write_all mpi_file_write_all_
+#define mpi_file_read_at_all mpi_file_read_at_all_
+#define mpi_file_write_at_all mpi_file_write_at_all_
+#define mpi_file_iread_at mpi_file_iread_at_
+#define mpi_file_iwrite_at mpi_file_iwrite_at_
 
 #elif ( defined FORTRANDOUBLEUNDERSCORE )
 
@@ -69,6 +119,55 @@
 #define mpi_alltoallv mpi_alltoallv__
 #define mpi_scatterv mpi_scatterv__
 #define mpi_test mpi_test__
+#define mpi_waitany mpi_waitany__
+#define mpi_waitsome mpi_waitsome__
+#define mpi_testall mpi_testall__
+#define mpi_testany mpi_testany__
+#define mpi_testsome mpi_testsome__
+#define mpi_reduce_scatter mpi_reduce_scatter__
+#define mpi_reduce_scatter_block mpi_reduce_scatter_block__
+#define mpi_scan mpi_scan__
+#define mpi_exscan mpi_exscan__
+#define mpi_ibarrier mpi_ibarrier__
+#define mpi_ibcast mpi_ibcast__
+#define mpi_iallreduce mpi_iallreduce__
+#define mpi_ireduce mpi_ireduce__
+#define mpi_igather mpi_igather__
+#define mpi_igatherv mpi_igatherv__
+#define mpi_iscatter mpi_iscatter__
+#define mpi_iscatterv mpi_iscatterv__
+#define mpi_iallgather mpi_iallgather__
+#define mpi_iallgatherv mpi_iallgatherv__
+#define mpi_ialltoall mpi_ialltoall__
+#define mpi_ialltoallv mpi_ialltoallv__
+#define mpi_neighbor_allgather mpi_neighbor_allgather__
+#define mpi_neighbor_alltoall mpi_neighbor_alltoall__
+#define mpi_neighbor_alltoallv mpi_neighbor_alltoallv__
+#define mpi_put mpi_put__
+#define mpi_get mpi_get__
+#define mpi_accumulate mpi_accumulate__
+#define mpi_win_fence mpi_win_fence__
+#define mpi_win_lock mpi_win_lock__
+#define mpi_win_unlock mpi_win_unlock__
+#define mpi_win_flush mpi_win_flush__
+#define mpi_win_post mpi_win_post__
+#define mpi_win_start mpi_win_start__
+#define mpi_win_complete mpi_win_complete__
+#define mpi_win_wait mpi_win_wait__
+#define mpi_file_open mpi_file_open__
+#define mpi_file_set_view mpi_file_set_view__
+#define mpi_file_close mpi_file_close__
+#define mpi_file_sync mpi_file_sync__
+#define mpi_file_read mpi_file_read__
+#define mpi_file_write mpi_file_write__
+#define mpi_file_read_at mpi_file_read_at__
+#define mpi_file_write_at mpi_file_write_at__
+#define mpi_file_read_all mpi_file_read_all__
+#define mpi_file_write_all mpi_file_write_all__
+#define mpi_file_read_at_all mpi_file_read_at_all__
+#define mpi_file_write_at_all mpi_file_write_at_all__
+#define mpi_file_iread_at mpi_file_iread_at__
+#define mpi_file_iwrite_at mpi_file_iwrite_at__
 
 #endif
 
@@ -88,6 +187,12 @@ void mpi_finalize (MPI_Fint *ierr);
 #define MPI_STATUS_SIZE MPI_STATUS_SIZE_IN_INTS
 #endif
 
+/*
+** Max requests of the routines which complete arrays of requests (mpi_waitall etc.).
+** If this limit is exceeded, MPI_Abort is called.
+*/
+#define LOCAL_ARRAY_SIZE 128
+
 /* Local prototypes */
 void mpi_send (void *buf, MPI_Fint *count, MPI_Fint *datatype, MPI_Fint *dest,
 	       MPI_Fint *tag, MPI_Fint *comm, MPI_Fint *__ierr);
@@ -155,6 +260,123 @@ void mpi_scatterv (void *sendbuf, MPI_Fint *sendcnts, MPI_Fint *displs,
 		   MPI_Fint *__ierr );
 void mpi_test (MPI_Fint *request, MPI_Fint *flag, MPI_Fint *status, 
 	       MPI_Fint *__ierr );
+void mpi_waitany (MPI_Fint *count, MPI_Fint array_of_requests[], MPI_Fint *indx,
+		  MPI_Fint *status, MPI_Fint *__ierr);
+void mpi_waitsome (MPI_Fint *incount, MPI_Fint array_of_requests[], MPI_Fint *outcount,
+		   MPI_Fint array_of_indices[], MPI_Fint array_of_statuses[][MPI_STATUS_SIZE],
+		   MPI_Fint *__ierr);
+void mpi_testall (MPI_Fint *count, MPI_Fint array_of_requests[], MPI_Fint *flag,
+		  MPI_Fint array_of_statuses[][MPI_STATUS_SIZE], MPI_Fint *__ierr);
+void mpi_testany (MPI_Fint *count, MPI_Fint array_of_requests[], MPI_Fint *indx,
+		  MPI_Fint *flag, MPI_Fint *status, MPI_Fint *__ierr);
+void mpi_testsome (MPI_Fint *incount, MPI_Fint array_of_requests[], MPI_Fint *outcount,
+		   MPI_Fint array_of_indices[], MPI_Fint array_of_statuses[][MPI_STATUS_SIZE],
+		   MPI_Fint *__ierr);
+void mpi_reduce_scatter (void *sendbuf, void *recvbuf, MPI_Fint *recvcounts,
+			 MPI_Fint *datatype, MPI_Fint *op, MPI_Fint *comm,
+			 MPI_Fint *__ierr);
+void mpi_reduce_scatter_block (void *sendbuf, void *recvbuf, MPI_Fint *recvcount,
+			       MPI_Fint *datatype, MPI_Fint *op, MPI_Fint *comm,
+			       MPI_Fint *__ierr);
+void mpi_scan (void *sendbuf, void *recvbuf, MPI_Fint *count, MPI_Fint *datatype,
+	       MPI_Fint *op, MPI_Fint *comm, MPI_Fint *__ierr);
+void mpi_exscan (void *sendbuf, void *recvbuf, MPI_Fint *count, MPI_Fint *datatype,
+		 MPI_Fint *op, MPI_Fint *comm, MPI_Fint *__ierr);
+void mpi_ibarrier (MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_ibcast (void *buffer, MPI_Fint *count, MPI_Fint *datatype, MPI_Fint *root,
+		 MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_iallreduce (void *sendbuf, void *recvbuf, MPI_Fint *count, MPI_Fint *datatype,
+		     MPI_Fint *op, MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_ireduce (void *sendbuf, void *recvbuf, MPI_Fint *count, MPI_Fint *datatype,
+		  MPI_Fint *op, MPI_Fint *root, MPI_Fint *comm, MPI_Fint *request,
+		  MPI_Fint *__ierr);
+void mpi_igather (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype, void *recvbuf,
+		  MPI_Fint *recvcount, MPI_Fint *recvtype, MPI_Fint *root,
+		  MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_igatherv (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		   void *recvbuf, MPI_Fint *recvcounts, MPI_Fint *displs,
+		   MPI_Fint *recvtype, MPI_Fint *root, MPI_Fint *comm,
+		   MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_iscatter (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		   void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+		   MPI_Fint *root, MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_iscatterv (void *sendbuf, MPI_Fint *sendcounts, MPI_Fint *displs,
+		    MPI_Fint *sendtype, void *recvbuf, MPI_Fint *recvcount,
+		    MPI_Fint *recvtype, MPI_Fint *root, MPI_Fint *comm,
+		    MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_iallgather (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		     void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+		     MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_iallgatherv (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		      void *recvbuf, MPI_Fint *recvcounts, MPI_Fint *displs,
+		      MPI_Fint *recvtype, MPI_Fint *comm, MPI_Fint *request,
+		      MPI_Fint *__ierr);
+void mpi_ialltoall (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		    void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+		    MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_ialltoallv (void *sendbuf, MPI_Fint *sendcounts, MPI_Fint *sdispls,
+		     MPI_Fint *sendtype, void *recvbuf, MPI_Fint *recvcounts,
+		     MPI_Fint *rdispls, MPI_Fint *recvtype, MPI_Fint *comm,
+		     MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_neighbor_allgather (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+			     void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+			     MPI_Fint *comm, MPI_Fint *__ierr);
+void mpi_neighbor_alltoall (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+			    void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+			    MPI_Fint *comm, MPI_Fint *__ierr);
+void mpi_neighbor_alltoallv (void *sendbuf, MPI_Fint *sendcounts, MPI_Fint *sdispls,
+			     MPI_Fint *sendtype, void *recvbuf, MPI_Fint *recvcounts,
+			     MPI_Fint *rdispls, MPI_Fint *recvtype, MPI_Fint *comm,
+			     MPI_Fint *__ierr);
+void mpi_put (void *origin_addr, MPI_Fint *origin_count, MPI_Fint *origin_datatype,
+	      MPI_Fint *target_rank, MPI_Aint *target_disp, MPI_Fint *target_count,
+	      MPI_Fint *target_datatype, MPI_Fint *win, MPI_Fint *__ierr);
+void mpi_get (void *origin_addr, MPI_Fint *origin_count, MPI_Fint *origin_datatype,
+	      MPI_Fint *target_rank, MPI_Aint *target_disp, MPI_Fint *target_count,
+	      MPI_Fint *target_datatype, MPI_Fint *win, MPI_Fint *__ierr);
+void mpi_accumulate (void *origin_addr, MPI_Fint *origin_count,
+		     MPI_Fint *origin_datatype, MPI_Fint *target_rank,
+		     MPI_Aint *target_disp, MPI_Fint *target_count,
+		     MPI_Fint *target_datatype, MPI_Fint *op, MPI_Fint *win,
+		     MPI_Fint *__ierr);
+void mpi_win_fence (MPI_Fint *assert, MPI_Fint *win, MPI_Fint *__ierr);
+void mpi_win_lock (MPI_Fint *lock_type, MPI_Fint *rank, MPI_Fint *assert, MPI_Fint *win,
+		   MPI_Fint *__ierr);
+void mpi_win_unlock (MPI_Fint *rank, MPI_Fint *win, MPI_Fint *__ierr);
+void mpi_win_flush (MPI_Fint *rank, MPI_Fint *win, MPI_Fint *__ierr);
+void mpi_win_post (MPI_Fint *group, MPI_Fint *assert, MPI_Fint *win, MPI_Fint *__ierr);
+void mpi_win_start (MPI_Fint *group, MPI_Fint *assert, MPI_Fint *win, MPI_Fint *__ierr);
+void mpi_win_complete (MPI_Fint *win, MPI_Fint *__ierr);
+void mpi_win_wait (MPI_Fint *win, MPI_Fint *__ierr);
+#ifdef MPI_FILE_NULL
+void mpi_file_open (MPI_Fint *comm, char *filename, MPI_Fint *amode, MPI_Fint *info,
+		    MPI_Fint *fh, MPI_Fint *__ierr, int filename_len);
+void mpi_file_set_view (MPI_Fint *fh, MPI_Offset *disp, MPI_Fint *etype, MPI_Fint *filetype,
+			char *datarep, MPI_Fint *info, MPI_Fint *__ierr, int datarep_len);
+void mpi_file_close (MPI_Fint *fh, MPI_Fint *__ierr);
+void mpi_file_sync (MPI_Fint *fh, MPI_Fint *__ierr);
+void mpi_file_read (MPI_Fint *fh, void *buf, MPI_Fint *count, MPI_Fint *datatype,
+		    MPI_Fint *status, MPI_Fint *__ierr);
+void mpi_file_write (MPI_Fint *fh, void *buf, MPI_Fint *count, MPI_Fint *datatype,
+		     MPI_Fint *status, MPI_Fint *__ierr);
+void mpi_file_read_at (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+		       MPI_Fint *datatype, MPI_Fint *status, MPI_Fint *__ierr);
+void mpi_file_write_at (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+			MPI_Fint *datatype, MPI_Fint *status, MPI_Fint *__ierr);
+void mpi_file_read_all (MPI_Fint *fh, void *buf, MPI_Fint *count, MPI_Fint *datatype,
+			MPI_Fint *status, MPI_Fint *__ierr);
+void mpi_file_write_all (MPI_Fint *fh, void *buf, MPI_Fint *count, MPI_Fint *datatype,
+			 MPI_Fint *status, MPI_Fint *__ierr);
+void mpi_file_read_at_all (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+			   MPI_Fint *datatype, MPI_Fint *status, MPI_Fint *__ierr);
+void mpi_file_write_at_all (MPI_Fint *fh, MPI_Offset *offset, void *buf,
+			    MPI_Fint *count, MPI_Fint *datatype, MPI_Fint *status,
+			    MPI_Fint *__ierr);
+void mpi_file_iread_at (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+			MPI_Fint *datatype, MPI_Fint *request, MPI_Fint *__ierr);
+void mpi_file_iwrite_at (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+			 MPI_Fint *datatype, MPI_Fint *request, MPI_Fint *__ierr);
+#endif
 
 /*
 ** These routines were adapted from the FPMPI distribution. They ensure profiling of 
@@ -360,7 +582,6 @@ void mpi_waitall (MPI_Fint *count, MPI_Fint array_of_requests[],
                   MPI_Fint array_of_statuses[][MPI_STATUS_SIZE], 
                   MPI_Fint *__ierr)
 {
-  const int LOCAL_ARRAY_SIZE = 128;
   int i;
   MPI_Request lrequest[LOCAL_ARRAY_SIZE];
   MPI_Status c_status[LOCAL_ARRAY_SIZE];
@@ -559,5 +780,573 @@ void mpi_test (MPI_Fint *request, MPI_Fint *flag, MPI_Fint *status,
     MPI_Status_c2f (&c_status, status);
   }
 }
+
+/*
+** The routines below which complete arrays of requests share the LOCAL_ARRAY_SIZE
+** limit of mpi_waitall, and call check_requests to enforce it.
+*/
+static void check_requests (int count, const char *thisfunc)
+{
+  if (count > LOCAL_ARRAY_SIZE) {
+    fprintf (stderr, "%s: %d is too many requests: recompile f_wrappers_pmpi.c "
+	     "with LOCAL_ARRAY_SIZE > %d\n", thisfunc, count, LOCAL_ARRAY_SIZE);
+    fprintf (stderr, "Aborting...\n");
+    (void) MPI_Abort (MPI_COMM_WORLD, -1);
+  }
+}
+
+void mpi_waitany (MPI_Fint *count, MPI_Fint array_of_requests[], MPI_Fint *indx,
+		  MPI_Fint *status, MPI_Fint *__ierr)
+{
+  int i;
+  int lindx;
+  MPI_Request lrequest[LOCAL_ARRAY_SIZE];
+  MPI_Status c_status;
+
+  check_requests ((int) *count, "mpi_waitany");
+  for (i = 0; i < (int) *count; i++)
+    lrequest[i] = MPI_Request_f2c (array_of_requests[i]);
+
+  *__ierr = MPI_Waitany ((int) *count, lrequest, &lindx, &c_status);
+  if (lindx != MPI_UNDEFINED) {
+    array_of_requests[lindx] = MPI_Request_c2f (lrequest[lindx]);
+    lindx++;    /* Fortran indices are 1-based */
+  }
+  *indx = (MPI_Fint) lindx;
+  MPI_Status_c2f (&c_status, status);
+}
+
+void mpi_waitsome (MPI_Fint *incount, MPI_Fint array_of_requests[], MPI_Fint *outcount,
+		   MPI_Fint array_of_indices[], MPI_Fint array_of_statuses[][MPI_STATUS_SIZE],
+		   MPI_Fint *__ierr)
+{
+  int i, j;
+  int loutcount;
+  int lindices[LOCAL_ARRAY_SIZE];
+  MPI_Request lrequest[LOCAL_ARRAY_SIZE];
+  MPI_Status c_status[LOCAL_ARRAY_SIZE];
+
+  check_requests ((int) *incount, "mpi_waitsome");
+  for (i = 0; i < (int) *incount; i++)
+    lrequest[i] = MPI_Request_f2c (array_of_requests[i]);
+
+  *__ierr = MPI_Waitsome ((int) *incount, lrequest, &loutcount, lindices, c_status);
+  if (loutcount != MPI_UNDEFINED) {
+    for (i = 0; i < loutcount; i++) {
+      j = lindices[i];
+      array_of_requests[j] = MPI_Request_c2f (lrequest[j]);
+      array_of_indices[i] = (MPI_Fint) (j + 1);
+      MPI_Status_c2f (&c_status[i], &(array_of_statuses[i][0]));
+    }
+  }
+  *outcount = (MPI_Fint) loutcount;
+}
+
+void mpi_testall (MPI_Fint *count, MPI_Fint array_of_requests[], MPI_Fint *flag,
+		  MPI_Fint array_of_statuses[][MPI_STATUS_SIZE], MPI_Fint *__ierr)
+{
+  int i;
+  int l_flag;
+  MPI_Request lrequest[LOCAL_ARRAY_SIZE];
+  MPI_Status c_status[LOCAL_ARRAY_SIZE];
+
+  check_requests ((int) *count, "mpi_testall");
+  for (i = 0; i < (int) *count; i++)
+    lrequest[i] = MPI_Request_f2c (array_of_requests[i]);
+
+  *__ierr = MPI_Testall ((int) *count, lrequest, &l_flag, c_status);
+  *flag = (MPI_Fint) l_flag;
+  if (l_flag) {
+    for (i = 0; i < (int) *count; i++) {
+      array_of_requests[i] = MPI_Request_c2f (lrequest[i]);
+      MPI_Status_c2f (&c_status[i], &(array_of_statuses[i][0]));
+    }
+  }
+}
+
+void mpi_testany (MPI_Fint *count, MPI_Fint array_of_requests[], MPI_Fint *indx,
+		  MPI_Fint *flag, MPI_Fint *status, MPI_Fint *__ierr)
+{
+  int i;
+  int lindx;
+  int l_flag;
+  MPI_Request lrequest[LOCAL_ARRAY_SIZE];
+  MPI_Status c_status;
+
+  check_requests ((int) *count, "mpi_testany");
+  for (i = 0; i < (int) *count; i++)
+    lrequest[i] = MPI_Request_f2c (array_of_requests[i]);
+
+  *__ierr = MPI_Testany ((int) *count, lrequest, &lindx, &l_flag, &c_status);
+  if (l_flag && lindx != MPI_UNDEFINED) {
+    array_of_requests[lindx] = MPI_Request_c2f (lrequest[lindx]);
+    lindx++;    /* Fortran indices are 1-based */
+  }
+  *indx = (MPI_Fint) lindx;
+  *flag = (MPI_Fint) l_flag;
+  if (l_flag)
+    MPI_Status_c2f (&c_status, status);
+}
+
+void mpi_testsome (MPI_Fint *incount, MPI_Fint array_of_requests[], MPI_Fint *outcount,
+		   MPI_Fint array_of_indices[], MPI_Fint array_of_statuses[][MPI_STATUS_SIZE],
+		   MPI_Fint *__ierr)
+{
+  int i, j;
+  int loutcount;
+  int lindices[LOCAL_ARRAY_SIZE];
+  MPI_Request lrequest[LOCAL_ARRAY_SIZE];
+  MPI_Status c_status[LOCAL_ARRAY_SIZE];
+
+  check_requests ((int) *incount, "mpi_testsome");
+  for (i = 0; i < (int) *incount; i++)
+    lrequest[i] = MPI_Request_f2c (array_of_requests[i]);
+
+  *__ierr = MPI_Testsome ((int) *incount, lrequest, &loutcount, lindices, c_status);
+  if (loutcount != MPI_UNDEFINED) {
+    for (i = 0; i < loutcount; i++) {
+      j = lindices[i];
+      array_of_requests[j] = MPI_Request_c2f (lrequest[j]);
+      array_of_indices[i] = (MPI_Fint) (j + 1);
+      MPI_Status_c2f (&c_status[i], &(array_of_statuses[i][0]));
+    }
+  }
+  *outcount = (MPI_Fint) loutcount;
+}
+
+void mpi_reduce_scatter (void *sendbuf, void *recvbuf, MPI_Fint *recvcounts,
+			 MPI_Fint *datatype, MPI_Fint *op, MPI_Fint *comm,
+			 MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Reduce_scatter (sendbuf, recvbuf, recvcounts, MPI_Type_f2c (*datatype),
+				MPI_Op_f2c (*op), MPI_Comm_f2c (*comm));
+}
+
+void mpi_reduce_scatter_block (void *sendbuf, void *recvbuf, MPI_Fint *recvcount,
+			       MPI_Fint *datatype, MPI_Fint *op, MPI_Fint *comm,
+			       MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Reduce_scatter_block (sendbuf, recvbuf, *recvcount,
+				      MPI_Type_f2c (*datatype), MPI_Op_f2c (*op),
+				      MPI_Comm_f2c (*comm));
+}
+
+void mpi_scan (void *sendbuf, void *recvbuf, MPI_Fint *count, MPI_Fint *datatype,
+	       MPI_Fint *op, MPI_Fint *comm, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Scan (sendbuf, recvbuf, *count, MPI_Type_f2c (*datatype),
+		      MPI_Op_f2c (*op), MPI_Comm_f2c (*comm));
+}
+
+void mpi_exscan (void *sendbuf, void *recvbuf, MPI_Fint *count, MPI_Fint *datatype,
+		 MPI_Fint *op, MPI_Fint *comm, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Exscan (sendbuf, recvbuf, *count, MPI_Type_f2c (*datatype),
+			MPI_Op_f2c (*op), MPI_Comm_f2c (*comm));
+}
+
+void mpi_ibarrier (MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Ibarrier (MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_ibcast (void *buffer, MPI_Fint *count, MPI_Fint *datatype, MPI_Fint *root,
+		 MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Ibcast (buffer, *count, MPI_Type_f2c (*datatype), *root,
+			MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_iallreduce (void *sendbuf, void *recvbuf, MPI_Fint *count, MPI_Fint *datatype,
+		     MPI_Fint *op, MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Iallreduce (sendbuf, recvbuf, *count, MPI_Type_f2c (*datatype),
+			    MPI_Op_f2c (*op), MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_ireduce (void *sendbuf, void *recvbuf, MPI_Fint *count, MPI_Fint *datatype,
+		  MPI_Fint *op, MPI_Fint *root, MPI_Fint *comm, MPI_Fint *request,
+		  MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Ireduce (sendbuf, recvbuf, *count, MPI_Type_f2c (*datatype),
+			 MPI_Op_f2c (*op), *root, MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_igather (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype, void *recvbuf,
+		  MPI_Fint *recvcount, MPI_Fint *recvtype, MPI_Fint *root,
+		  MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Igather (sendbuf, *sendcount, MPI_Type_f2c (*sendtype), recvbuf,
+			 *recvcount, MPI_Type_f2c (*recvtype), *root,
+			 MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_igatherv (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		   void *recvbuf, MPI_Fint *recvcounts, MPI_Fint *displs,
+		   MPI_Fint *recvtype, MPI_Fint *root, MPI_Fint *comm,
+		   MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Igatherv (sendbuf, *sendcount, MPI_Type_f2c (*sendtype), recvbuf,
+			  recvcounts, displs, MPI_Type_f2c (*recvtype), *root,
+			  MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_iscatter (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		   void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+		   MPI_Fint *root, MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Iscatter (sendbuf, *sendcount, MPI_Type_f2c (*sendtype), recvbuf,
+			  *recvcount, MPI_Type_f2c (*recvtype), *root,
+			  MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_iscatterv (void *sendbuf, MPI_Fint *sendcounts, MPI_Fint *displs,
+		    MPI_Fint *sendtype, void *recvbuf, MPI_Fint *recvcount,
+		    MPI_Fint *recvtype, MPI_Fint *root, MPI_Fint *comm,
+		    MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Iscatterv (sendbuf, sendcounts, displs, MPI_Type_f2c (*sendtype),
+			   recvbuf, *recvcount, MPI_Type_f2c (*recvtype), *root,
+			   MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_iallgather (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		     void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+		     MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Iallgather (sendbuf, *sendcount, MPI_Type_f2c (*sendtype), recvbuf,
+			    *recvcount, MPI_Type_f2c (*recvtype), MPI_Comm_f2c (*comm),
+			    &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_iallgatherv (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		      void *recvbuf, MPI_Fint *recvcounts, MPI_Fint *displs,
+		      MPI_Fint *recvtype, MPI_Fint *comm, MPI_Fint *request,
+		      MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Iallgatherv (sendbuf, *sendcount, MPI_Type_f2c (*sendtype), recvbuf,
+			     recvcounts, displs, MPI_Type_f2c (*recvtype),
+			     MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_ialltoall (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+		    void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+		    MPI_Fint *comm, MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Ialltoall (sendbuf, *sendcount, MPI_Type_f2c (*sendtype), recvbuf,
+			   *recvcount, MPI_Type_f2c (*recvtype), MPI_Comm_f2c (*comm),
+			   &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_ialltoallv (void *sendbuf, MPI_Fint *sendcounts, MPI_Fint *sdispls,
+		     MPI_Fint *sendtype, void *recvbuf, MPI_Fint *recvcounts,
+		     MPI_Fint *rdispls, MPI_Fint *recvtype, MPI_Fint *comm,
+		     MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_Ialltoallv (sendbuf, sendcounts, sdispls, MPI_Type_f2c (*sendtype),
+			    recvbuf, recvcounts, rdispls, MPI_Type_f2c (*recvtype),
+			    MPI_Comm_f2c (*comm), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_neighbor_allgather (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+			     void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+			     MPI_Fint *comm, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Neighbor_allgather (sendbuf, *sendcount, MPI_Type_f2c (*sendtype),
+				    recvbuf, *recvcount, MPI_Type_f2c (*recvtype),
+				    MPI_Comm_f2c (*comm));
+}
+
+void mpi_neighbor_alltoall (void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+			    void *recvbuf, MPI_Fint *recvcount, MPI_Fint *recvtype,
+			    MPI_Fint *comm, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Neighbor_alltoall (sendbuf, *sendcount, MPI_Type_f2c (*sendtype),
+				   recvbuf, *recvcount, MPI_Type_f2c (*recvtype),
+				   MPI_Comm_f2c (*comm));
+}
+
+void mpi_neighbor_alltoallv (void *sendbuf, MPI_Fint *sendcounts, MPI_Fint *sdispls,
+			     MPI_Fint *sendtype, void *recvbuf, MPI_Fint *recvcounts,
+			     MPI_Fint *rdispls, MPI_Fint *recvtype, MPI_Fint *comm,
+			     MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Neighbor_alltoallv (sendbuf, sendcounts, sdispls,
+				    MPI_Type_f2c (*sendtype), recvbuf, recvcounts,
+				    rdispls, MPI_Type_f2c (*recvtype),
+				    MPI_Comm_f2c (*comm));
+}
+
+void mpi_put (void *origin_addr, MPI_Fint *origin_count, MPI_Fint *origin_datatype,
+	      MPI_Fint *target_rank, MPI_Aint *target_disp, MPI_Fint *target_count,
+	      MPI_Fint *target_datatype, MPI_Fint *win, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Put (origin_addr, *origin_count, MPI_Type_f2c (*origin_datatype),
+		     *target_rank, *target_disp, *target_count,
+		     MPI_Type_f2c (*target_datatype), MPI_Win_f2c (*win));
+}
+
+void mpi_get (void *origin_addr, MPI_Fint *origin_count, MPI_Fint *origin_datatype,
+	      MPI_Fint *target_rank, MPI_Aint *target_disp, MPI_Fint *target_count,
+	      MPI_Fint *target_datatype, MPI_Fint *win, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Get (origin_addr, *origin_count, MPI_Type_f2c (*origin_datatype),
+		     *target_rank, *target_disp, *target_count,
+		     MPI_Type_f2c (*target_datatype), MPI_Win_f2c (*win));
+}
+
+void mpi_accumulate (void *origin_addr, MPI_Fint *origin_count,
+		     MPI_Fint *origin_datatype, MPI_Fint *target_rank,
+		     MPI_Aint *target_disp, MPI_Fint *target_count,
+		     MPI_Fint *target_datatype, MPI_Fint *op, MPI_Fint *win,
+		     MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Accumulate (origin_addr, *origin_count, MPI_Type_f2c (*origin_datatype),
+			    *target_rank, *target_disp, *target_count,
+			    MPI_Type_f2c (*target_datatype), MPI_Op_f2c (*op),
+			    MPI_Win_f2c (*win));
+}
+
+void mpi_win_fence (MPI_Fint *assert, MPI_Fint *win, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Win_fence (*assert, MPI_Win_f2c (*win));
+}
+
+void mpi_win_lock (MPI_Fint *lock_type, MPI_Fint *rank, MPI_Fint *assert, MPI_Fint *win,
+		   MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Win_lock (*lock_type, *rank, *assert, MPI_Win_f2c (*win));
+}
+
+void mpi_win_unlock (MPI_Fint *rank, MPI_Fint *win, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Win_unlock (*rank, MPI_Win_f2c (*win));
+}
+
+void mpi_win_flush (MPI_Fint *rank, MPI_Fint *win, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Win_flush (*rank, MPI_Win_f2c (*win));
+}
+
+void mpi_win_post (MPI_Fint *group, MPI_Fint *assert, MPI_Fint *win, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Win_post (MPI_Group_f2c (*group), *assert, MPI_Win_f2c (*win));
+}
+
+void mpi_win_start (MPI_Fint *group, MPI_Fint *assert, MPI_Fint *win, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Win_start (MPI_Group_f2c (*group), *assert, MPI_Win_f2c (*win));
+}
+
+void mpi_win_complete (MPI_Fint *win, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Win_complete (MPI_Win_f2c (*win));
+}
+
+void mpi_win_wait (MPI_Fint *win, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_Win_wait (MPI_Win_f2c (*win));
+}
+
+#ifdef MPI_FILE_NULL
+/*
+** Fortran strings are blank padded and passed with a hidden length argument.
+** Return a NUL-terminated copy with trailing blanks trimmed, to be freed by the caller.
+*/
+static char *fstring (const char *str, int len)
+{
+  char *cstr;
+
+  while (len > 0 && str[len-1] == ' ')
+    len--;
+  if ((cstr = (char *) malloc (len + 1))) {
+    memcpy (cstr, str, len);
+    cstr[len] = '\0';
+  }
+  return cstr;
+}
+
+void mpi_file_open (MPI_Fint *comm, char *filename, MPI_Fint *amode, MPI_Fint *info,
+		    MPI_Fint *fh, MPI_Fint *__ierr, int filename_len)
+{
+  char *cname;
+  MPI_File lfh;
+
+  if ( ! (cname = fstring (filename, filename_len))) {
+    fprintf (stderr, "Out of space in MPI_FILE_OPEN");
+    *__ierr = -1;
+    return;
+  }
+  *__ierr = MPI_File_open (MPI_Comm_f2c (*comm), cname, (int) *amode, MPI_Info_f2c (*info),
+			   &lfh);
+  *fh = MPI_File_c2f (lfh);
+  free (cname);
+}
+
+void mpi_file_set_view (MPI_Fint *fh, MPI_Offset *disp, MPI_Fint *etype, MPI_Fint *filetype,
+			char *datarep, MPI_Fint *info, MPI_Fint *__ierr, int datarep_len)
+{
+  char *crep;
+
+  if ( ! (crep = fstring (datarep, datarep_len))) {
+    fprintf (stderr, "Out of space in MPI_FILE_SET_VIEW");
+    *__ierr = -1;
+    return;
+  }
+  *__ierr = MPI_File_set_view (MPI_File_f2c (*fh), *disp, MPI_Type_f2c (*etype),
+			       MPI_Type_f2c (*filetype), crep, MPI_Info_f2c (*info));
+  free (crep);
+}
+
+void mpi_file_close (MPI_Fint *fh, MPI_Fint *__ierr)
+{
+  MPI_File lfh = MPI_File_f2c (*fh);
+
+  *__ierr = MPI_File_close (&lfh);
+  *fh = MPI_File_c2f (lfh);
+}
+
+void mpi_file_sync (MPI_Fint *fh, MPI_Fint *__ierr)
+{
+  *__ierr = MPI_File_sync (MPI_File_f2c (*fh));
+}
+
+void mpi_file_read (MPI_Fint *fh, void *buf, MPI_Fint *count, MPI_Fint *datatype,
+		    MPI_Fint *status, MPI_Fint *__ierr)
+{
+  MPI_Status s;
+
+  *__ierr = MPI_File_read (MPI_File_f2c (*fh), buf, *count, MPI_Type_f2c (*datatype),
+			   &s);
+  MPI_Status_c2f (&s, status);
+}
+
+void mpi_file_write (MPI_Fint *fh, void *buf, MPI_Fint *count, MPI_Fint *datatype,
+		     MPI_Fint *status, MPI_Fint *__ierr)
+{
+  MPI_Status s;
+
+  *__ierr = MPI_File_write (MPI_File_f2c (*fh), buf, *count, MPI_Type_f2c (*datatype),
+			    &s);
+  MPI_Status_c2f (&s, status);
+}
+
+void mpi_file_read_at (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+		       MPI_Fint *datatype, MPI_Fint *status, MPI_Fint *__ierr)
+{
+  MPI_Status s;
+
+  *__ierr = MPI_File_read_at (MPI_File_f2c (*fh), *offset, buf, *count,
+			      MPI_Type_f2c (*datatype), &s);
+  MPI_Status_c2f (&s, status);
+}
+
+void mpi_file_write_at (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+			MPI_Fint *datatype, MPI_Fint *status, MPI_Fint *__ierr)
+{
+  MPI_Status s;
+
+  *__ierr = MPI_File_write_at (MPI_File_f2c (*fh), *offset, buf, *count,
+			       MPI_Type_f2c (*datatype), &s);
+  MPI_Status_c2f (&s, status);
+}
+
+void mpi_file_read_all (MPI_Fint *fh, void *buf, MPI_Fint *count, MPI_Fint *datatype,
+			MPI_Fint *status, MPI_Fint *__ierr)
+{
+  MPI_Status s;
+
+  *__ierr = MPI_File_read_all (MPI_File_f2c (*fh), buf, *count,
+			       MPI_Type_f2c (*datatype), &s);
+  MPI_Status_c2f (&s, status);
+}
+
+void mpi_file_write_all (MPI_Fint *fh, void *buf, MPI_Fint *count, MPI_Fint *datatype,
+			 MPI_Fint *status, MPI_Fint *__ierr)
+{
+  MPI_Status s;
+
+  *__ierr = MPI_File_write_all (MPI_File_f2c (*fh), buf, *count,
+				MPI_Type_f2c (*datatype), &s);
+  MPI_Status_c2f (&s, status);
+}
+
+void mpi_file_read_at_all (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+			   MPI_Fint *datatype, MPI_Fint *status, MPI_Fint *__ierr)
+{
+  MPI_Status s;
+
+  *__ierr = MPI_File_read_at_all (MPI_File_f2c (*fh), *offset, buf, *count,
+				  MPI_Type_f2c (*datatype), &s);
+  MPI_Status_c2f (&s, status);
+}
+
+void mpi_file_write_at_all (MPI_Fint *fh, MPI_Offset *offset, void *buf,
+			    MPI_Fint *count, MPI_Fint *datatype, MPI_Fint *status,
+			    MPI_Fint *__ierr)
+{
+  MPI_Status s;
+
+  *__ierr = MPI_File_write_at_all (MPI_File_f2c (*fh), *offset, buf, *count,
+				   MPI_Type_f2c (*datatype), &s);
+  MPI_Status_c2f (&s, status);
+}
+
+void mpi_file_iread_at (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+			MPI_Fint *datatype, MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_File_iread_at (MPI_File_f2c (*fh), *offset, buf, *count,
+			       MPI_Type_f2c (*datatype), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+
+void mpi_file_iwrite_at (MPI_Fint *fh, MPI_Offset *offset, void *buf, MPI_Fint *count,
+			 MPI_Fint *datatype, MPI_Fint *request, MPI_Fint *__ierr)
+{
+  MPI_Request lrequest;
+
+  *__ierr = MPI_File_iwrite_at (MPI_File_f2c (*fh), *offset, buf, *count,
+				MPI_Type_f2c (*datatype), &lrequest);
+  *request = MPI_Request_c2f (lrequest);
+}
+#endif
 #endif   /* ENABLE_PMPI */
 #endif   /* HAVE_LIBMPI */
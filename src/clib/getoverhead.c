@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "private.h"
+#include "gptl.h"
 
 static int gptlstart_sim (char *, int);
 static Timer *getentry_instr_sim (const Hashentry *,void *, unsigned int *, const int);
@@ -19,18 +20,21 @@ static bool disabled = false;
 ** they should just have zeros in them. If PAPI is not enabled, input counter info is ignored.
 ** 
 ** Input args:
-**   fp:            File descriptor to write to
+**   fp:            File descriptor to write to (NULL means estimate silently)
 **   ptr2wtimefunc: Underlying timing routine
 **   getentry:      From gptl.c, finds the entry in the hash table
 **   genhashidx:    From gptl.c, generates the hash index
 **   get_thread_num:From gptl.c, gets the thread number
-**   hashtable:     hashtable for thread 0
+**   hashtable:     hashtable for thread t
 **   tablesize:     size of hashtable
 **   dousepapi:     whether or not PAPI is enabled
+**   imperfect_nest:whether imperfect nesting was detected
+**   t:             thread whose hashtable and call stack are used for calibration
 **
 ** Output args:
 **   self_ohd:      Estimate of GPTL-induced overhead in the timer itself (included in "Wallclock")
 **   parent_ohd:    Estimate of GPTL-induced overhead for the timer which appears in its parents
+**   comp:          If not NULL, per-call cost of each component, indexed by Ohdcomp (gptl.h)
 */
 int GPTLget_overhead (FILE *fp,
 		      double (*ptr2wtimefunc)(void), 
@@ -43,8 +47,10 @@ int GPTLget_overhead (FILE *fp,
 		      const int tablesize,
 		      bool dousepapi,
 		      int imperfect_nest,
+		      const int t,
 		      double *self_ohd,
-		      double *parent_ohd)
+		      double *parent_ohd,
+		      double *comp)
 {
   double t1, t2;             /* Initial, final timer values */
   double ftn_ohd;            /* Fortran-callable layer */
@@ -106,13 +112,15 @@ int GPTLget_overhead (FILE *fp,
       for (i = 0; i < 1000; ++i)
 	entry = getentry (hashtable, hashtable[n].entries[0]->name, hashidx);
       t2 = (*ptr2wtimefunc)();
-      fprintf (fp, "%s: using hash entry %d=%s for getentry estimate\n", 
-	       thisfunc, n, hashtable[n].entries[0]->name);
+      if (fp)
+	fprintf (fp, "%s: using hash entry %d=%s for getentry estimate\n", 
+		 thisfunc, n, hashtable[n].entries[0]->name);
       break;
     }
   }
   if (n == tablesize) {
-    fprintf (fp, "%s: hash table empty: Using alternate means to find getentry time\n", thisfunc);
+    if (fp)
+      fprintf (fp, "%s: hash table empty: Using alternate means to find getentry time\n", thisfunc);
     t1 = (*ptr2wtimefunc)();
     for (i = 0; i < 1000; ++i)
       entry = getentry (hashtable, "timername", hashidx);
@@ -154,13 +162,14 @@ int GPTLget_overhead (FILE *fp,
 
   /* misc start/stop overhead */
   if (imperfect_nest) {
-    fprintf (fp, "Imperfect nesting detected: setting misc_ohd=0\n");
+    if (fp)
+      fprintf (fp, "Imperfect nesting detected: setting misc_ohd=0\n");
     misc_ohd = 0.;
   } else {
     t1 = (*ptr2wtimefunc)();
 #pragma unroll(10)
     for (i = 0; i < 1000; ++i) {
-      misc_sim (stackidx, callstack, 0);
+      misc_sim (stackidx, callstack, t);
     }
     t2 = (*ptr2wtimefunc)();
     misc_ohd = 0.001 * (t2 - t1);
@@ -168,6 +177,22 @@ int GPTLget_overhead (FILE *fp,
 
   total_ohd = ftn_ohd + get_thread_num_ohd + genhashidx_ohd + getentry_ohd + 
               utr_ohd + misc_ohd + papi_ohd;
+  *self_ohd   = ftn_ohd + utr_ohd; /* In GPTLstop() ftn wrapper is called before utr */
+  *parent_ohd = ftn_ohd + utr_ohd + misc_ohd +
+                2.*(get_thread_num_ohd + genhashidx_ohd + getentry_ohd + papi_ohd);
+  if (comp) {
+    comp[GPTLohd_fortran]        = ftn_ohd;
+    comp[GPTLohd_thread]         = get_thread_num_ohd;
+    comp[GPTLohd_genhashidx]     = genhashidx_ohd;
+    comp[GPTLohd_getentry]       = getentry_ohd;
+    comp[GPTLohd_utr]            = utr_ohd;
+    comp[GPTLohd_misc]           = misc_ohd;
+    comp[GPTLohd_papi]           = papi_ohd;
+    comp[GPTLohd_getentry_instr] = getentry_instr_ohd;
+  }
+  if ( ! fp)
+    return 0;
+
   fprintf (fp, "Total overhead of 1 GPTL start or GPTLstop call=%g seconds\n", total_ohd);
   fprintf (fp, "Components are as follows:\n");
   fprintf (fp, "Fortran layer:             %7.1e = %5.1f%% of total\n", 
@@ -195,9 +220,6 @@ int GPTLget_overhead (FILE *fp,
 	  "      the hashtable entry is %7.1e not the %7.1e portion taken by GPTLstart\n", 
 	  getentry_instr_ohd, genhashidx_ohd + getentry_ohd);
   fprintf (fp, "NOTE: Each hash collision roughly doubles the 'Find hashtable entry' cost of that timer\n");
-  *self_ohd   = ftn_ohd + utr_ohd; /* In GPTLstop() ftn wrapper is called before utr */
-  *parent_ohd = ftn_ohd + utr_ohd + misc_ohd +
-                2.*(get_thread_num_ohd + genhashidx_ohd + getentry_ohd + papi_ohd);
   return 0;
 }
 
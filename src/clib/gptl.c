@@ -18,6 +18,7 @@
 #include <ctype.h>         /* isdigit */
 #include <sys/types.h>     /* u_int8_t, u_int16_t */
 #include <assert.h>
+#include <math.h>          /* HUGE_VAL */
 
 #ifdef HAVE_PAPI
 #include <papi.h>          /* PAPI_get_real_usec */
@@ -35,6 +36,14 @@
 #include <execinfo.h>
 #endif
 
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>       /* snapshot thread */
+#include <signal.h>        /* sigaction */
+#include <errno.h>
+#include <fcntl.h>         /* O_NONBLOCK */
+#include <time.h>          /* ctime */
+#endif
+
 #include "private.h"
 #include "gptl.h"
 
@@ -70,6 +79,9 @@ static bool dopr_threadsort = true;    /* whether to print sorted thread stats *
 static bool dopr_multparent = true;    /* whether to print multiple parent info */
 static bool dopr_collision = true;     /* whether to print hash collision info */
 static bool dopr_memusage = false;     /* whether to include memusage print when auto-profiling */
+static bool subtract_ohd = false;      /* subtract estimated GPTL overhead from reported times */
+static bool signal_dump = false;       /* SIGUSR1 writes a snapshot of all timers */
+static int watchdog_ms = 0;            /* watchdog scan period in milliseconds (0 = none) */
 
 static time_t ref_gettimeofday = -1;   /* ref start point for gettimeofday */
 static time_t ref_clock_gettime = -1;  /* ref start point for clock_gettime */
@@ -113,26 +125,45 @@ typedef struct {
 /* Options, print strings, and default enable flags */
 static Settings cpustats =      {GPTLcpu,      "Usr       sys       usr+sys   ", false};
 static Settings wallstats =     {GPTLwall,     "Wallclock max       min       ", true };
-static Settings overheadstats = {GPTLoverhead, "self_OH  parent_OH "           , true };
+static Settings overheadstats = {GPTLoverhead, "self_OH  parent_OH  OH_frac   " , true };
+static Settings exclstats =     {GPTLexclusive,"Exclusive "                    , true };
+static Settings rssstats =      {GPTLrss_delta,"RSS_delta max_delta "          , false};
 
 static Hashentry **hashtable;    /* table of entries */
 static long ticks_per_sec;       /* clock ticks per second */
 static Timer ***callstack;       /* call stack */
 static Nofalse *stackidx;        /* index into callstack: */
+static double *ohd_self;         /* per-thread calibrated self overhead (< 0 means not yet) */
+static double *ohd_parent;       /* per-thread calibrated parent overhead */
+static volatile int ohd_ref = -1;  /* thread whose estimates stand in for uncalibrated threads */
+#ifdef ENABLE_PMPI
+static Pmpithread *pmpithread;   /* per-thread timer slots and datatype sizes of pmpi.c */
+#endif
 
 static Method method = GPTLfull_tree;  /* default parent/child printing mechanism */
 
 /* Local function prototypes */
-static void print_titles (int, FILE *fp);
+static void print_titles (int, int, FILE *fp);
 static void printstats (const Timer *, FILE *, int, int, bool, double, double);
 static void add (Timer *, const Timer *);
 static void print_multparentinfo (FILE *, Timer *);
 static inline int get_cpustamp (long *, long *);
 static int newchild (Timer *, Timer *);
 static int get_max_depth (const Timer *, const int);
+static inline Timer *getentry_samename (const int, const Timer *);
+static void print_hotspots (FILE *);
+static void print_threads (FILE *, float *);
+static void print_thread (FILE *, const int, float *);
+static void get_ohd_est (const int, double *, double *);
+static void calibrate_ohd (const int);
+static inline void adjust_wallstats (const Timer *, const double, const double, double *, double *);
 static int is_descendant (const Timer *, const Timer *);
 static int is_onlist (const Timer *, const Timer *);
 static char *methodstr (Method);
+static int snapshot_init (void);
+static void snapshot_finalize (void);
+static int watchdog_init (void);
+static void watchdog_finalize (void);
 
 /* Prototypes from previously separate file threadutil.c */
 static int threadinit (void);                    /* initialize threading environment */
@@ -202,6 +233,7 @@ static int tablesizem1 = DEFAULT_TABLE_SIZE - 1;
 
 #define MSGSIZ 256                          /* max size of msg printed when dopr_memusage=true */
 static int rssmax = 0;                      /* max rss of the process */
+static bool rss_warned = false;             /* warned that RSS could not be read */
 static bool imperfect_nest;                 /* e.g. start(A),start(B),stop(A) */
 
 /* VERBOSE is a debugging ifdef local to the rest of this file */
@@ -251,6 +283,65 @@ int GPTLsetoption (const int option,  /* option */
     if (verbose)
       printf ("%s: boolean overheadstats = %d\n", thisfunc, val);
     return 0;
+  case GPTLexclusive: 
+    exclstats.enabled = (bool) val; 
+    if (verbose)
+      printf ("%s: boolean exclstats = %d\n", thisfunc, val);
+    return 0;
+  case GPTLrss_delta: 
+    rssstats.enabled = (bool) val; 
+    if (verbose)
+      printf ("%s: boolean rssstats = %d\n", thisfunc, val);
+    return 0;
+  case GPTLsubtract_ohd: 
+    subtract_ohd = (bool) val; 
+    if (verbose)
+      printf ("%s: boolean subtract_ohd = %d\n", thisfunc, val);
+    return 0;
+  case GPTLhotspots:
+  case GPTLohdwarn:
+    if (GPTLhotspots_setoption (option, val) != 0)
+      return GPTLerror ("%s: GPTLhotspots_setoption failure\n", thisfunc);
+    if (verbose)
+      printf ("%s: option %d = %d\n", thisfunc, option, val);
+    return 0;
+  case GPTLimbalance:
+    if (GPTLimbalance_setoption (option, val) != 0)
+      return GPTLerror ("%s: GPTLimbalance_setoption failure\n", thisfunc);
+    if (verbose)
+      printf ("%s: number of imbalanced regions listed = %d\n", thisfunc, val);
+    return 0;
+  case GPTLdump_summary:
+    (void) GPTLdump_setoption (option, val);
+    if (verbose)
+      printf ("%s: boolean dump_summary = %d\n", thisfunc, val);
+    return 0;
+  case GPTLsignal_dump:
+#ifndef HAVE_LIBPTHREAD
+    if (val)
+      return GPTLerror ("%s: signal_dump needs pthreads\n", thisfunc);
+#endif
+    signal_dump = (bool) val;
+    if (verbose)
+      printf ("%s: boolean signal_dump = %d\n", thisfunc, val);
+    return 0;
+  case GPTLwatchdog:
+    if (val < 0)
+      return GPTLerror ("%s: watchdog period must be >= 0. %d is invalid\n", thisfunc, val);
+#ifndef HAVE_LIBPTHREAD
+    if (val > 0)
+      return GPTLerror ("%s: watchdog needs pthreads\n", thisfunc);
+#endif
+    watchdog_ms = val;
+    if (verbose)
+      printf ("%s: watchdog period = %d ms\n", thisfunc, val);
+    return 0;
+  case GPTLlive_stats:
+    if (GPTLlive_setoption (option, val) != 0)
+      return GPTLerror ("%s: GPTLlive_setoption failure\n", thisfunc);
+    if (verbose)
+      printf ("%s: boolean live_stats = %d\n", thisfunc, val);
+    return 0;
   case GPTLdepthlimit: 
     depthlimit = val; 
     if (verbose)
@@ -309,12 +400,18 @@ int GPTLsetoption (const int option,  /* option */
       printf ("%s: tablesize = %d\n", thisfunc, tablesize);
     return 0;
   case GPTLsync_mpi:
+  case GPTLshared_output:
+  case GPTLcomm_stats:
+  case GPTLpeer_stats:
+  case GPTLreq_stats:
+  case GPTLlate_stats:
+  case GPTLclock_sync:
 #ifdef ENABLE_PMPI
     if (GPTLpmpi_setoption (option, val) != 0)
       fprintf (stderr, "%s: GPTLpmpi_setoption failure\n", thisfunc);
 #endif
     if (verbose)
-      printf ("%s: boolean sync_mpi = %d\n", thisfunc, val);
+      printf ("%s: option %d = %d\n", thisfunc, option, val);
     return 0;
 
   case GPTLmaxthreads:
@@ -413,11 +510,22 @@ int GPTLinitialize (void)
   max_depth     = (int *)        GPTLallocate (maxthreads * sizeof (int), thisfunc);
   max_name_len  = (int *)        GPTLallocate (maxthreads * sizeof (int), thisfunc);
   hashtable     = (Hashentry **) GPTLallocate (maxthreads * sizeof (Hashentry *), thisfunc);
+  ohd_self      = (double *)     GPTLallocate (maxthreads * sizeof (double), thisfunc);
+  ohd_parent    = (double *)     GPTLallocate (maxthreads * sizeof (double), thisfunc);
+#ifdef ENABLE_PMPI
+  pmpithread    = (Pmpithread *) GPTLallocate (maxthreads * sizeof (Pmpithread), thisfunc);
+  memset (pmpithread, 0, maxthreads * sizeof (Pmpithread));
+#endif
 
   /* Initialize array values */
   for (t = 0; t < maxthreads; t++) {
     max_depth[t]    = -1;
     max_name_len[t] = 0;
+    ohd_self[t]     = -1.;
+    ohd_parent[t]   = -1.;
+#ifdef ENABLE_PMPI
+    pmpithread[t].t = t;
+#endif
     callstack[t] = (Timer **) GPTLallocate (MAX_STACK * sizeof (Timer *), thisfunc);
     hashtable[t] = (Hashentry *) GPTLallocate (tablesize * sizeof (Hashentry), thisfunc);
     for (i = 0; i < tablesize; i++) {
@@ -451,6 +559,7 @@ int GPTLinitialize (void)
   }
 
   ptr2wtimefunc = funclist[funcidx].func;
+  (void) GPTLlive_init (maxthreads, funclist[funcidx].name);
 
   if (verbose) {
     t1 = (*ptr2wtimefunc) ();
@@ -464,6 +573,12 @@ int GPTLinitialize (void)
 
   imperfect_nest = false;
   initialized = true;
+
+  /* After initialized is set, since the snapshot thread may print right away */
+  if (signal_dump && snapshot_init () != 0)
+    GPTLwarn ("%s: cannot start the snapshot thread. SIGUSR1 will not write snapshots\n", thisfunc);
+  if (watchdog_ms > 0 && watchdog_init () != 0)
+    GPTLwarn ("%s: cannot start the watchdog thread\n", thisfunc);
   return 0;
 }
 
@@ -483,6 +598,10 @@ int GPTLfinalize (void)
   if ( ! initialized)
     return GPTLerror ("%s: initialization was not completed\n", thisfunc);
 
+  /* Before the timers are freed */
+  snapshot_finalize ();
+  watchdog_finalize ();
+
   for (t = 0; t < maxthreads; ++t) {
     for (n = 0; n < tablesize; ++n) {
       if (hashtable[t][n].nument > 0)
@@ -499,6 +618,9 @@ int GPTLfinalize (void)
       }
       if (ptr->nchildren > 0)
         free (ptr->children);
+#ifdef ENABLE_PMPI
+      free (ptr->msghist);
+#endif
       free (ptr);
     }
   }
@@ -510,7 +632,21 @@ int GPTLfinalize (void)
   free (max_depth);
   free (max_name_len);
   free (hashtable);
+  free (ohd_self);
+  free (ohd_parent);
+  ohd_ref = -1;
+#ifdef ENABLE_PMPI
+  for (t = 0; t < maxthreads; ++t) {
+    free (pmpithread[t].comm);
+    free (pmpithread[t].peer);
+    free (pmpithread[t].req);
+    free (pmpithread[t].reqstats);
+    free (pmpithread[t].reqkey);
+  }
+  free (pmpithread);
+#endif
 
+  GPTLlive_finalize ();
   threadfinalize ();
   GPTLreset_errors ();
 
@@ -540,6 +676,10 @@ int GPTLfinalize (void)
   dopr_threadsort = true;
   dopr_multparent = true;
   dopr_collision = true;
+  subtract_ohd = false;
+  signal_dump = false;
+  watchdog_ms = 0;
+  rss_warned = false;
   ref_gettimeofday = -1;
   ref_clock_gettime = -1;
 #ifdef _AIX
@@ -581,6 +721,10 @@ int GPTLstart_instr (void *self)
   if ((t = get_thread_num ()) < 0)
     return GPTLerror ("%s: bad return from get_thread_num\n", thisfunc);
 
+  /* First start on this thread: calibrate its overhead on its own call stack */
+  if (subtract_ohd && ohd_self[t] < 0.)
+    calibrate_ohd (t);
+
   /* If current depth exceeds a user-specified limit for print, just increment and return */
   if (stackidx[t].val >= depthlimit) {
     ++stackidx[t].val;
@@ -655,6 +799,10 @@ int GPTLstart (const char *name)               /* timer name */
   if ((t = get_thread_num ()) < 0)
     return GPTLerror ("%s: bad return from get_thread_num\n", thisfunc);
 
+  /* First start on this thread: calibrate its overhead on its own call stack */
+  if (subtract_ohd && ohd_self[t] < 0.)
+    calibrate_ohd (t);
+
   /*
   ** If current depth exceeds a user-specified limit for print, just
   ** increment and return
@@ -753,6 +901,10 @@ int GPTLstart_handle (const char *name,  /* timer name */
   if ((t = get_thread_num ()) < 0)
     return GPTLerror ("%s: bad return from get_thread_num\n", thisfunc);
 
+  /* First start on this thread: calibrate its overhead on its own call stack */
+  if (subtract_ohd && ohd_self[t] < 0.)
+    calibrate_ohd (t);
+
   /* If current depth exceeds a user-specified limit for print, just increment and return */
   if (stackidx[t].val >= depthlimit) {
     ++stackidx[t].val;
@@ -848,6 +1000,7 @@ static int update_ll_hash (Timer *ptr, int t, unsigned int indx)
   hashtable[t][indx].entries           = eptr;
   hashtable[t][indx].entries[nument-1] = ptr;
 
+  ptr->live = GPTLlive_add (t, ptr->name);
   return 0;
 }
 
@@ -866,13 +1019,19 @@ static inline int update_ptr (Timer *ptr, const int t)
 
   ptr->onflg = true;
 
+  if (rssstats.enabled)
+    ptr->rss.last = GPTLget_rss ();   /* < 0 if the read failed */
+
   if (cpustats.enabled && get_cpustamp (&ptr->cpu.last_utime, &ptr->cpu.last_stime) < 0)
     return GPTLerror ("update_ptr: get_cpustamp error");
   
   if (wallstats.enabled) {
     tp2 = (*ptr2wtimefunc) ();
     ptr->wall.last = tp2;
+    ptr->wall.ndesc_start = ptr->wall.ndesc;
   }
+  if (ptr->live)
+    GPTLlive_start (ptr);
 
 #ifdef HAVE_PAPI
   if (dousepapi && GPTL_PAPIstart (t, &ptr->aux) < 0)
@@ -1157,9 +1316,195 @@ int GPTLstop_handle (const char *name,     /* timer name */
   return 0;
 }
 
+#ifdef ENABLE_PMPI
+/*
+** GPTLstart_slot: Start the timer of a routine wrapped in pmpi.c. The timer is looked up
+**   by name only on the thread's first call of the routine, then kept in the thread's
+**   slot so later calls cost a clock read and no hashing.
+**
+** Input arguments:
+**   name: timer name
+**   slot: slot of the routine, < NSLOT
+**
+** Return value: per-thread state to pass to GPTLstop_slot, or NULL if the timer was
+**   not started (disabled or failure)
+*/
+Pmpithread *GPTLstart_slot (const char *name, const int slot)
+{
+  Timer *ptr;        /* linked list pointer */
+  int t;             /* thread index (of this thread) */
+  int numchars;      /* number of characters to copy */
+  unsigned int indx; /* hash table index */
+  static const char *thisfunc = "GPTLstart_slot";
+
+  if (disabled)
+    return NULL;
+
+  if ( ! initialized) {
+    GPTLerror ("%s name=%s: GPTLinitialize has not been called\n", thisfunc, name);
+    return NULL;
+  }
+
+  if ((t = get_thread_num ()) < 0) {
+    GPTLerror ("%s: bad return from get_thread_num\n", thisfunc);
+    return NULL;
+  }
+
+  /* First start on this thread: calibrate its overhead on its own call stack */
+  if (subtract_ohd && ohd_self[t] < 0.)
+    calibrate_ohd (t);
+
+  /* Same depth limit handling as GPTLstart: GPTLstop_slot will decrement */
+  if (stackidx[t].val >= depthlimit) {
+    ++stackidx[t].val;
+    return &pmpithread[t];
+  }
+
+  if ( ! (ptr = pmpithread[t].slot[slot])) {
+    indx = genhashidx (name);
+    ptr = getentry (hashtable[t], name, indx);
+    /* Before the recursion check: GPTLstop_slot finds the timer only through the slot */
+    pmpithread[t].slot[slot] = ptr;
+  }
+
+  if (ptr && ptr->onflg) {
+    ++ptr->recurselvl;
+    return &pmpithread[t];
+  }
+
+  if (++stackidx[t].val > MAX_STACK-1) {
+    GPTLerror ("%s: stack too big\n", thisfunc);
+    return NULL;
+  }
+
+  if ( ! ptr) { /* Add a new entry and initialize */
+    ptr = (Timer *) GPTLallocate (sizeof (Timer), thisfunc);
+    memset (ptr, 0, sizeof (Timer));
+
+    numchars = MIN (strlen (name), MAX_CHARS);
+    strncpy (ptr->name, name, numchars);
+    ptr->name[numchars] = '\0';
+
+    if (update_ll_hash (ptr, t, indx) != 0) {
+      GPTLerror ("%s: update_ll_hash error\n", thisfunc);
+      return NULL;
+    }
+    pmpithread[t].slot[slot] = ptr;
+  }
+
+  if (update_parent_info (ptr, callstack[t], stackidx[t].val) != 0) {
+    GPTLerror ("%s: update_parent_info error\n", thisfunc);
+    return NULL;
+  }
+
+  if (update_ptr (ptr, t) != 0) {
+    GPTLerror ("%s: update_ptr error\n", thisfunc);
+    return NULL;
+  }
+
+  return &pmpithread[t];
+}
+
+/*
+** GPTLstop_slot: Stop the timer started by GPTLstart_slot. The thread index comes from
+**   pt, so unlike GPTLstop there is no thread lookup either.
+**
+** Input arguments:
+**   pt:   return value of GPTLstart_slot
+**   slot: slot of the routine
+**
+** Return value: the routine's timer, for the caller to add byte counts to, or NULL
+**   if it was not started or on failure
+*/
+Timer *GPTLstop_slot (Pmpithread *pt, const int slot)
+{
+  double tp1 = 0.0;          /* time stamp */
+  Timer *ptr;                /* linked list pointer */
+  int t;                     /* thread number for this process */
+  long usr = 0;              /* user time (returned from get_cpustamp) */
+  long sys = 0;              /* system time (returned from get_cpustamp) */
+  static const char *thisfunc = "GPTLstop_slot";
+
+  if (disabled || ! pt)
+    return NULL;
+
+  /* Get the timestamp */
+  if (wallstats.enabled) {
+    tp1 = (*ptr2wtimefunc) ();
+  }
+
+  if (cpustats.enabled && get_cpustamp (&usr, &sys) < 0) {
+    GPTLerror ("%s: get_cpustamp error", thisfunc);
+    return NULL;
+  }
+
+  t = pt->t;
+
+  /* If current depth exceeds a user-specified limit for print, just decrement and return */
+  if (stackidx[t].val > depthlimit) {
+    --stackidx[t].val;
+    return NULL;
+  }
+
+  if ( ! (ptr = pt->slot[slot]) || ! ptr->onflg) {
+    GPTLerror ("%s: timer in slot %d was not on.\n", thisfunc, slot);
+    return NULL;
+  }
+
+  ++ptr->count;
+
+  /* Recursion => decrement depth in recursion and leave the timer running */
+  if (ptr->recurselvl > 0) {
+    ++ptr->nrecurse;
+    --ptr->recurselvl;
+    return ptr;
+  }
+
+  if (update_stats (ptr, tp1, usr, sys, t) != 0) {
+    GPTLerror ("%s: error from update_stats\n", thisfunc);
+    return NULL;
+  }
+
+  return ptr;
+}
+#endif
+
+/*
+** GPTLtime_origin: Origin of the underlying wallclock timer in seconds since the Unix
+**   epoch. Timers which count from a reference taken at initialization return times
+**   relative to it, so adding it makes timestamps of different processes comparable
+**   (to within the clock skew between nodes).
+**
+** Return value: origin, or 0 if the timer has no known relation to the epoch
+*/
+double GPTLtime_origin (void)
+{
+  switch (funclist[funcidx].option) {
+  case GPTLgettimeofday:
+    return (double) ref_gettimeofday;
+  case GPTLclockgettime:
+    return (double) ref_clock_gettime;
+#ifdef _AIX
+  case GPTLread_real_time:
+    return (double) ref_read_real_time;
+#endif
+  default:
+    return 0.;
+  }
+}
+
+/*
+** GPTLtime_now: Current wallclock timestamp from the underlying timer, as GPTLstamp
+**   returns it but without the cost of also reading user and system time
+*/
+double GPTLtime_now (void)
+{
+  return (*ptr2wtimefunc) ();
+}
+
 /*
 ** update_stats: update stats inside ptr. Called by GPTLstop, GPTLstop_instr, 
-**               GPTLstop_handle
+**               GPTLstop_handle, GPTLstop_slot
 **
 ** Input arguments:
 **   ptr: pointer to timer
@@ -1177,6 +1522,8 @@ static inline int update_stats (Timer *ptr,
                                 const int t)
 {
   double delta;      /* difference */
+  double rss;        /* process RSS at stop (MB) */
+  double rssdelta;   /* RSS change (MB) */
   int bidx;          /* bottom of call stack */
   Timer *bptr;       /* pointer to last entry in call stack */
   static const char *thisfunc = "update_stats";
@@ -1191,6 +1538,8 @@ static inline int update_stats (Timer *ptr,
   if (wallstats.enabled) {
     delta = tp1 - ptr->wall.last;
     ptr->wall.accum += delta;
+    ptr->wall.excl  += delta;
+    ptr->wall.sumsq += delta * delta;
     ptr->wall.latest = delta;
 
     if (delta < 0.)
@@ -1214,6 +1563,23 @@ static inline int update_stats (Timer *ptr,
     ptr->cpu.last_stime   = sys;
   }
 
+  if (rssstats.enabled) {
+    if ((rss = GPTLget_rss ()) < 0. || ptr->rss.last < 0.) {
+      if ( ! rss_warned) {
+	rss_warned = true;
+	GPTLwarn ("%s: cannot read RSS: RSS_delta misses some calls\n", thisfunc);
+      }
+    } else {
+      rssdelta = rss - ptr->rss.last;
+      ptr->rss.accum += rssdelta;
+      if (ptr->rss.count++ == 0 || rssdelta > ptr->rss.max)
+	ptr->rss.max = rssdelta;
+    }
+  }
+
+  if (ptr->live)
+    GPTLlive_stop (ptr);
+
   /* Verify that the timer being stopped is at the bottom of the call stack */
   bidx = stackidx[t].val;
   bptr = callstack[t][bidx];
@@ -1221,6 +1587,14 @@ static inline int update_stats (Timer *ptr,
     imperfect_nest = true;
     GPTLwarn ("%s: Got timer=%s expected btm of call stack=%s\n",
 	      thisfunc, ptr->name, bptr->name);
+  } else if (wallstats.enabled && bidx > 0) {
+    /* Time spent in this timer is not exclusive time of its caller */
+    bptr = callstack[t][bidx-1];
+    bptr->wall.excl -= ptr->wall.latest;
+
+    /* Count start/stop pairs nested in the caller, for overhead subtraction */
+    ++bptr->wall.nchild;
+    bptr->wall.ndesc += 1 + ptr->wall.ndesc - ptr->wall.ndesc_start;
   }
 
   --stackidx[t].val;           /* Pop the callstack */
@@ -1305,10 +1679,32 @@ int GPTLreset (void)
       ptr->count = 0;
       memset (&ptr->wall, 0, sizeof (ptr->wall));
       memset (&ptr->cpu, 0, sizeof (ptr->cpu));
+      memset (&ptr->rss, 0, sizeof (ptr->rss));
 #ifdef HAVE_PAPI
       memset (&ptr->aux, 0, sizeof (ptr->aux));
 #endif
+#ifdef ENABLE_PMPI
+      ptr->nbytes = 0.;
+      if (ptr->msghist)
+	memset (ptr->msghist, 0, sizeof (Msghist));
+#endif
+      if (ptr->live)
+	GPTLlive_stop (ptr);
     }
+#ifdef ENABLE_PMPI
+    if (pmpithread[t].comm)
+      memset (pmpithread[t].comm, 0, (COMM_MAX+1) * sizeof (Commstats));
+    if (pmpithread[t].peer)
+      memset (pmpithread[t].peer, 0, (PEER_MAX+1) * sizeof (Peerstats));
+    pmpithread[t].npeer = 0;
+    /* Requests posted before the reset are no longer tracked */
+    if (pmpithread[t].req)
+      memset (pmpithread[t].req, 0, REQ_MAX * sizeof (Reqinfo));
+    if (pmpithread[t].reqstats)
+      memset (pmpithread[t].reqstats, 0, sizeof (Reqstats));
+    pmpithread[t].nreq = 0;
+    pmpithread[t].untracked = 0;
+#endif
   }
 
   if (verbose)
@@ -1343,9 +1739,12 @@ int GPTLreset_timer (char *name)
       ptr->count = 0;
       memset (&ptr->wall, 0, sizeof (ptr->wall));
       memset (&ptr->cpu, 0, sizeof (ptr->cpu));
+      memset (&ptr->rss, 0, sizeof (ptr->rss));
 #ifdef HAVE_PAPI
       memset (&ptr->aux, 0, sizeof (ptr->aux));
 #endif
+      if (ptr->live)
+	GPTLlive_stop (ptr);
     }
   }
   return 0;
@@ -1376,38 +1775,478 @@ int GPTLpr (const int id)   /* output file will be named "timing.<id>" */
 }
 
 /* 
-** GPTLpr_file: Print values of all timers
+** GPTLpr_file: Print values of all timers
+**
+** Input arguments:
+**   outfile: Name of output file to write
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+int GPTLpr_file (const char *outfile) /* output file to write */
+{
+  FILE *fp;                 /* file handle to write to */
+  Outbuf ob;                /* buffered output state for fp */
+  int ret;
+
+  static const char *thisfunc = "GPTLpr_file";
+
+  if ( ! initialized)
+    return GPTLerror ("%s: GPTLinitialize() has not been called\n", thisfunc);
+
+  if ( ! (fp = GPTLoutbuf_open (&ob, outfile)))
+    fp = stderr;
+
+  ret = GPTLprint_report (fp);
+
+  if (fp != stderr && GPTLoutbuf_close (&ob) != 0)
+    fprintf (stderr, "%s: Attempt to close %s failed\n", thisfunc, outfile);
+
+  return ret;
+}
+
+#ifdef HAVE_LIBPTHREAD
+/*
+** helper_create: Start a GPTL helper thread. It blocks all signals, so none meant for the
+**   application is delivered to it.
+**
+** Return value: 0 (success) or the error number from pthread_create
+*/
+static int helper_create (pthread_t *tid, void *(*func) (void *))
+{
+  sigset_t all, old;
+  int ret;
+
+  sigfillset (&all);
+  pthread_sigmask (SIG_SETMASK, &all, &old);
+  ret = pthread_create (tid, NULL, func, NULL);
+  pthread_sigmask (SIG_SETMASK, &old, NULL);
+  return ret;
+}
+
+/*
+** On-demand snapshots (GPTLsignal_dump): SIGUSR1 wakes a helper thread which appends
+** the stats of all timers to timing.snapshot.<pid>. A stalled process makes no more
+** GPTLstart/GPTLstop calls, so the snapshot cannot wait for one of those.
+*/
+static volatile sig_atomic_t snapshot_requested = 0;  /* set by the SIGUSR1 handler */
+static int snapshot_pipe[2] = {-1, -1};               /* the handler writes, the thread reads */
+static pthread_t snapshot_tid;                        /* helper thread */
+static struct sigaction snapshot_oldact;              /* SIGUSR1 disposition to restore */
+static bool snapshot_running = false;
+
+/*
+** write_snapshot: Append the stats of all timers to timing.snapshot.<pid>. The threads
+**   are not stopped, so stats of a timer being updated may be slightly inconsistent.
+**   Stats are of completed start/stop pairs, followed by the regions each thread is in
+**   now, outermost first, with the time since they were started.
+*/
+static void write_snapshot (void)
+{
+  FILE *fp;
+  char outfile[32];         /* timing.snapshot.<pid> */
+  time_t epoch;             /* for the time of day of the snapshot */
+  double now;               /* timestamp of the snapshot */
+  Timer copy;               /* timer with onflg cleared, so printstats prints it */
+  Timer *ptr;
+  double self_ohd;          /* estimated library overhead in self timer */
+  double parent_ohd;        /* estimated library overhead due to self in parent timer */
+  int depth;                /* of the thread's callstack */
+  int t, d;
+
+  sprintf (outfile, "timing.snapshot.%d", (int) getpid ());
+  if ( ! (fp = fopen (outfile, "a")))
+    return;
+
+  epoch = time (NULL);
+  now = (*ptr2wtimefunc) ();
+  fprintf (fp, "GPTL snapshot of pid %d at %s", (int) getpid (), ctime (&epoch));
+
+  for (t = 0; t < nthreads; ++t) {
+    if ( ! timers[t]->next)
+      continue;
+
+    print_titles (t, -1, fp);
+    get_ohd_est (t, &self_ohd, &parent_ohd);
+    for (ptr = timers[t]->next; ptr; ptr = ptr->next) {
+      copy = *ptr;
+      copy.onflg = false;
+      printstats (&copy, fp, t, 0, false, self_ohd, parent_ohd);
+    }
+
+    /* Read the depth once: the thread may push or pop meanwhile */
+    if ((depth = MIN (stackidx[t].val, MAX_STACK-1)) > 0) {
+      fprintf (fp, "Regions on, outermost first, with seconds since started:\n");
+      for (d = 1; d <= depth; ++d)
+	if ((ptr = callstack[t][d]))
+	  fprintf (fp, "%*s%-*s %9.3f\n", 2*d, "", max_name_len[t] + 2*(depth-d), ptr->name,
+		   wallstats.enabled ? now - ptr->wall.last : 0.);
+    }
+  }
+  fprintf (fp, "\n");
+  fclose (fp);
+}
+
+/* SIGUSR1 handler: only flag the request, and wake the thread with an async-signal-safe write */
+static void snapshot_handler (int sig)
+{
+  int saved_errno = errno;
+  ssize_t ignore;
+
+  snapshot_requested = 1;
+  ignore = write (snapshot_pipe[1], "", 1);
+  (void) ignore;
+  errno = saved_errno;
+}
+
+/* Body of the helper thread: write a snapshot per request until the pipe is closed */
+static void *snapshot_loop (void *arg)
+{
+  char c;
+  ssize_t n;
+
+  while ((n = read (snapshot_pipe[0], &c, 1)) != 0) {
+    if (n < 0 && errno != EINTR)
+      break;
+    if (snapshot_requested) {
+      snapshot_requested = 0;
+      write_snapshot ();
+    }
+  }
+  return NULL;
+}
+#endif
+
+/*
+** snapshot_init: Start the snapshot thread and install the SIGUSR1 handler
+**
+** Return value: 0 (success) or -1 (failure)
+*/
+static int snapshot_init (void)
+{
+#ifdef HAVE_LIBPTHREAD
+  struct sigaction act;
+
+  if (pipe (snapshot_pipe) != 0)
+    return -1;
+  /* Many signals at once must not block the handler on a full pipe */
+  (void) fcntl (snapshot_pipe[1], F_SETFL, O_NONBLOCK);
+
+  if (helper_create (&snapshot_tid, snapshot_loop) != 0) {
+    close (snapshot_pipe[0]);
+    close (snapshot_pipe[1]);
+    return -1;
+  }
+
+  memset (&act, 0, sizeof (act));
+  act.sa_handler = snapshot_handler;
+  sigemptyset (&act.sa_mask);
+  act.sa_flags = SA_RESTART;
+  snapshot_running = true;
+  if (sigaction (SIGUSR1, &act, &snapshot_oldact) != 0) {
+    snapshot_finalize ();
+    return -1;
+  }
+  return 0;
+#else
+  return -1;
+#endif
+}
+
+/*
+** snapshot_finalize: Restore SIGUSR1 and stop the snapshot thread, if running
+*/
+static void snapshot_finalize (void)
+{
+#ifdef HAVE_LIBPTHREAD
+  if ( ! snapshot_running)
+    return;
+
+  (void) sigaction (SIGUSR1, &snapshot_oldact, NULL);
+  close (snapshot_pipe[1]);   /* the thread sees end of file */
+  (void) pthread_join (snapshot_tid, NULL);
+  close (snapshot_pipe[0]);
+  snapshot_requested = 0;
+  snapshot_running = false;
+#endif
+}
+
+/*
+** Hang and straggler watchdog (GPTLwatchdog): a helper thread scans the callstack of each
+** thread once per period and reports on stderr the innermost region which has been on
+** far longer than expected: longer than registered with GPTLwatchdog_expect, or else
+** longer than the mean plus WATCHDOG_NSIGMA standard deviations of its completed calls
+** (and than one period). Each start of a region is reported at most once.
+*/
+#define WATCHDOG_NSIGMA 10.
+#define WATCHDOG_MINCALLS 10      /* completed calls before the mean and sigma are trusted */
+
+typedef struct {
+  char name[MAX_CHARS+1];         /* region name */
+  double maxsec;                  /* expected maximum duration */
+} Expect;
+
+static Expect *expect = NULL;     /* regions registered with GPTLwatchdog_expect */
+static int nexpect = 0;
+
+#ifdef HAVE_LIBPTHREAD
+static pthread_mutex_t watchdog_mutex = PTHREAD_MUTEX_INITIALIZER;  /* guards expect, watchdog_stop */
+static pthread_cond_t watchdog_cond = PTHREAD_COND_INITIALIZER;     /* wakes the thread to stop */
+static pthread_t watchdog_tid;
+static bool watchdog_stop = false;
+static bool watchdog_running = false;
+static double *watchdog_reported = NULL; /* per thread and depth: start stamp last reported */
+static const char *watchdog_rank = NULL; /* MPI rank from the launcher's environment, if any */
+
+/*
+** watchdog_limit: Expected maximum duration of a region
+**
+** Input arguments:
+**   ptr: timer of the region
+**
+** Output arguments:
+**   how: how the limit was found
+**
+** Return value: limit in seconds, or -1 if none is known yet
+*/
+static double watchdog_limit (const Timer *ptr, const char **how)
+{
+  double limit = -1.;
+  double mean, var;
+  unsigned long count = ptr->count;
+  int n;
+
+  pthread_mutex_lock (&watchdog_mutex);
+  for (n = 0; n < nexpect; ++n)
+    if (STRMATCH (expect[n].name, ptr->name)) {
+      limit = expect[n].maxsec;
+      *how = "registered";
+      break;
+    }
+  pthread_mutex_unlock (&watchdog_mutex);
+
+  if (limit < 0. && count >= WATCHDOG_MINCALLS) {
+    mean = ptr->wall.accum / count;
+    var = MAX (ptr->wall.sumsq / count - mean * mean, 0.);
+    limit = MAX (mean + WATCHDOG_NSIGMA * sqrt (var), 1.e-3 * watchdog_ms);
+    *how = "mean + 10 sigma of completed calls";
+  }
+  return limit;
+}
+
+/*
+** watchdog_scan: Report the innermost region of each thread which is overdue, unless
+**   this start of it was already reported, with the call stack of the thread
+*/
+static void watchdog_scan (void)
+{
+  double now;                   /* timestamp of the scan */
+  double limit;                 /* expected maximum duration */
+  double *reported;             /* start stamps reported for this thread */
+  bool late[MAX_STACK];         /* region at each depth is overdue */
+  const char *how = "";
+  const char *latehow = "";
+  double latelimit = 0.;
+  Timer *ptr;
+  int depth;                    /* of the thread's callstack */
+  int innermost;                /* depth of the innermost overdue region not yet reported */
+  int t, d;
+
+  now = (*ptr2wtimefunc) ();
+  for (t = 0; t < nthreads; ++t) {
+    /* Read the depth once: the thread may push or pop meanwhile */
+    depth = MIN (stackidx[t].val, MAX_STACK-1);
+    reported = &watchdog_reported[t*MAX_STACK];
+    innermost = 0;
+    for (d = 1; d <= depth; ++d) {
+      late[d] = false;
+      if ( ! (ptr = callstack[t][d]) || (limit = watchdog_limit (ptr, &how)) < 0.)
+	continue;
+      late[d] = now - ptr->wall.last > limit;
+      if (late[d] && reported[d] != ptr->wall.last) {
+	innermost = d;
+	latehow = how;
+	latelimit = limit;
+      }
+    }
+    if (innermost == 0)
+      continue;
+
+    ptr = callstack[t][innermost];
+    fprintf (stderr, "GPTL watchdog: %s%s%spid %d thread %d: region %s on for %.3f seconds, "
+	     "expected at most %.3g (%s)\n  call stack:", 
+	     watchdog_rank ? "rank " : "", watchdog_rank ? watchdog_rank : "", 
+	     watchdog_rank ? " " : "", (int) getpid (), t, ptr->name, now - ptr->wall.last,
+	     latelimit, latehow);
+    for (d = 1; d <= depth; ++d)
+      if (callstack[t][d])
+	fprintf (stderr, "%s%s", (d > 1) ? " > " : " ", callstack[t][d]->name);
+    fprintf (stderr, "\n");
+    fflush (stderr);
+
+    /* Outer regions are overdue because of this one: do not report them on their own */
+    for (d = 1; d <= innermost; ++d)
+      if (late[d] && callstack[t][d])
+	reported[d] = callstack[t][d]->wall.last;
+  }
+}
+
+/* Body of the watchdog thread: scan once per period until told to stop */
+static void *watchdog_loop (void *arg)
+{
+  struct timeval tv;
+  struct timespec until;
+  long usec;
+
+  pthread_mutex_lock (&watchdog_mutex);
+  while ( ! watchdog_stop) {
+    gettimeofday (&tv, NULL);
+    usec = tv.tv_usec + 1000L * watchdog_ms;
+    until.tv_sec  = tv.tv_sec + usec / 1000000L;
+    until.tv_nsec = 1000L * (usec % 1000000L);
+    (void) pthread_cond_timedwait (&watchdog_cond, &watchdog_mutex, &until);
+    if (watchdog_stop)
+      break;
+    pthread_mutex_unlock (&watchdog_mutex);
+    watchdog_scan ();
+    pthread_mutex_lock (&watchdog_mutex);
+  }
+  pthread_mutex_unlock (&watchdog_mutex);
+  return NULL;
+}
+#endif
+
+/*
+** watchdog_init: Start the watchdog thread
+**
+** Return value: 0 (success) or -1 (failure)
+*/
+static int watchdog_init (void)
+{
+#ifdef HAVE_LIBPTHREAD
+  static const char *rankvars[] = {"OMPI_COMM_WORLD_RANK", "PMI_RANK", "PMIX_RANK",
+				   "MV2_COMM_WORLD_RANK", "SLURM_PROCID"};
+  int n;
+
+  /* MPI may not be initialized yet, and the thread must not call it: ask the launcher */
+  watchdog_rank = NULL;
+  for (n = 0; n < sizeof (rankvars) / sizeof (rankvars[0]) && ! watchdog_rank; ++n)
+    watchdog_rank = getenv (rankvars[n]);
+
+  if ( ! (watchdog_reported = (double *) calloc (maxthreads * MAX_STACK, sizeof (double))))
+    return -1;
+  watchdog_stop = false;
+  if (helper_create (&watchdog_tid, watchdog_loop) != 0) {
+    free (watchdog_reported);
+    watchdog_reported = NULL;
+    return -1;
+  }
+  watchdog_running = true;
+  return 0;
+#else
+  return -1;
+#endif
+}
+
+/*
+** watchdog_finalize: Stop the watchdog thread, if running, and forget registered regions
+*/
+static void watchdog_finalize (void)
+{
+#ifdef HAVE_LIBPTHREAD
+  if (watchdog_running) {
+    pthread_mutex_lock (&watchdog_mutex);
+    watchdog_stop = true;
+    pthread_cond_signal (&watchdog_cond);
+    pthread_mutex_unlock (&watchdog_mutex);
+    (void) pthread_join (watchdog_tid, NULL);
+    free (watchdog_reported);
+    watchdog_reported = NULL;
+    watchdog_running = false;
+  }
+#endif
+  free (expect);
+  expect = NULL;
+  nexpect = 0;
+}
+
+/*
+** GPTLwatchdog_expect: Register the expected maximum duration of a region for the
+**   watchdog (GPTLwatchdog), instead of deriving it from the region's completed calls.
+**   May be called before or after GPTLinitialize, and again to change the limit.
+**
+** Input arguments:
+**   name:   region name
+**   maxsec: expected maximum duration in seconds
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+int GPTLwatchdog_expect (const char *name, const double maxsec)
+{
+#ifdef HAVE_LIBPTHREAD
+  Expect *newexpect;
+  int n;
+  int ret = 0;
+  static const char *thisfunc = "GPTLwatchdog_expect";
+
+  if (maxsec < 0.)
+    return GPTLerror ("%s: maxsec=%g must be >= 0\n", thisfunc, maxsec);
+
+  pthread_mutex_lock (&watchdog_mutex);
+  for (n = 0; n < nexpect; ++n)
+    if (strncmp (expect[n].name, name, MAX_CHARS) == 0)
+      break;
+  if (n == nexpect) {
+    if ((newexpect = (Expect *) realloc (expect, (nexpect + 1) * sizeof (Expect)))) {
+      expect = newexpect;
+      strncpy (expect[n].name, name, MAX_CHARS);
+      expect[n].name[MAX_CHARS] = '\0';
+      ++nexpect;
+    } else {
+      ret = -1;
+    }
+  }
+  if (ret == 0)
+    expect[n].maxsec = maxsec;
+  pthread_mutex_unlock (&watchdog_mutex);
+
+  if (ret != 0)
+    return GPTLerror ("%s: realloc error\n", thisfunc);
+  return 0;
+#else
+  return GPTLerror ("GPTLwatchdog_expect: the watchdog needs pthreads\n");
+#endif
+}
+
+/* 
+** GPTLprint_report: Print values of all timers: the body of GPTLpr_file, also used to
+**   render each rank's section of a shared output file
 **
 ** Input arguments:
-**   outfile: Name of output file to write
+**   fp: stream to write to
 **
 ** Return value: 0 (success) or GPTLerror (failure)
 */
-int GPTLpr_file (const char *outfile) /* output file to write */
+int GPTLprint_report (FILE *fp)
 {
-  FILE *fp;                 /* file handle to write to */
   Timer *ptr;               /* walk through master thread linked list */
   Timer *tptr;              /* walk through slave threads linked lists */
   Timer sumstats;           /* sum of same timer stats over threads */
-  int n, t;                 /* indices */
-  unsigned long totcount;   /* total timer invocations */
+  int t;                    /* thread index */
   float *sum;               /* sum of overhead values (per thread) */
   float osum;               /* sum of overhead over threads */
-  bool found;               /* jump out of loop when name found */
   bool foundany;            /* whether summation print necessary */
   bool first;               /* flag 1st time entry found */
   double self_ohd;          /* estimated library overhead in self timer */
   double parent_ohd;        /* estimated library overhead due to self in parent timer */
+  double tself_ohd;         /* self_ohd for a thread other than 0 */
+  double tparent_ohd;       /* parent_ohd for a thread other than 0 */
   int size, rss, share, text, datastack; /* returned from GPTLget_memusage */
 
-  static const char *thisfunc = "GPTLpr_file";
+  static const char *thisfunc = "GPTLprint_report";
 
   if ( ! initialized)
     return GPTLerror ("%s: GPTLinitialize() has not been called\n", thisfunc);
 
-  if ( ! (fp = fopen (outfile, "w")))
-    fp = stderr;
-
   /* Print a warning if GPTLerror() was ever called */
   if (GPTLnum_errors () > 0) {
     fprintf (fp, "WARNING: GPTLerror was called at least once during the run.\n");
@@ -1488,21 +2327,35 @@ int GPTLpr_file (const char *outfile) /* output file to write */
   fprintf (fp, "Underlying timing routine was %s.\n", funclist[funcidx].name);
   (void) GPTLget_overhead (fp, ptr2wtimefunc, getentry, genhashidx, get_thread_num, 
 			   stackidx, callstack, hashtable[0], tablesize, dousepapi, imperfect_nest, 
-			   &self_ohd, &parent_ohd);
+			   0, &self_ohd, &parent_ohd, 0);
+  /* Keep earlier estimates: queries must not change after a print */
+  if (ohd_self[0] < 0.) {
+    ohd_parent[0] = parent_ohd;
+    ohd_self[0]   = self_ohd;
+    if (ohd_ref < 0)
+      ohd_ref = 0;
+  }
   if (dopr_preamble) {
     fprintf (fp, "\nIf overhead stats are printed, they are the columns labeled self_OH and parent_OH\n"
 	     "self_OH is estimated as 2X the Fortran layer cost (start+stop) plust the cost of \n"
 	     "a single call to the underlying timing routine.\n"
 	     "parent_OH is the overhead for the named timer which is subsumed into its parent.\n"
 	     "It is estimated as the cost of a single GPTLstart()/GPTLstop() pair.\n"
+	     "OH_frac is (self_OH + parent_OH) divided by the wallclock time of the timer.\n"
              "Print method was %s.\n", methodstr (method));
+    if (subtract_ohd)
+      fprintf (fp, "\nEstimated GPTL overhead HAS BEEN SUBTRACTED from Wallclock and Exclusive:\n"
+	       "self_OH of the timer itself plus self_OH+parent_OH of every timer nested in it.\n"
+	       "Each thread's overhead was calibrated on its own call stack at its first GPTLstart.\n");
 #ifdef ENABLE_PMPI
     fprintf (fp, "\nIf a AVG_MPI_BYTES field is present, it is an estimate of the per-call\n"
              "average number of bytes handled by that process.\n"
              "If timers beginning with sync_ are present, it means MPI synchronization "
              "was turned on.\n");
 #endif
-    fprintf (fp, "\nIf a \'%%_of\' field is present, it is w.r.t. the first timer for thread 0.\n"
+    fprintf (fp, "\nIf an \'Exclusive\' field is present, it is wallclock minus the time spent in\n"
+             "timers started while this one was on (i.e. self time).\n"
+             "If a \'%%_of\' field is present, it is w.r.t. the first timer for thread 0.\n"
              "If a \'e6_per_sec\' field is present, it is in millions of PAPI counts per sec.\n\n"
              "A '*' in column 1 below means the timer had multiple parents, though the\n"
              "values printed are for all calls.\n"
@@ -1514,61 +2367,36 @@ int GPTLpr_file (const char *outfile) /* output file to write */
   (void) GPTLget_memusage (&size, &rss, &share, &text, &datastack);
   fprintf (fp, "Process size=%d MB rss=%d MB\n\n", size, rss);
 
+  print_hotspots (fp);
+#ifdef ENABLE_PMPI
+  GPTLprint_msghist (fp, timers, nthreads, getentry_samename);
+  GPTLprint_commstats (fp, pmpithread, nthreads);
+  GPTLprint_reqstats (fp, pmpithread, nthreads);
+  GPTLprint_latestats (fp);
+#endif
+
   sum = (float *) GPTLallocate (nthreads * sizeof (float), thisfunc);
   
-  for (t = 0; t < nthreads; ++t) {
-    print_titles (t, fp);
-    /*
-    ** Print timing stats. If imperfect nesting was detected, print stats by going through
-    ** the linked list and do not indent anything due to the possibility of error.
-    ** Otherwise, print call tree and properly indented stats via recursive routine. "-1" 
-    ** is flag to avoid printing dummy outermost timer, and initialize the depth.
-    */
-    if (imperfect_nest) {
-      for (ptr = timers[t]->next; ptr; ptr = ptr->next) {
-	printstats (ptr, fp, t, 0, false, self_ohd, parent_ohd);
-      }
-    } else {
-      printself_andchildren (timers[t], fp, t, -1, self_ohd, parent_ohd);
-    }
-
-    /* 
-    ** Sum of self+parent overhead across timers is an estimate of total overhead.
-    */
-    sum[t]   = 0;
-    totcount = 0;
-    for (ptr = timers[t]->next; ptr; ptr = ptr->next) {
-      sum[t]   += ptr->count * (parent_ohd + self_ohd);
-      totcount += ptr->count;
-    }
-    if (wallstats.enabled && overheadstats.enabled)
-      fprintf (fp, "\n");
-      fprintf (fp, "Overhead sum = %9.3g wallclock seconds\n", sum[t]);
-    if (totcount < PRTHRESH)
-      fprintf (fp, "Total calls  = %lu\n", totcount);
-    else
-      fprintf (fp, "Total calls  = %9.3e\n", (float) totcount);
-  }
+  print_threads (fp, sum);
 
   /* Print per-name stats for all threads */
   if (dopr_threadsort && nthreads > 1) {
     fprintf (fp, "\nSame stats sorted by timer for threaded regions:\n");
-    fprintf (fp, "Thd ");
-
-    for (n = 0; n < max_name_len[0]; ++n) /* longest timer name */
-      fprintf (fp, " ");
-
-    fprintf (fp, "Called  Recurse ");
+    fprintf (fp, "Thd %*sCalled  Recurse ", max_name_len[0], ""); /* pad: longest timer name */
 
     if (cpustats.enabled)
       fprintf (fp, "%s", cpustats.str);
     if (wallstats.enabled) {
       fprintf (fp, "%s", wallstats.str);
+      if (exclstats.enabled)
+        fprintf (fp, "%s", exclstats.str);
       if (percent && timers[0]->next)
         fprintf (fp, "%%_of_%5.5s ", timers[0]->next->name);
       if (overheadstats.enabled)
         fprintf (fp, "%s", overheadstats.str);
     }
+    if (rssstats.enabled)
+      fprintf (fp, "%s", rssstats.str);
 
 #ifdef HAVE_PAPI
     GPTL_PAPIprstr (fp);
@@ -1585,24 +2413,23 @@ int GPTLpr_file (const char *outfile) /* output file to write */
       foundany = false;
       first = true;
       sumstats = *ptr;
+      get_ohd_est (0, &self_ohd, &parent_ohd);
       for (t = 1; t < nthreads; ++t) {
-        found = false;
-        for (tptr = timers[t]->next; tptr && ! found; tptr = tptr->next) {
-          if (STRMATCH (ptr->name, tptr->name)) {
-
-            /* Only print thread 0 when this timer found for other threads */
-            if (first) {
-              first = false;
-              fprintf (fp, "%3.3d ", 0);
-              printstats (ptr, fp, 0, 0, false, self_ohd, parent_ohd);
-            }
-
-            found = true;
-            foundany = true;
-            fprintf (fp, "%3.3d ", t);
-            printstats (tptr, fp, 0, 0, false, self_ohd, parent_ohd);
-            add (&sumstats, tptr);
+        /* Hash lookup rather than a walk of thread t's list: this loop is O(regions*threads) */
+        if ((tptr = getentry_samename (t, ptr))) {
+
+          /* Only print thread 0 when this timer found for other threads */
+          if (first) {
+            first = false;
+            fprintf (fp, "%3.3d ", 0);
+            printstats (ptr, fp, 0, 0, false, self_ohd, parent_ohd);
           }
+
+          foundany = true;
+          fprintf (fp, "%3.3d ", t);
+          get_ohd_est (t, &tself_ohd, &tparent_ohd);
+          printstats (tptr, fp, 0, 0, false, tself_ohd, tparent_ohd);
+          add (&sumstats, tptr);
         }
       }
 
@@ -1664,24 +2491,98 @@ int GPTLpr_file (const char *outfile) /* output file to write */
 
   free (sum);
 
-  if (fp != stderr && fclose (fp) != 0)
-    fprintf (stderr, "%s: Attempt to close %s failed\n", thisfunc, outfile);
-
   pr_has_been_called = true;
   return 0;
 }
 
-/* 
-** print_titles: Print headings to output file. If imperfect nesting was detected, print simply by
-**               following the linked list. Otherwise, indent use parent-child relationships.
+/*
+** print_threads: Print the per-thread stats sections in thread order. When OpenMP and
+**   open_memstream() are available, the sections are formatted concurrently into
+**   in-memory buffers, then written out in order: with many threads and regions the
+**   formatting dominates GPTLpr_file, and each thread's section depends only on that
+**   thread's timers.
 **
 ** Input arguments:
-**   t: thread number
+**   fp:  file descriptor to write to
+**
+** Output arguments:
+**   sum: estimated overhead for each thread
 */
-static void print_titles (int t, FILE *fp)
+static void print_threads (FILE *fp, float *sum)
 {
-  int n;
-  static const char *thisfunc = "print_titles";
+  int t;                /* thread index */
+#if ( defined THREADED_OMP && defined HAVE_OPEN_MEMSTREAM )
+  char **buf;           /* per-thread formatted section */
+  size_t *len;          /* length of each buf */
+  double self_ohd;      /* estimated overhead in the timer itself */
+  double parent_ohd;    /* estimated overhead subsumed into the parent */
+  static const char *thisfunc = "print_threads";
+
+  buf = (char **) GPTLallocate (nthreads * sizeof (char *), thisfunc);
+  len = (size_t *) GPTLallocate (nthreads * sizeof (size_t), thisfunc);
+  if ( ! buf || ! len) {
+    free (buf);
+    free (len);
+    for (t = 0; t < nthreads; ++t)
+      print_thread (fp, t, &sum[t]);
+    return;
+  }
+
+  /* Overhead calibration is itself a timing loop: do it before going parallel */
+  for (t = 0; t < nthreads; ++t)
+    get_ohd_est (t, &self_ohd, &parent_ohd);
+
+#pragma omp parallel for schedule (dynamic)
+  for (t = 0; t < nthreads; ++t) {
+    FILE *tfp;          /* stream into buf[t] */
+
+    buf[t] = 0;
+    len[t] = 0;
+    if ((tfp = open_memstream (&buf[t], &len[t]))) {
+      print_thread (tfp, t, &sum[t]);
+      if (fclose (tfp) != 0) {
+	free (buf[t]);
+	buf[t] = 0;
+      }
+    }
+  }
+
+  for (t = 0; t < nthreads; ++t) {
+    if (buf[t]) {
+      fwrite (buf[t], 1, len[t], fp);
+      free (buf[t]);
+    } else {
+      print_thread (fp, t, &sum[t]);   /* memstream failed: print directly */
+    }
+  }
+  free (buf);
+  free (len);
+#else
+  for (t = 0; t < nthreads; ++t)
+    print_thread (fp, t, &sum[t]);
+#endif
+}
+
+/*
+** print_thread: Print the stats section for one thread
+**
+** Input arguments:
+**   fp:  file descriptor to write to
+**   t:   thread index
+**
+** Output arguments:
+**   sum: estimated overhead for the thread
+*/
+static void print_thread (FILE *fp, const int t, float *sum)
+{
+  Timer *ptr;               /* walk through the thread's linked list */
+  unsigned long totcount;   /* total timer invocations */
+  double self_ohd;          /* estimated library overhead in self timer */
+  double parent_ohd;        /* estimated library overhead due to self in parent timer */
+  static const char *thisfunc = "print_thread";
+
+  get_ohd_est (t, &self_ohd, &parent_ohd);
+
   /*
   ** Construct tree for printing timers in parent/child form. get_max_depth() must be called 
   ** AFTER construct_tree() because it relies on the per-parent children arrays being complete.
@@ -1693,27 +2594,69 @@ static void print_titles (int t, FILE *fp)
       printf ("GPTL: %s: failure from construct_tree: output will be incomplete\n", thisfunc);
     max_depth[t] = get_max_depth (timers[t], 0);
   }
+  print_titles (t, max_depth[t], fp);
+  /*
+  ** Print timing stats. If imperfect nesting was detected, print stats by going through
+  ** the linked list and do not indent anything due to the possibility of error.
+  ** Otherwise, print call tree and properly indented stats via recursive routine. "-1" 
+  ** is flag to avoid printing dummy outermost timer, and initialize the depth.
+  */
+  if (imperfect_nest) {
+    for (ptr = timers[t]->next; ptr; ptr = ptr->next) {
+      printstats (ptr, fp, t, 0, false, self_ohd, parent_ohd);
+    }
+  } else {
+    printself_andchildren (timers[t], fp, t, -1, self_ohd, parent_ohd);
+  }
+
+  /* 
+  ** Sum of self+parent overhead across timers is an estimate of total overhead.
+  */
+  *sum     = 0;
+  totcount = 0;
+  for (ptr = timers[t]->next; ptr; ptr = ptr->next) {
+    *sum     += ptr->count * (parent_ohd + self_ohd);
+    totcount += ptr->count;
+  }
+  if (wallstats.enabled && overheadstats.enabled)
+    fprintf (fp, "\n");
+    fprintf (fp, "Overhead sum = %9.3g wallclock seconds\n", *sum);
+  if (totcount < PRTHRESH)
+    fprintf (fp, "Total calls  = %lu\n", totcount);
+  else
+    fprintf (fp, "Total calls  = %9.3e\n", (float) totcount);
+}
 
+/* 
+** print_titles: Print headings to output file
+**
+** Input arguments:
+**   t:        thread number
+**   maxdepth: deepest indent level of the names below, -1 if they are not indented
+*/
+static void print_titles (int t, int maxdepth, FILE *fp)
+{
   if (t > 0)
     fprintf (fp, "\n");
   fprintf (fp, "Stats for thread %d:\n", t);
 
-  for (n = 0; n < max_depth[t]+1; ++n)    /* +1 to always indent timer name */
-    fprintf (fp, "  ");
-  for (n = 0; n < max_name_len[t]; ++n) /* longest timer name */
-    fprintf (fp, " ");
-  fprintf (fp, "Called  Recurse ");
+  /* Pad to max indent (+1 to always indent timer name) plus longest timer name */
+  fprintf (fp, "%*sCalled  Recurse ", 2*(maxdepth+1) + max_name_len[t], "");
 
   /* Print strings for enabled timer types */
   if (cpustats.enabled)
     fprintf (fp, "%s", cpustats.str);
   if (wallstats.enabled) {
     fprintf (fp, "%s", wallstats.str);
+    if (exclstats.enabled)
+      fprintf (fp, "%s", exclstats.str);
     if (percent && timers[0]->next)
       fprintf (fp, "%%_of_%5.5s ", timers[0]->next->name);
     if (overheadstats.enabled)
       fprintf (fp, "%s", overheadstats.str);
   }
+  if (rssstats.enabled)
+    fprintf (fp, "%s", rssstats.str);
 
 #ifdef ENABLE_PMPI
   fprintf (fp, "AVG_MPI_BYTES ");
@@ -1949,15 +2892,15 @@ static void printstats (const Timer *timer,
                         double self_ohd,
 			double parent_ohd)
 {
-  int i;               /* index */
-  int indent;          /* index for indenting */
-  int extraspace;      /* for padding to length of longest name */
+  int width;           /* name field width: longest name plus unused indent levels */
   float fusr;          /* user time as float */
   float fsys;          /* system time as float */
   float usrsys;        /* usr + sys */
-  float elapse;        /* elapsed time */
-  float wallmax;       /* max wall time */
-  float wallmin;       /* min wall time */
+  double elapse;       /* elapsed time */
+  double wallmax;      /* max wall time */
+  double wallmin;      /* min wall time */
+  double incl;         /* inclusive wall time, less overhead if subtract_ohd */
+  double excl;         /* exclusive wall time, less overhead if subtract_ohd */
   float ratio;         /* percentage calc */
   static const char *thisfunc = "printstats";
 
@@ -1965,28 +2908,15 @@ static void printstats (const Timer *timer,
     fprintf (stderr, "GPTL: %s: timer %s had not been turned off\n", thisfunc, timer->name);
 
   /* Flag regions having multiple parents with a "*" in column 1 */
-  if (doindent) {
-    if (timer->nparent > 1)
-      fprintf (fp, "* ");
-    else
-      fprintf (fp, "  ");
-
-    /* Indent to depth of this timer */
-    for (indent = 0; indent < depth; ++indent)
-      fprintf (fp, "  ");
-  }
-
-  fprintf (fp, "%s", timer->name);
-
-  /* Pad to length of longest name */
-  extraspace = max_name_len[t] - strlen (timer->name);
-  for (i = 0; i < extraspace; ++i)
-    fprintf (fp, " ");
+  /* Indent to depth of this timer */
+  if (doindent)
+    fprintf (fp, "%s%*s", (timer->nparent > 1) ? "* " : "  ", 2*depth, "");
 
-  /* Pad to max indent level */
+  /* Pad to length of longest name, then to max indent level */
+  width = max_name_len[t];
   if (doindent)
-    for (indent = depth; indent < max_depth[t]; ++indent)
-      fprintf (fp, "  ");
+    width += 2 * MAX (max_depth[t] - depth, 0);
+  fprintf (fp, "%-*s", width, timer->name);
 
     /* 
   ** Don't print stats if the timer is currently on: too dangerous since the timer needs 
@@ -2017,7 +2947,8 @@ if (timer->count < PRTHRESH) {
   }
 
   if (wallstats.enabled) {
-    elapse = timer->wall.accum;
+    adjust_wallstats (timer, self_ohd, parent_ohd, &incl, &excl);
+    elapse = incl;
     wallmax = timer->wall.max;
     wallmin = timer->wall.min;
 
@@ -2036,6 +2967,13 @@ if (timer->count < PRTHRESH) {
     else
       fprintf (fp, "%9.3f ", wallmin);
 
+    if (exclstats.enabled) {
+      if (excl < 0.01)
+        fprintf (fp, "%9.2e ", excl);
+      else
+        fprintf (fp, "%9.3f ", excl);
+    }
+
     if (percent && timers[0]->next) {
       ratio = 0.;
       if (timers[0]->next->wall.accum > 0.)
@@ -2044,10 +2982,18 @@ if (timer->count < PRTHRESH) {
     }
 
     if (overheadstats.enabled) {
-      fprintf (fp, "%9.3f %9.3f ", timer->count*self_ohd, timer->count*parent_ohd);
+      ratio = 0.;
+      if (timer->wall.accum > 0.)
+        ratio = timer->count * (self_ohd + parent_ohd) / timer->wall.accum;
+      else if (timer->count > 0)
+        ratio = HUGE_VAL;   /* too short for the clock to register: all overhead */
+      fprintf (fp, "%9.3f %9.3f %9.2e ", timer->count*self_ohd, timer->count*parent_ohd, ratio);
     }
   }
 
+  if (rssstats.enabled)
+    fprintf (fp, "%9.3f %9.3f ", timer->rss.accum, timer->rss.max);
+
 #ifdef ENABLE_PMPI
   if (timer->nbytes == 0.)
     fprintf (fp, "      -       ");
@@ -2108,6 +3054,8 @@ static void add (Timer *tout,
 
   if (wallstats.enabled) {
     tout->wall.accum += tin->wall.accum;
+    tout->wall.excl  += tin->wall.excl;
+    tout->wall.sumsq += tin->wall.sumsq;
     
     tout->wall.max = MAX (tout->wall.max, tin->wall.max);
     tout->wall.min = MIN (tout->wall.min, tin->wall.min);
@@ -2117,11 +3065,130 @@ static void add (Timer *tout,
     tout->cpu.accum_utime += tin->cpu.accum_utime;
     tout->cpu.accum_stime += tin->cpu.accum_stime;
   }
+
+  if (rssstats.enabled) {
+    tout->rss.accum += tin->rss.accum;
+    tout->rss.count += tin->rss.count;
+    tout->rss.max = MAX (tout->rss.max, tin->rss.max);
+  }
 #ifdef HAVE_PAPI
   GPTL_PAPIadd (&tout->aux, &tin->aux);
 #endif
 }
 
+/*
+** getentry_samename: find the timer on thread t which corresponds to ptr (which may
+**   belong to a different thread). Auto-instrumented timers are matched by address.
+**
+** Input arguments:
+**   t:   thread number to search
+**   ptr: timer to match
+**
+** Return value: pointer to the timer on thread t, or NULL if not found
+*/
+static inline Timer *getentry_samename (const int t, const Timer *ptr)
+{
+  unsigned int indx;
+
+  if (ptr->address)
+    return getentry_instr (hashtable[t], ptr->address, &indx);
+  return getentry (hashtable[t], ptr->name, genhashidx (ptr->name));
+}
+
+/*
+** print_hotspots: sum each region over threads and print the hotspot rankings,
+**                 followed by the list of overhead-dominated regions. The sums are
+**                 built in one pass over all threads' timers, joining on the same hash
+**                 index as the timers' own tables: name, or address if auto-instrumented.
+**
+** Input arguments:
+**   fp: file descriptor to write to
+*/
+static void print_hotspots (FILE *fp)
+{
+  Hotspot *spots;    /* one entry per distinct region */
+  const Timer **rep; /* a timer of each spot, for matching */
+  int *head;         /* per hash index: first spot, or -1 */
+  int *next;         /* per spot: next spot with the same hash index, or -1 */
+  Timer *ptr;        /* walk through a thread's linked list */
+  unsigned int indx; /* hash index */
+  int nspots = 0;    /* number of regions found so far */
+  int maxspots = 0;  /* upper bound on nspots */
+  int t;             /* thread index */
+  int n;             /* spot index */
+  double self_ohd;   /* estimated per-call overhead in the timer itself */
+  double parent_ohd; /* estimated per-call overhead subsumed into the parent */
+  double incl;       /* wallclock, less overhead if subtract_ohd */
+  double excl;       /* exclusive wallclock, less overhead if subtract_ohd */
+  static const char *thisfunc = "print_hotspots";
+
+  if ( ! wallstats.enabled)
+    return;
+
+  for (t = 0; t < nthreads; ++t)
+    for (ptr = timers[t]->next; ptr; ptr = ptr->next)
+      ++maxspots;
+
+  if (maxspots == 0)
+    return;
+
+  spots = (Hotspot *) GPTLallocate (maxspots * sizeof (Hotspot), thisfunc);
+  rep   = (const Timer **) GPTLallocate (maxspots * sizeof (Timer *), thisfunc);
+  next  = (int *) GPTLallocate (maxspots * sizeof (int), thisfunc);
+  head  = (int *) GPTLallocate (tablesize * sizeof (int), thisfunc);
+  if ( ! spots || ! rep || ! next || ! head) {
+    free (spots);
+    free (rep);
+    free (next);
+    free (head);
+    return;
+  }
+  for (indx = 0; indx < tablesize; ++indx)
+    head[indx] = -1;
+
+  for (t = 0; t < nthreads; ++t) {
+    get_ohd_est (t, &self_ohd, &parent_ohd);
+    for (ptr = timers[t]->next; ptr; ptr = ptr->next) {
+      if (ptr->address)
+	indx = (((unsigned long) ptr->address) >> 4) % tablesize;
+      else
+	indx = genhashidx (ptr->name);
+
+      for (n = head[indx]; n >= 0; n = next[n])
+	if (ptr->address ? rep[n]->address == ptr->address : STRMATCH (rep[n]->name, ptr->name))
+	  break;
+      if (n < 0) {
+	n = nspots++;
+	rep[n]  = ptr;
+	next[n] = head[indx];
+	head[indx] = n;
+	spots[n].name  = ptr->name;
+	spots[n].incl  = 0.;
+	spots[n].excl  = 0.;
+	spots[n].ohd   = 0.;
+	spots[n].count = 0;
+      }
+
+      /* Stats of a timer which is still on are incomplete */
+      if ( ! ptr->onflg) {
+	adjust_wallstats (ptr, self_ohd, parent_ohd, &incl, &excl);
+	spots[n].incl  += incl;
+	spots[n].excl  += excl;
+	spots[n].ohd   += ptr->count * (self_ohd + parent_ohd);
+	spots[n].count += ptr->count;
+      }
+    }
+  }
+
+  GPTLprint_hotspots (fp, spots, nspots, "summed over threads");
+  get_ohd_est (0, &self_ohd, &parent_ohd);
+  GPTLprint_ohdwarn (fp, spots, nspots, self_ohd + parent_ohd);
+  free (spots);
+  free (rep);
+  free (next);
+  free (head);
+}
+
 #ifdef HAVE_LIBMPI
 
 /* 
@@ -2292,6 +3359,7 @@ int GPTLget_wallclock (const char *timername,
   void *self;          /* timer address when hash entry generated with *_instr */
   Timer *ptr;          /* linked list pointer */
   unsigned int indx;   /* hash index returned from getentry (unused) */
+  double excl;         /* exclusive time (unused) */
   static const char *thisfunc = "GPTLget_wallclock";
   
   if ( ! initialized)
@@ -2322,7 +3390,7 @@ int GPTLget_wallclock (const char *timername,
     if ( !ptr)
       return GPTLerror ("%s: requested timer %s does not exist\n", thisfunc, timername);
   }
-  *value = ptr->wall.accum;
+  GPTLget_wallstats_adj (ptr, t, value, &excl);
   return 0;
 }
 
@@ -2367,6 +3435,59 @@ int GPTLget_wallclock_latest (const char *timername,
   return 0;
 }
 
+/*
+** GPTLget_exclusive: return exclusive (self) wallclock accumulation for a timer, i.e.
+** its wallclock accumulation minus the time spent in timers started while it was on.
+** 
+** Input args:
+**   timername: timer name
+**   t:         thread number (if < 0, the request is for the current thread)
+**
+** Output args:
+**   value: current exclusive wallclock accumulation for the timer
+*/
+int GPTLget_exclusive (const char *timername,
+		       int t,
+		       double *value)
+{
+  void *self;          /* timer address when hash entry generated with *_instr */
+  Timer *ptr;          /* linked list pointer */
+  unsigned int indx;   /* hash index returned from getentry (unused) */
+  double incl;         /* inclusive time (unused) */
+  static const char *thisfunc = "GPTLget_exclusive";
+  
+  if ( ! initialized)
+    return GPTLerror ("%s: GPTLinitialize has not been called\n", thisfunc);
+
+  if ( ! wallstats.enabled)
+    return GPTLerror ("%s: wallstats not enabled\n", thisfunc);
+  
+  /* If t is < 0, assume the request is for the current thread */
+  if (t < 0) {
+    if ((t = get_thread_num ()) < 0)
+      return GPTLerror ("%s: bad return from get_thread_num\n", thisfunc);
+  } else {
+    if (t >= maxthreads)
+      return GPTLerror ("%s: requested thread %d is too big\n", thisfunc, t);
+  }
+  
+  /* 
+  ** Don't know whether hashtable entry for timername was generated with 
+  ** *_instr() or not, so try both possibilities
+  */
+  indx = genhashidx (timername);
+  ptr = getentry (hashtable[t], timername, indx);
+  if ( !ptr) {
+    if (sscanf (timername, "%lx", (unsigned long *) &self) < 1)
+      return GPTLerror ("%s: requested timer %s does not exist\n", thisfunc, timername);
+    ptr = getentry_instr (hashtable[t], self, &indx);
+    if ( !ptr)
+      return GPTLerror ("%s: requested timer %s does not exist\n", thisfunc, timername);
+  }
+  GPTLget_wallstats_adj (ptr, t, &incl, value);
+  return 0;
+}
+
 /*
 ** GPTLget_threadwork: For a timer, across threads compute max work and imbalance
 **
@@ -2494,10 +3615,12 @@ int GPTLstartstop_val (const char *name,
     ** adding user input
     */
     ptr->wall.accum -= ptr->wall.latest;
+    ptr->wall.excl  -= ptr->wall.latest;
   }
 
   /* Overwrite the values with user input */
   ptr->wall.accum += value;
+  ptr->wall.excl  += value;
   ptr->wall.latest = value;
   if (value > ptr->wall.max)
     ptr->wall.max = value;
@@ -2837,7 +3960,7 @@ void __func_trace_enter (const char *function_name,
                          void **const user_data)
 {
   char msg[MSGSIZ];
-  int size, rss, share, text, datastack;
+  int rss;           /* process RSS (MB) */
   int world_iam;
 #ifdef HAVE_LIBMPI
   int flag = 0;
@@ -2845,8 +3968,7 @@ void __func_trace_enter (const char *function_name,
 #endif
 
   if (dopr_memusage && get_thread_num() == 0) {
-    (void) GPTLget_memusage (&size, &rss, &share, &text, &datastack);
-    if (rss > rssmax) {
+    if ((rss = (int) GPTLget_rss ()) > rssmax) {
       rssmax = rss;
       world_iam = 0;
 #ifdef HAVE_LIBMPI
@@ -2867,7 +3989,7 @@ void __func_trace_exit (const char *function_name,
                         void **const user_data)
 {
   char msg[MSGSIZ];
-  int size, rss, share, text, datastack;
+  int rss;           /* process RSS (MB) */
   int world_iam;
 #ifdef HAVE_LIBMPI
   int flag = 0;
@@ -2877,8 +3999,7 @@ void __func_trace_exit (const char *function_name,
   (void) GPTLstop (function_name);
 
   if (dopr_memusage && get_thread_num() == 0) {
-    (void) GPTLget_memusage (&size, &rss, &share, &text, &datastack);
-    if (rss > rssmax) {
+    if ((rss = (int) GPTLget_rss ()) > rssmax) {
       rssmax = rss;
       world_iam = 0;
 #ifdef HAVE_LIBMPI
@@ -2904,7 +4025,7 @@ void __cyg_profile_func_enter (void *this_fn,
   char **strings;
 #endif
   char msg[MSGSIZ];
-  int size, rss, share, text, datastack;
+  int rss;           /* process RSS (MB) */
   int world_iam;
 #ifdef HAVE_LIBMPI
   int flag = 0;
@@ -2912,8 +4033,7 @@ void __cyg_profile_func_enter (void *this_fn,
 #endif
 
   if (dopr_memusage && get_thread_num() == 0) {
-    (void) GPTLget_memusage (&size, &rss, &share, &text, &datastack);
-    if (rss > rssmax) {
+    if ((rss = (int) GPTLget_rss ()) > rssmax) {
       rssmax = rss;
       world_iam = 0;
 #ifdef HAVE_LIBMPI
@@ -2945,7 +4065,7 @@ void __cyg_profile_func_exit (void *this_fn,
   char **strings;
 #endif
   char msg[MSGSIZ];
-  int size, rss, share, text, datastack;
+  int rss;           /* process RSS (MB) */
   int world_iam;
 #ifdef HAVE_LIBMPI
   int flag = 0;
@@ -2955,8 +4075,7 @@ void __cyg_profile_func_exit (void *this_fn,
   (void) GPTLstop_instr (this_fn);
 
   if (dopr_memusage && get_thread_num() == 0) {
-    (void) GPTLget_memusage (&size, &rss, &share, &text, &datastack);
-    if (rss > rssmax) {
+    if ((rss = (int) GPTLget_rss ()) > rssmax) {
       rssmax = rss;
       world_iam = 0;
 #ifdef HAVE_LIBMPI
@@ -3285,6 +4404,162 @@ Timer **GPTLget_timersaddr ()
   return timers;
 }
 
+/*
+** GPTLget_overhead_est: Estimate per-call library overhead without printing anything.
+**                       NOT a public entry point. Must be called from thread 0.
+**
+** Output arguments:
+**   self_ohd:   estimated overhead in the timer itself
+**   parent_ohd: estimated overhead subsumed into the parent
+*/
+int GPTLget_overhead_est (double *self_ohd, double *parent_ohd)
+{
+  if (ohd_self[0] < 0.)
+    calibrate_ohd (0);
+  get_ohd_est (0, self_ohd, parent_ohd);
+  return 0;
+}
+
+/*
+** GPTLget_overhead_components: Measure the per-call cost of each component of GPTLstart/
+**   GPTLstop once, for the calling thread with its current hash table contents. Intended
+**   for benchmark harnesses which repeat the call and apply their own statistics.
+**
+** Input arguments:
+**   ncomp: size of comp (normally GPTLohd_ncomp)
+**
+** Output arguments:
+**   comp: per-call cost in seconds of each component, indexed by Ohdcomp (gptl.h)
+**
+** Return value: number of components filled in, or GPTLerror (failure)
+*/
+int GPTLget_overhead_components (double *comp, const int ncomp)
+{
+  int t;                          /* thread index */
+  double self_ohd, parent_ohd;    /* returned from GPTLget_overhead (unused) */
+  double allcomp[GPTLohd_ncomp];  /* all components */
+  int n;
+  static const char *thisfunc = "GPTLget_overhead_components";
+
+  if ( ! initialized)
+    return GPTLerror ("%s: GPTLinitialize has not been called\n", thisfunc);
+
+  if ((t = get_thread_num ()) < 0)
+    return GPTLerror ("%s: bad return from get_thread_num\n", thisfunc);
+
+  (void) GPTLget_overhead (0, ptr2wtimefunc, getentry, genhashidx, get_thread_num, 
+			   stackidx, callstack, hashtable[t], tablesize, dousepapi, imperfect_nest, 
+			   t, &self_ohd, &parent_ohd, allcomp);
+  for (n = 0; n < MIN (ncomp, GPTLohd_ncomp); ++n)
+    comp[n] = allcomp[n];
+  return n;
+}
+
+/*
+** GPTLget_wallstats_adj: Return inclusive and exclusive wallclock of a timer, with estimated
+**                        GPTL overhead removed if the user asked for that (GPTLsubtract_ohd).
+**                        NOT a public entry point.
+**
+** Input arguments:
+**   ptr: timer
+**   t:   thread which owns the timer
+**
+** Output arguments:
+**   incl: inclusive wallclock
+**   excl: exclusive wallclock
+*/
+void GPTLget_wallstats_adj (const Timer *ptr, const int t, double *incl, double *excl)
+{
+  double self_ohd;    /* estimated overhead in the timer itself */
+  double parent_ohd;  /* estimated overhead subsumed into the parent */
+
+  if (subtract_ohd) {
+    get_ohd_est (t, &self_ohd, &parent_ohd);
+    adjust_wallstats (ptr, self_ohd, parent_ohd, incl, excl);
+  } else {
+    *incl = ptr->wall.accum;
+    *excl = ptr->wall.excl;
+  }
+}
+
+/*
+** calibrate_ohd: Estimate per-call overhead of thread t against its own hash table and
+**   call stack. Called only by thread t itself: on its first GPTLstart when subtract_ohd
+**   is set, and otherwise by thread 0 when the estimate is first needed. The first
+**   thread calibrated stands in for threads which are not.
+**
+** Input arguments:
+**   t: calling thread
+*/
+static void calibrate_ohd (const int t)
+{
+  double self_ohd;    /* estimated overhead in the timer itself */
+  double parent_ohd;  /* estimated overhead subsumed into the parent */
+
+  (void) GPTLget_overhead (0, ptr2wtimefunc, getentry, genhashidx, get_thread_num, 
+			   stackidx, callstack, hashtable[t], tablesize, dousepapi, imperfect_nest, 
+			   t, &self_ohd, &parent_ohd, 0);
+  /* Self last: other threads read it to tell whether thread t is calibrated */
+  ohd_parent[t] = parent_ohd;
+  ohd_self[t]   = self_ohd;
+  if (ohd_ref < 0)
+    ohd_ref = t;
+}
+
+/*
+** get_ohd_est: Return per-call overhead estimates for thread t: its own if it was
+**              calibrated, else those of the reference thread. Never calibrates: that
+**              would borrow the call stack of thread t, which may be timing meanwhile.
+**              The estimates hold for the underlying timing routine in use, which cannot
+**              change until GPTLfinalize.
+**
+** Input arguments:
+**   t: thread index
+**
+** Output arguments:
+**   self_ohd:   estimated overhead in the timer itself
+**   parent_ohd: estimated overhead subsumed into the parent
+*/
+static void get_ohd_est (const int t, double *self_ohd, double *parent_ohd)
+{
+  int tt = t;   /* thread whose estimates are used */
+
+  if (ohd_self[t] < 0. && ohd_ref >= 0)
+    tt = ohd_ref;
+  *self_ohd   = MAX (ohd_self[tt], 0.);
+  *parent_ohd = MAX (ohd_parent[tt], 0.);
+}
+
+/*
+** adjust_wallstats: Subtract estimated GPTL overhead from a timer's wallclock stats if
+**   subtract_ohd is set. A timer's inclusive time contains self_ohd for each of its own
+**   calls and the full self_ohd+parent_ohd cost of every timer nested inside it. Its
+**   exclusive time contains its own self_ohd plus parent_ohd of its direct children (their
+**   self_ohd is already inside their own time). Results are clipped at zero.
+**
+** Input arguments:
+**   ptr:        timer
+**   self_ohd:   estimated per-call overhead in the timer itself
+**   parent_ohd: estimated per-call overhead subsumed into the parent
+**
+** Output arguments:
+**   incl: inclusive wallclock
+**   excl: exclusive wallclock
+*/
+static inline void adjust_wallstats (const Timer *ptr, const double self_ohd, 
+				     const double parent_ohd, double *incl, double *excl)
+{
+  *incl = ptr->wall.accum;
+  *excl = ptr->wall.excl;
+  if ( ! subtract_ohd)
+    return;
+
+  *incl -= ptr->count * self_ohd + ptr->wall.ndesc * (self_ohd + parent_ohd);
+  *excl -= ptr->count * self_ohd + ptr->wall.nchild * parent_ohd;
+  *incl = MAX (*incl, 0.);
+  *excl = MAX (*excl, 0.);
+}
+
 #ifdef ENABLE_PMPI
 /*
 ** GPTLgetentry: called ONLY from pmpi.c (i.e. not a public entry point). Returns a pointer to the 
@@ -3322,6 +4597,16 @@ int GPTLpr_has_been_called (void)
   return (int) pr_has_been_called;
 }
 
+/*
+** GPTLis_disabled: Called ONLY from pmpi.c (i.e. not a public entry point). Return whether
+**                  timers are disabled, so MPI_Finalize can restore the user's setting after
+**                  disabling them around its own messages.
+*/
+int GPTLis_disabled (void)
+{
+  return (int) disabled;
+}
+
 #endif
 
 /*************************************************************************************/
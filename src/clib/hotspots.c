@@ -0,0 +1,294 @@
+/*
+** hotspots.c
+**
+** Rank regions by exclusive time, inclusive time, call count and overhead fraction
+** so the question "where did the time go" can be answered without scanning the
+** call tree. Also flag regions whose timings are dominated by GPTL's own overhead.
+** Used by both GPTLpr_file() and GPTLpr_summary_file().
+*/
+
+#include "config.h" /* Must be first include. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>      /* HUGE_VAL */
+
+#include "private.h"
+#include "gptl.h"
+
+static int nhot = 10;   /* number of regions listed in each ranking (0 disables) */
+static int ohdwarn = 10; /* flag regions whose mean time is < ohdwarn x per-call overhead */
+
+typedef double (*Hotkey) (const Hotspot *);
+
+static double key_excl (const Hotspot *);
+static double key_incl (const Hotspot *);
+static double key_count (const Hotspot *);
+static double key_ohdfrac (const Hotspot *);
+static int partial_sort (Hotspot *, const int, Hotkey, Hotspot **, const int);
+static void sift_down (Hotspot **, const int, int, Hotkey);
+static void print_ranking (FILE *, Hotspot **, const int, const int, const double, const char *);
+
+int GPTLhotspots_setoption (const int option,
+			    const int val)
+{
+  static const char *thisfunc = "GPTLhotspots_setoption";
+
+  switch (option) {
+  case GPTLhotspots:
+    if (val < 0)
+      return GPTLerror ("%s: number of hotspots must not be negative. %d is invalid\n",
+			thisfunc, val);
+    nhot = val;
+    return 0;
+  case GPTLohdwarn:
+    if (val < 0)
+      return GPTLerror ("%s: overhead warning factor must not be negative. %d is invalid\n",
+			thisfunc, val);
+    ohdwarn = val;
+    return 0;
+  default:
+    break;
+  }
+  return 1;
+}
+
+/*
+** GPTLprint_hotspots: Print the top "nhot" regions sorted by each of exclusive time,
+**                     inclusive time, call count, and overhead fraction.
+**
+** Input arguments:
+**   fp:     file descriptor to write to
+**   spots:  per-region stats, already aggregated over threads (and tasks)
+**   nspots: number of entries in spots
+**   scope:  description of what was aggregated, for the heading
+*/
+void GPTLprint_hotspots (FILE *fp, Hotspot *spots, const int nspots, const char *scope)
+{
+  Hotspot **top;         /* pointers to the highest-ranked entries of spots */
+  int ntop;              /* number of entries in top */
+  int mnl = 4;           /* max name length: at least strlen ("name") */
+  double totexcl = 0.;   /* total exclusive time over all regions */
+  int n;
+  static const char *thisfunc = "GPTLprint_hotspots";
+
+  if (nhot < 1 || nspots < 1)
+    return;
+
+  for (n = 0; n < nspots; ++n) {
+    mnl = MAX (strlen (spots[n].name), mnl);
+    totexcl += spots[n].excl;
+  }
+
+  if ( ! (top = (Hotspot **) GPTLallocate (MIN (nhot, nspots) * sizeof (Hotspot *), thisfunc)))
+    return;
+
+  fprintf (fp, "\nHotspots: top %d regions %s\n", MIN (nhot, nspots), scope);
+  fprintf (fp, "'%%_excl' is exclusive time as a percentage of the exclusive time of all regions.\n"
+	   "'OH_frac' is estimated GPTL overhead (self_OH + parent_OH) divided by inclusive time.\n");
+
+  ntop = partial_sort (spots, nspots, key_excl, top, nhot);
+  print_ranking (fp, top, ntop, mnl, totexcl, "exclusive time");
+
+  ntop = partial_sort (spots, nspots, key_incl, top, nhot);
+  print_ranking (fp, top, ntop, mnl, totexcl, "inclusive time");
+
+  ntop = partial_sort (spots, nspots, key_count, top, nhot);
+  print_ranking (fp, top, ntop, mnl, totexcl, "number of calls");
+
+  ntop = partial_sort (spots, nspots, key_ohdfrac, top, nhot);
+  print_ranking (fp, top, ntop, mnl, totexcl, "overhead fraction");
+  fprintf (fp, "\n");
+
+  free (top);
+}
+
+/*
+** GPTLprint_ohdwarn: List regions whose mean time per call is less than "ohdwarn" times
+**                    the estimated per-call GPTL overhead, worst first. Such timers cost
+**                    about as much as what they measure: candidates for removal.
+**
+** Input arguments:
+**   fp:      file descriptor to write to
+**   spots:   per-region stats, already aggregated over threads (and tasks)
+**   nspots:  number of entries in spots
+**   ohd:     estimated overhead of one start/stop pair (self + parent)
+*/
+void GPTLprint_ohdwarn (FILE *fp, Hotspot *spots, const int nspots, const double ohd)
+{
+  Hotspot *flagged;      /* copies of the regions to be listed */
+  Hotspot **top;         /* flagged, sorted by overhead fraction */
+  int nflagged = 0;      /* number of entries in flagged */
+  int mnl = 4;           /* max name length: at least strlen ("name") */
+  int n;
+  static const char *thisfunc = "GPTLprint_ohdwarn";
+
+  if (ohdwarn < 1)
+    return;
+
+  for (n = 0; n < nspots; ++n)
+    if (spots[n].count > 0 && spots[n].incl < ohdwarn * spots[n].ohd)
+      ++nflagged;
+
+  if (nflagged == 0)
+    return;
+
+  flagged = (Hotspot *) GPTLallocate (nflagged * sizeof (Hotspot), thisfunc);
+  top = (Hotspot **) GPTLallocate (nflagged * sizeof (Hotspot *), thisfunc);
+  if ( ! flagged || ! top) {
+    free (flagged);
+    free (top);
+    return;
+  }
+
+  nflagged = 0;
+  for (n = 0; n < nspots; ++n) {
+    if (spots[n].count > 0 && spots[n].incl < ohdwarn * spots[n].ohd) {
+      flagged[nflagged++] = spots[n];
+      mnl = MAX (strlen (spots[n].name), mnl);
+    }
+  }
+  (void) partial_sort (flagged, nflagged, key_ohdfrac, top, nflagged);
+
+  fprintf (fp, "WARNING: %d regions have mean time per call less than %d x the estimated\n"
+	   "per-call GPTL overhead of %9.3e seconds. Their timings are dominated by\n"
+	   "instrumentation cost: consider removing these timers.\n", nflagged, ohdwarn, ohd);
+  fprintf (fp, "%-*s    Called Mean_time   OH_frac\n", mnl, "name");
+  for (n = 0; n < nflagged; ++n) {
+    fprintf (fp, "%-*s ", mnl, top[n]->name);
+    if (top[n]->count < PRTHRESH)
+      fprintf (fp, "%9llu ", top[n]->count);
+    else
+      fprintf (fp, "%9.3e ", (float) top[n]->count);
+    fprintf (fp, "%9.2e %9.2e\n", top[n]->incl / top[n]->count, key_ohdfrac (top[n]));
+  }
+  fprintf (fp, "\n");
+
+  free (top);
+  free (flagged);
+}
+
+/* Sort keys */
+static double key_excl (const Hotspot *spot)
+{
+  return spot->excl;
+}
+
+static double key_incl (const Hotspot *spot)
+{
+  return spot->incl;
+}
+
+static double key_count (const Hotspot *spot)
+{
+  return (double) spot->count;
+}
+
+/* A region too short for the clock to register is all overhead: rank it first */
+static double key_ohdfrac (const Hotspot *spot)
+{
+  if (spot->incl > 0.)
+    return spot->ohd / spot->incl;
+  return (spot->ohd > 0.) ? HUGE_VAL : 0.;
+}
+
+/*
+** partial_sort: Find the "nwant" entries of spots with the largest key, in descending
+**   order. Cost is O(nspots * log(nwant)) rather than a full sort of every region:
+**   a min-heap holds the best entries found so far and its root is the one to evict.
+**
+** Input arguments:
+**   spots:  array to be ranked (not modified)
+**   nspots: number of entries in spots
+**   key:    function returning the value to rank by
+**   nwant:  max number of entries wanted
+**
+** Output arguments:
+**   top:    pointers to the highest-ranked entries, largest first
+**
+** Return value: number of entries in top
+*/
+static int partial_sort (Hotspot *spots, const int nspots, Hotkey key,
+			 Hotspot **top, const int nwant)
+{
+  int ntop = MIN (nwant, nspots);
+  int n;
+  Hotspot *tmp;
+
+  for (n = 0; n < ntop; ++n)
+    top[n] = &spots[n];
+  for (n = ntop/2 - 1; n >= 0; --n)
+    sift_down (top, ntop, n, key);
+
+  for (n = ntop; n < nspots; ++n) {
+    if (key (&spots[n]) > key (top[0])) {
+      top[0] = &spots[n];
+      sift_down (top, ntop, 0, key);
+    }
+  }
+
+  /* Heap sort: repeatedly move the smallest to the end, leaving the largest first */
+  for (n = ntop - 1; n > 0; --n) {
+    tmp    = top[0];
+    top[0] = top[n];
+    top[n] = tmp;
+    sift_down (top, n, 0, key);
+  }
+  return ntop;
+}
+
+/*
+** sift_down: Restore the min-heap property below index i
+*/
+static void sift_down (Hotspot **heap, const int nheap, int i, Hotkey key)
+{
+  int child;
+  Hotspot *tmp;
+
+  while ((child = 2*i + 1) < nheap) {
+    if (child+1 < nheap && key (heap[child+1]) < key (heap[child]))
+      ++child;
+    if (key (heap[i]) <= key (heap[child]))
+      break;
+    tmp         = heap[i];
+    heap[i]     = heap[child];
+    heap[child] = tmp;
+    i = child;
+  }
+}
+
+/*
+** print_ranking: Print one ranked table
+*/
+static void print_ranking (FILE *fp, Hotspot **top, const int ntop, const int mnl,
+			   const double totexcl, const char *title)
+{
+  int n;
+  double pct;       /* percent of total exclusive time */
+
+  fprintf (fp, "\nSorted by %s:\n", title);
+  fprintf (fp, "%-*s    Called Inclusive Exclusive  %%_excl   OH_frac\n", mnl, "name");
+
+  for (n = 0; n < ntop; ++n) {
+    fprintf (fp, "%-*s ", mnl, top[n]->name);
+
+    if (top[n]->count < PRTHRESH)
+      fprintf (fp, "%9llu ", top[n]->count);
+    else
+      fprintf (fp, "%9.3e ", (float) top[n]->count);
+
+    if (top[n]->incl < 0.01)
+      fprintf (fp, "%9.2e ", top[n]->incl);
+    else
+      fprintf (fp, "%9.3f ", top[n]->incl);
+
+    if (top[n]->excl < 0.01)
+      fprintf (fp, "%9.2e ", top[n]->excl);
+    else
+      fprintf (fp, "%9.3f ", top[n]->excl);
+
+    pct = (totexcl > 0.) ? 100. * top[n]->excl / totexcl : 0.;
+    fprintf (fp, "%7.2f %9.2e\n", pct, key_ohdfrac (top[n]));
+  }
+}
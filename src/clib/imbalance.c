@@ -0,0 +1,132 @@
+/*
+** imbalance.c
+**
+** Rank regions by the time lost to load imbalance, so the regions where ranks (or
+** threads) wait on a straggler stand out without post-processing summary files.
+** Used by GPTLpr_summary_file(). For one region with max time "max" and mean time
+** "mean" across n ranks:
+**   imbal  = (max - mean) / max: 0 is perfect balance, near 1 one rank did all the work
+**   lost   = max - mean: wallclock the region would save if perfectly balanced
+**   rank_s = n * lost: rank-seconds spent waiting on the slowest rank
+*/
+
+#include "config.h" /* Must be first include. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "private.h"
+#include "gptl.h"
+
+static int nimb = 10;   /* number of regions listed (0 disables) */
+
+static int cmp_lost (const void *, const void *);
+
+int GPTLimbalance_setoption (const int option,
+			     const int val)
+{
+  static const char *thisfunc = "GPTLimbalance_setoption";
+
+  switch (option) {
+  case GPTLimbalance:
+    if (val < 0)
+      return GPTLerror ("%s: number of imbalanced regions must not be negative. %d is invalid\n",
+			thisfunc, val);
+    nimb = val;
+    return 0;
+  default:
+    break;
+  }
+  return 1;
+}
+
+/*
+** GPTLprint_imbalance: Print the top "nimb" regions sorted by time lost to imbalance,
+**                      with the slowest and fastest rank and thread of each.
+**
+** Input arguments:
+**   fp:       file descriptor to write to
+**   imb:      per-region stats, already aggregated over ranks (or threads)
+**   nimb_in:  number of entries in imb
+**   unit:     what max and mean are taken across: "ranks" or "threads"
+**   byrank:   print the rank of the slowest and fastest
+**   bythread: print the thread of the slowest and fastest
+*/
+void GPTLprint_imbalance (FILE *fp, Imbal *imb, const int nimb_in, const char *unit,
+			  const int byrank, const int bythread)
+{
+  Imbal **sorted;        /* regions with any imbalance, most time lost first */
+  int nsorted = 0;       /* number of entries in sorted */
+  int mnl = 4;           /* max name length: at least strlen ("name") */
+  int n;
+  double lost;
+  static const char *thisfunc = "GPTLprint_imbalance";
+
+  if (nimb < 1 || nimb_in < 1)
+    return;
+
+  if ( ! (sorted = (Imbal **) GPTLallocate (nimb_in * sizeof (Imbal *), thisfunc)))
+    return;
+
+  /* A region run by only one rank has no imbalance to speak of */
+  for (n = 0; n < nimb_in; ++n)
+    if (imb[n].n > 1 && imb[n].max > imb[n].mean)
+      sorted[nsorted++] = &imb[n];
+
+  if (nsorted == 0) {
+    free (sorted);
+    return;
+  }
+  qsort (sorted, nsorted, sizeof (Imbal *), cmp_lost);
+  nsorted = MIN (nimb, nsorted);
+  for (n = 0; n < nsorted; ++n)
+    mnl = MAX (strlen (sorted[n]->name), mnl);
+
+  fprintf (fp, "\nLoad imbalance: top %d regions by time lost, across %s\n", nsorted, unit);
+  fprintf (fp, "'imbal' is (max - mean) / max of the time across %s: 0 is perfect balance.\n"
+	   "'lost' is max - mean: wallclock the region would save if perfectly balanced.\n"
+	   "'%s_s' is lost x the number of %s: total time spent waiting on the slowest.\n",
+	   unit, unit, unit);
+
+  fprintf (fp, "%-*s %7s       max      mean   imbal      lost %9s_s  slowest (",
+	   mnl, "name", unit, unit);
+  if (byrank)
+    fprintf (fp, bythread ? "rank  thread" : "rank  ");
+  else
+    fprintf (fp, "thred");
+  fprintf (fp, ")  fastest (");
+  if (byrank)
+    fprintf (fp, bythread ? "rank  thread" : "rank  ");
+  else
+    fprintf (fp, "thred");
+  fprintf (fp, ")\n");
+
+  for (n = 0; n < nsorted; ++n) {
+    lost = sorted[n]->max - sorted[n]->mean;
+    fprintf (fp, "%-*s %7u %9.3f %9.3f %7.3f %9.3f %11.3f ", mnl, sorted[n]->name,
+	     sorted[n]->n, sorted[n]->max, sorted[n]->mean, lost / sorted[n]->max, lost,
+	     lost * sorted[n]->n);
+    if (byrank && bythread)
+      fprintf (fp, "        (%6d %5d)         (%6d %5d)\n",
+	       sorted[n]->maxp, sorted[n]->maxt, sorted[n]->minp, sorted[n]->mint);
+    else if (byrank)
+      fprintf (fp, "        (%6d)         (%6d)\n", sorted[n]->maxp, sorted[n]->minp);
+    else
+      fprintf (fp, "        (%5d)         (%5d)\n", sorted[n]->maxt, sorted[n]->mint);
+  }
+  fprintf (fp, "\n");
+
+  free (sorted);
+}
+
+/* Sort key: time lost, largest first */
+static int cmp_lost (const void *a, const void *b)
+{
+  const Imbal *ia = *(Imbal * const *) a;
+  const Imbal *ib = *(Imbal * const *) b;
+  double la = ia->max - ia->mean;
+  double lb = ib->max - ib->mean;
+
+  return (la < lb) - (la > lb);
+}
@@ -0,0 +1,205 @@
+/*
+** live.c
+**
+** Live statistics segment (GPTLlive_stats): the timers of each thread are published in
+** POSIX shared memory as they change, so a monitoring agent on the node can read them
+** while the process runs, without calls from the application and without file I/O.
+** The layout is described with Livehdr in private.h; bin/gptllive is a reader.
+*/
+
+#include "config.h" /* Must be first include. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>        /* getpid, ftruncate */
+
+#ifdef HAVE_SHM_OPEN
+#include <fcntl.h>         /* O_* constants */
+#include <sys/mman.h>      /* shm_open, mmap */
+#endif
+
+#include "private.h"
+#include "gptl.h"
+
+static bool dolive = false;       /* publish timers in the live statistics segment */
+
+#ifdef HAVE_SHM_OPEN
+static Livehdr *seg = NULL;       /* mapped segment, NULL unless GPTLlive_init succeeded */
+static size_t seglen = 0;         /* its length */
+static char segname[32];          /* its name, "/gptl.<pid>" */
+
+/* Seqlock: make seq odd before changing a record, and even again after */
+static inline void live_begin (Liverec *rec)
+{
+  ++rec->seq;
+  __sync_synchronize ();
+}
+
+static inline void live_end (Liverec *rec)
+{
+  __sync_synchronize ();
+  ++rec->seq;
+}
+#endif
+
+int GPTLlive_setoption (const int option,
+			const int val)
+{
+  switch (option) {
+  case GPTLlive_stats:
+#ifndef HAVE_SHM_OPEN
+    if (val)
+      return GPTLerror ("GPTLlive_setoption: shm_open is not available\n");
+#endif
+    dolive = (bool) val;
+    return 0;
+  default:
+    break;
+  }
+  return 1;
+}
+
+/*
+** GPTLlive_init: Create the live statistics segment if GPTLlive_stats is set. Called by
+**   GPTLinitialize once the underlying timing routine is known. Failure is only a
+**   warning: timing goes on without the segment.
+**
+** Input arguments:
+**   maxthreads: number of per-thread blocks
+**   clock:      name of the underlying timing routine
+**
+** Return value: 0 (success or not enabled) or -1 (failure)
+*/
+int GPTLlive_init (const int maxthreads, const char *clock)
+{
+#ifdef HAVE_SHM_OPEN
+  int fd;
+  void *addr;
+
+  if ( ! dolive)
+    return 0;
+
+  sprintf (segname, "/gptl.%d", (int) getpid ());
+  seglen = sizeof (Livehdr) + (size_t) maxthreads * sizeof (Liveblock);
+
+  /* A segment left by a crashed process with the same pid is replaced */
+  (void) shm_unlink (segname);
+  if ((fd = shm_open (segname, O_CREAT | O_EXCL | O_RDWR, 0644)) < 0) {
+    GPTLwarn ("GPTLlive_init: shm_open %s failed. No live statistics\n", segname);
+    return -1;
+  }
+  /* The segment starts zeroed, and pages of unused blocks are never touched */
+  if (ftruncate (fd, (off_t) seglen) != 0 ||
+      (addr = mmap (NULL, seglen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+    (void) close (fd);
+    (void) shm_unlink (segname);
+    GPTLwarn ("GPTLlive_init: cannot size or map %s. No live statistics\n", segname);
+    return -1;
+  }
+  (void) close (fd);
+
+  seg = (Livehdr *) addr;
+  seg->byteorder  = DUMP_BYTEORDER;
+  seg->reclen     = sizeof (Liverec);
+  seg->blocklen   = sizeof (Liveblock);
+  seg->maxthreads = maxthreads;
+  seg->pid        = (int) getpid ();
+  seg->origin     = GPTLtime_origin ();
+  strncpy (seg->clock, clock, sizeof (seg->clock) - 1);
+  __sync_synchronize ();
+  memcpy (seg->magic, LIVE_MAGIC, sizeof (seg->magic));
+#endif
+  return 0;
+}
+
+/*
+** GPTLlive_finalize: Unmap and remove the live statistics segment. Called by GPTLfinalize.
+*/
+void GPTLlive_finalize (void)
+{
+#ifdef HAVE_SHM_OPEN
+  if (seg) {
+    (void) munmap (seg, seglen);
+    (void) shm_unlink (segname);
+    seg = NULL;
+  }
+#endif
+  dolive = false;
+}
+
+/*
+** GPTLlive_add: Append a region to the block of a thread. Called by the thread itself
+**   when it first starts the region.
+**
+** Input arguments:
+**   t:    thread index
+**   name: region name
+**
+** Return value: record of the region, or NULL if there is no segment or the block is full
+*/
+Liverec *GPTLlive_add (const int t, const char *name)
+{
+#ifdef HAVE_SHM_OPEN
+  Liveblock *blk;
+  Liverec *rec;
+
+  if ( ! seg)
+    return NULL;
+
+  blk = (Liveblock *) (seg + 1) + t;
+  if (blk->nregions == LIVE_NREGION) {
+    ++blk->dropped;
+    return NULL;
+  }
+  rec = &blk->rec[blk->nregions];
+  strncpy (rec->name, name, MAX_CHARS);
+  /* Readers only look at the record once it is counted */
+  __sync_synchronize ();
+  ++blk->nregions;
+  return rec;
+#else
+  return NULL;
+#endif
+}
+
+/*
+** GPTLlive_start: Publish that a region was started. Called right after its start stamp.
+**
+** Input arguments:
+**   ptr: timer of the region, with a record
+*/
+void GPTLlive_start (const Timer *ptr)
+{
+#ifdef HAVE_SHM_OPEN
+  Liverec *rec = ptr->live;
+
+  live_begin (rec);
+  rec->onflg = 1;
+  rec->last  = ptr->wall.last;
+  live_end (rec);
+#endif
+}
+
+/*
+** GPTLlive_stop: Publish the stats of a region. Called when it is stopped or reset.
+**
+** Input arguments:
+**   ptr: timer of the region, with a record
+*/
+void GPTLlive_stop (const Timer *ptr)
+{
+#ifdef HAVE_SHM_OPEN
+  Liverec *rec = ptr->live;
+
+  live_begin (rec);
+  rec->onflg  = ptr->onflg;
+  rec->count  = ptr->count;
+  rec->accum  = ptr->wall.accum;
+  rec->max    = ptr->wall.max;
+  rec->min    = ptr->wall.min;
+  rec->latest = ptr->wall.latest;
+  rec->last   = ptr->wall.last;
+  live_end (rec);
+#endif
+}
@@ -35,6 +35,7 @@
 
 #include <sys/time.h>
 #include <sys/types.h>
+#include <fcntl.h>      /* open */
 
 #endif
 
@@ -45,6 +46,50 @@ static int set_convert2mb (void);
 
 static double convert2mb = 0.;  /* convert pages to MB (init to unset) */
 
+#ifdef HAVE_SLASHPROC
+static volatile int statm_fd = -1;  /* /proc/self/statm, kept open once read */
+
+/*
+** read_statm: Read the page counts of /proc/self/statm. The file is opened once and
+**   then reread with pread, which is thread-safe and is one syscall per call instead
+**   of fopen, read and close: cheap enough for every timer start and stop.
+**
+** Output arguments:
+**   pages: size, resident, shared, text, lib, data+stack, dirty
+**
+** Return value: 0 (success) or -1 (failure)
+*/
+static int read_statm (long pages[7])
+{
+  char buf[128];
+  char *p, *end;
+  ssize_t nc;
+  int fd;
+  int n;
+
+  if ((fd = statm_fd) < 0) {
+    if ((fd = open ("/proc/self/statm", O_RDONLY)) < 0)
+      return -1;
+    /* Another thread may have opened it meanwhile: keep one */
+    if ( ! __sync_bool_compare_and_swap (&statm_fd, -1, fd)) {
+      (void) close (fd);
+      fd = statm_fd;
+    }
+  }
+
+  if ((nc = pread (fd, buf, sizeof (buf) - 1, 0)) <= 0)
+    return -1;
+  buf[nc] = '\0';
+
+  for (p = buf, n = 0; n < 7; ++n, p = end) {
+    pages[n] = strtol (p, &end, 10);
+    if (end == p)
+      return -1;
+  }
+  return 0;
+}
+#endif
+
 int GPTLget_memusage (int *size_out,        /* process size in MB */
 		      int *rss_out,         /* resident set size in MB */ 
 		      int *share_out,       /* share segment size in MB */
@@ -57,9 +102,7 @@ int GPTLget_memusage (int *size_out,        /* process size in MB */
   static const char *thisfunc = "GPTLget_memusage";
 
 #ifdef HAVE_SLASHPROC
-  FILE *fd;                       /* file descriptor for fopen */
-  static char *file = "/proc/self/statm";
-  int dum;                        /* placeholder for unused return arguments */
+  long pages[7];                  /* page counts from /proc/self/statm */
   int share;
   int datastack;
 #elif (defined __APPLE__)
@@ -75,16 +118,14 @@ int GPTLget_memusage (int *size_out,        /* process size in MB */
     return GPTLerror ("%s: Cannot determine how to convert to MB", thisfunc);
 
 #ifdef HAVE_SLASHPROC
-  if ((fd = fopen (file, "r")) < 0)
-    return GPTLerror ("%s: bad attempt to open %s\n", thisfunc, file);
+  if (read_statm (pages) < 0)
+    return GPTLerror ("%s: bad attempt to read /proc/self/statm\n", thisfunc);
 
-  /*
-  ** Read the desired data from the /proc filesystem directly into the output
-  ** arguments, close the file and return.
-  */
-  (void) fscanf (fd, "%d %d %d %d %d %d %d", 
-		 &size, &rss, &share, &text, &dum, &datastack, &dum);
-  (void) fclose (fd);
+  size      = (int) pages[0];
+  rss       = (int) pages[1];
+  share     = (int) pages[2];
+  text      = (int) pages[3];
+  datastack = (int) pages[5];
 
   *size_out      = (int) (size      * convert2mb);
   *rss_out       = (int) (rss       * convert2mb);
@@ -127,6 +168,40 @@ int GPTLget_memusage (int *size_out,        /* process size in MB */
   return 0;
 }
 
+/*
+** GPTLget_rss: Resident set size of the process, as cheaply as the system allows. Called
+**   at every timer start and stop with GPTLrss_delta, and at every auto-instrumented
+**   entry and exit with GPTLdopr_memusage. Where there is no /proc this is the peak RSS
+**   from getrusage, so deltas there are growth of the peak.
+**
+** Return value: RSS in MB, or -1 (failure)
+*/
+double GPTLget_rss (void)
+{
+#ifdef HAVE_SLASHPROC
+  long pages[7];
+#else
+  struct rusage usage;
+#endif
+
+  if (set_convert2mb () < 0)
+    return -1.;
+
+#ifdef HAVE_SLASHPROC
+  if (read_statm (pages) < 0)
+    return -1.;
+  return pages[1] * convert2mb;
+#else
+  if (getrusage (RUSAGE_SELF, &usage) < 0)
+    return -1.;
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024.*1024.);  /* getrusage reports bytes on Apple */
+#else
+  return usage.ru_maxrss * convert2mb;
+#endif
+#endif
+}
+
 /*
 ** print_memusage:
 **
@@ -0,0 +1,146 @@
+/*
+** msghist.c
+**
+** Per-routine MPI message size histograms for the PMPI wrappers. Each call is added
+** to a power-of-two size bucket together with the time it took, so the report shows
+** e.g. that most MPI_Allreduce time is spent in 8-byte reductions (latency bound)
+** rather than in large ones (bandwidth bound). Bucket 0 holds empty messages, bucket
+** b >= 1 holds sizes in [2^(b-1), 2^b), and the last bucket also holds anything larger.
+*/
+
+#include "config.h" /* Must be first include. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "private.h"
+
+#ifdef ENABLE_PMPI
+
+static void fmtbytes (char *, const double);
+
+/*
+** GPTLmsghist_add: Add the call just timed by timer to its message size histogram.
+**   Must be called right after the GPTLstop which ended the call.
+**
+** Input arguments:
+**   bytes: message size of the call
+**
+** Input/output arguments:
+**   timer: timer of the MPI routine. Its histogram is allocated on first use.
+*/
+void GPTLmsghist_add (Timer *timer, const double bytes)
+{
+  int b = 0;          /* bucket */
+  double lim = 1.;    /* lower bound of bucket b+1 */
+
+  if ( ! timer->msghist &&
+       ! (timer->msghist = (Msghist *) calloc (1, sizeof (Msghist))))
+    return;
+
+  while (bytes >= lim && b < MSGHIST_NBUCKET-1) {
+    ++b;
+    lim *= 2.;
+  }
+  ++timer->msghist->count[b];
+  timer->msghist->time[b] += timer->wall.latest;
+}
+
+/*
+** GPTLprint_msghist: Print the message size histogram of each MPI routine which has
+**   one, summed over threads. Each routine is printed from the first thread which has
+**   a histogram for it, so routines called only from other threads are included.
+**
+** Input arguments:
+**   fp:       file descriptor to write to
+**   timers:   per-thread linked lists of timers
+**   nthreads: number of threads
+**   samename: from gptl.c, hash lookup of the timer on a thread which matches a timer
+*/
+void GPTLprint_msghist (FILE *fp, Timer **timers, const int nthreads,
+			Timer *samename (const int, const Timer *))
+{
+  Msghist sum;         /* histogram summed over threads */
+  Timer *ptr, *tptr;
+  unsigned long count; /* calls summed over buckets */
+  double time;         /* time summed over buckets */
+  double lo;           /* lower bound of a bucket */
+  char lostr[16], histr[16];
+  char range[40];      /* bucket bounds, e.g. "4K - <8K" */
+  bool header = false;
+  int t, u, b;
+
+  for (t = 0; t < nthreads; ++t) {
+    for (ptr = timers[t]->next; ptr; ptr = ptr->next) {
+      if ( ! ptr->msghist)
+	continue;
+
+      /* Already printed from an earlier thread? */
+      for (u = 0; u < t; ++u)
+	if ((tptr = samename (u, ptr)) && tptr->msghist)
+	  break;
+      if (u < t)
+	continue;
+
+      memcpy (&sum, ptr->msghist, sizeof (Msghist));
+      for (u = t+1; u < nthreads; ++u)
+	if ((tptr = samename (u, ptr)) && tptr->msghist)
+	  for (b = 0; b < MSGHIST_NBUCKET; ++b) {
+	    sum.count[b] += tptr->msghist->count[b];
+	    sum.time[b]  += tptr->msghist->time[b];
+	  }
+
+      count = 0;
+      time = 0.;
+      for (b = 0; b < MSGHIST_NBUCKET; ++b) {
+	count += sum.count[b];
+	time  += sum.time[b];
+      }
+      if (count == 0)
+	continue;
+
+      if ( ! header) {
+	fprintf (fp, "\nMPI message size histograms: calls and time per power-of-two size bucket,\n"
+		 "summed over threads. Message size is bytes in the user's buffer (the per-rank\n"
+		 "block for collectives, the mean block for MPI_Alltoallv).\n");
+	header = true;
+      }
+      fprintf (fp, "\n%s: %lu calls %.3e seconds\n", ptr->name, count, time);
+      fprintf (fp, "  bytes             calls  %%calls       time   %%time\n");
+      for (b = 0, lo = 0.5; b < MSGHIST_NBUCKET; ++b, lo *= 2.) {
+	if (sum.count[b] == 0)
+	  continue;
+	if (b == 0) {
+	  sprintf (range, "0");
+	} else if (b == MSGHIST_NBUCKET-1) {
+	  fmtbytes (lostr, lo);
+	  sprintf (range, ">= %s", lostr);
+	} else {
+	  fmtbytes (lostr, lo);
+	  fmtbytes (histr, 2. * lo);
+	  sprintf (range, "%s - <%s", lostr, histr);
+	}
+	fprintf (fp, "  %-13s %9lu %7.1f %10.3e %7.1f\n", range, sum.count[b],
+		 100. * sum.count[b] / count, sum.time[b], (time > 0.) ? 100. * sum.time[b] / time : 0.);
+      }
+    }
+  }
+  if (header)
+    fprintf (fp, "\n");
+}
+
+/* Format a power of 2 byte count compactly, e.g. 512, 4K, 16M */
+static void fmtbytes (char *str, const double bytes)
+{
+  if (bytes < 1024.)
+    sprintf (str, "%.0f", bytes);
+  else if (bytes < 1024.*1024.)
+    sprintf (str, "%.0fK", bytes / 1024.);
+  else if (bytes < 1024.*1024.*1024.)
+    sprintf (str, "%.0fM", bytes / (1024.*1024.));
+  else
+    sprintf (str, "%.0fG", bytes / (1024.*1024.*1024.));
+}
+
+#endif
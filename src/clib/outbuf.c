@@ -0,0 +1,184 @@
+/*
+** outbuf.c
+**
+** Large-block output for the report writers (GPTLpr_file, GPTLpr_summary_file).
+** Reports are built from thousands of small fprintf calls. Formatting them straight
+** into a file turns each stdio buffer flush into a small write, and with thousands of
+** tasks writing timing.<id> at once those small writes swamp a parallel file system.
+** Instead the report is rendered into memory and written with a few large write()s
+** when it is closed.
+*/
+
+#include "config.h" /* Must be first include. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>         /* open */
+#include <unistd.h>        /* write, close */
+
+#include "private.h"
+
+#define OUTBUF_SIZE (4*1024*1024)  /* stdio buffer size when open_memstream is unavailable */
+#define MAX_WRITE (1L<<30)         /* largest single write() issued */
+
+/*
+** GPTLoutbuf_open: Open an output file and return a stream to format the report into.
+**   The file is created now so that failure to open it is reported at the same point
+**   as with fopen(). Output goes to memory if open_memstream() is available, otherwise
+**   to the file through a large stdio buffer.
+**
+** Input arguments:
+**   outfile: name of file to write
+**
+** Output arguments:
+**   ob: state needed by GPTLoutbuf_close
+**
+** Return value: stream to write to, or NULL if outfile cannot be opened
+*/
+FILE *GPTLoutbuf_open (Outbuf *ob, const char *outfile)
+{
+  memset (ob, 0, sizeof (Outbuf));
+  ob->outfile = outfile;
+
+  if ((ob->fd = open (outfile, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
+    return NULL;
+
+#ifdef HAVE_OPEN_MEMSTREAM
+  if ((ob->fp = open_memstream (&ob->buf, &ob->len))) {
+    ob->inmem = true;
+    return ob->fp;
+  }
+#endif
+
+  if ( ! (ob->fp = fdopen (ob->fd, "w"))) {
+    (void) close (ob->fd);
+    return NULL;
+  }
+  if ((ob->iobuf = (char *) malloc (OUTBUF_SIZE)))
+    (void) setvbuf (ob->fp, ob->iobuf, _IOFBF, OUTBUF_SIZE);
+  return ob->fp;
+}
+
+/*
+** GPTLoutbuf_close: Write out and close a stream opened by GPTLoutbuf_open
+**
+** Input/output arguments:
+**   ob: state set by GPTLoutbuf_open. Memory it holds is freed.
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+int GPTLoutbuf_close (Outbuf *ob)
+{
+  int ret = 0;
+  static const char *thisfunc = "GPTLoutbuf_close";
+
+  if ( ! ob->inmem) {
+    if (fclose (ob->fp) != 0)
+      ret = GPTLerror ("%s: error writing %s\n", thisfunc, ob->outfile);
+    free (ob->iobuf);
+    return ret;
+  }
+
+  /* fclose finalizes buf and len */
+  if (fclose (ob->fp) != 0)
+    ret = GPTLerror ("%s: error formatting %s\n", thisfunc, ob->outfile);
+  else if (GPTLwrite_all (ob->fd, ob->buf, ob->len) != 0)
+    ret = GPTLerror ("%s: error writing %s\n", thisfunc, ob->outfile);
+
+  if (close (ob->fd) != 0 && ret == 0)
+    ret = GPTLerror ("%s: error closing %s\n", thisfunc, ob->outfile);
+  free (ob->buf);
+  return ret;
+}
+
+/*
+** GPTLoutbuf_openmem: Return a stream to format a report into memory, for callers
+**   which place the result themselves (e.g. at an offset in a shared file). Uses
+**   open_memstream() if available, otherwise a temporary file read back at close.
+**
+** Output arguments:
+**   ob: state needed by GPTLoutbuf_closemem
+**
+** Return value: stream to write to, or NULL on failure
+*/
+FILE *GPTLoutbuf_openmem (Outbuf *ob)
+{
+  memset (ob, 0, sizeof (Outbuf));
+  ob->fd = -1;
+  ob->inmem = true;
+
+#ifdef HAVE_OPEN_MEMSTREAM
+  ob->fp = open_memstream (&ob->buf, &ob->len);
+#else
+  ob->fp = tmpfile ();
+#endif
+  return ob->fp;
+}
+
+/*
+** GPTLoutbuf_closemem: Close a stream opened by GPTLoutbuf_openmem. On success the
+**   caller owns ob->buf (ob->len bytes) and must free it.
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+int GPTLoutbuf_closemem (Outbuf *ob)
+{
+#ifndef HAVE_OPEN_MEMSTREAM
+  long pos;          /* size of the temporary file */
+#endif
+  static const char *thisfunc = "GPTLoutbuf_closemem";
+
+#ifdef HAVE_OPEN_MEMSTREAM
+  if (fclose (ob->fp) != 0) {
+    free (ob->buf);
+    ob->buf = 0;
+    ob->len = 0;
+    return GPTLerror ("%s: error formatting report\n", thisfunc);
+  }
+#else
+  if (fflush (ob->fp) != 0 || (pos = ftell (ob->fp)) < 0) {
+    (void) fclose (ob->fp);
+    return GPTLerror ("%s: error formatting report\n", thisfunc);
+  }
+  ob->len = (size_t) pos;
+  if ( ! (ob->buf = (char *) GPTLallocate (ob->len + 1, thisfunc))) {
+    (void) fclose (ob->fp);
+    ob->len = 0;
+    return -1;
+  }
+  rewind (ob->fp);
+  if (fread (ob->buf, 1, ob->len, ob->fp) != ob->len) {
+    (void) fclose (ob->fp);
+    free (ob->buf);
+    ob->buf = 0;
+    ob->len = 0;
+    return GPTLerror ("%s: error reading back report\n", thisfunc);
+  }
+  (void) fclose (ob->fp);
+#endif
+  return 0;
+}
+
+/*
+** GPTLwrite_all: write() len bytes of buf to fd, retrying short and interrupted writes
+**
+** Return value: 0 (success) or -1 (failure)
+*/
+int GPTLwrite_all (const int fd, const char *buf, size_t len)
+{
+  ssize_t nw;
+
+  while (len > 0) {
+    nw = write (fd, buf, MIN (len, (size_t) MAX_WRITE));
+    if (nw < 0) {
+      if (errno == EINTR)
+	continue;
+      return -1;
+    }
+    buf += nw;
+    len -= nw;
+  }
+  return 0;
+}
@@ -7,6 +7,11 @@
 */
  
 #include "config.h" /* Must be first include. */
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "private.h"
 #include "gptl.h"
 
@@ -14,6 +19,640 @@
 #include <mpi.h>
 
 static bool sync_mpi = false;
+static bool shared_output = false;   /* MPI_Finalize writes timing.shared, not timing.<rank> */
+static bool comm_stats = false;      /* also time and count bytes by communicator */
+static bool peer_stats = false;      /* also time and count point-to-point bytes by peer */
+static bool req_stats = false;       /* also track nonblocking requests from post to completion */
+static bool late_stats = false;      /* also estimate wait for late ranks in collectives */
+static int clock_sync = 0;           /* align clocks to rank 0: 1 at MPI_Init, 2 also at MPI_Finalize */
+
+/* Communicators seen by the wrappers, numbered in order of first use on this rank */
+typedef struct {
+  int size;                          /* number of ranks */
+  char name[MPI_MAX_OBJECT_NAME];    /* from MPI_Comm_get_name, empty if none */
+} Comminfo;
+
+/*
+** Collective calls on one communicator since its last exchange of entry times
+** (GPTLlate_stats). Every rank logs the same calls in the same order, so after LATE_MAX
+** calls, when the communicator is freed, or at MPI_Finalize, one MPI_MAX reduction of
+** the entry times gives each call's last arrival without a barrier per call.
+*/
+#define LATE_MAX 512
+
+/* Ping-pong rounds per rank to measure its clock offset from rank 0 (GPTLclock_sync) */
+#define CLOCK_NPING 10
+
+typedef struct {
+  int n;                     /* calls logged */
+  int slot[LATE_MAX];        /* slot of each call, -1 if it was not timed */
+  double entry[LATE_MAX];    /* entry time, on the shared clock once flushed */
+  double time[LATE_MAX];     /* time in the call */
+} Latelog;
+
+/* Attribute cached on each communicator seen, so it is numbered only once */
+typedef struct Commattr {
+  int idx;            /* index into comminfo and Pmpithread.comm, COMM_MAX for all later ones */
+  bool inter;         /* intercommunicator: peer ranks are in the remote group */
+  MPI_Group group;    /* to translate peer ranks to MPI_COMM_WORLD, or MPI_GROUP_NULL if the same */
+  MPI_Comm comm;      /* the communicator, for flushing late at MPI_Finalize */
+  Latelog *late;      /* allocated on first collective if GPTLlate_stats is set */
+  struct Commattr *nextlate;   /* list of communicators with a Latelog */
+} Commattr;
+
+static Comminfo comminfo[COMM_MAX];
+static int ncomm = 0;                          /* communicators seen, including beyond COMM_MAX */
+static int keyval = MPI_KEYVAL_INVALID;        /* of the Commattr attribute */
+static MPI_Group worldgroup = MPI_GROUP_NULL;
+
+static Commattr *latelist = NULL;              /* communicators with a Latelog */
+static double clockoffset = 0.;                /* shared clock minus own clock at clockwhen */
+static double clockdrift = 0.;                 /* rate of change of clockoffset */
+static double clockwhen = 0.;                  /* own time at which clockoffset applies */
+static double clockerr = 0.;                   /* bound on the error of clockoffset */
+static int clocksynced = 0;                    /* 1: offset measured, 2: and drift */
+static unsigned long latecount[NSLOT];         /* collective calls with a wait estimate */
+static double latetime[NSLOT];                 /* their time */
+static double latewait[NSLOT];                 /* their estimated wait for the last rank */
+
+/* Timer name of each slot, from the same tables as the slot enum in private.h */
+#define PMPI_NAME(r) "MPI_" #r,
+#define PMPI_SYNC_NAME(r) "sync_" #r,
+static const char *slotname[NSLOT] = {
+  PMPI_ROUTINES (PMPI_NAME)
+  PMPI_SYNC_ROUTINES (PMPI_SYNC_NAME)
+};
+#undef PMPI_NAME
+#undef PMPI_SYNC_NAME
+
+static Commattr *get_commattr (MPI_Comm);
+static int delete_commattr (MPI_Comm, int, void *, void *);
+static void late_flush (Commattr *);
+static void late_flush_all (void);
+
+/*
+** typesize: size of datatype in bytes. Sizes of predefined types are cached in the
+**   thread's table, so the common case is a compare instead of PMPI_Type_size. Derived
+**   types are looked up every time: a freed handle may be reused by a type of another
+**   size, whereas predefined handles are never freed and derived ones never become
+**   predefined, so a cached "derived" entry stays correct.
+**
+** Input arguments:
+**   datatype: MPI datatype
+**
+** Input/output arguments:
+**   pt: per-thread state from GPTLstart_slot, holding the cache
+*/
+static inline int typesize (Pmpithread *pt, MPI_Datatype datatype)
+{
+  uintptr_t key = (uintptr_t) datatype;
+  int i = (int) ((key ^ (key >> 5) ^ (key >> 11)) & (PMPI_NTYPE-1));
+  int size = 0;
+  int ni, na, nd, combiner;   /* from PMPI_Type_get_envelope */
+
+  if (datatype == MPI_DATATYPE_NULL)
+    return 0;
+
+  if (pt->type[i] != key || key == 0) {
+    pt->type[i] = key;
+    pt->typesize[i] = -1;
+    if (PMPI_Type_get_envelope (datatype, &ni, &na, &nd, &combiner) == MPI_SUCCESS &&
+	combiner == MPI_COMBINER_NAMED && PMPI_Type_size (datatype, &size) == MPI_SUCCESS)
+      pt->typesize[i] = size;
+  }
+  if (pt->typesize[i] >= 0)
+    return pt->typesize[i];
+
+  (void) PMPI_Type_size (datatype, &size);
+  return size;
+}
+
+/*
+** comm_add: Add the call just timed by timer to the thread's stats of its communicator
+**   if GPTLcomm_stats is set
+**
+** Input arguments:
+**   slot:  slot of the routine
+**   comm:  communicator of the call
+**   timer: timer of the routine, just stopped
+**   bytes: bytes of the call, as added to timer->nbytes
+**
+** Input/output arguments:
+**   pt: per-thread state from GPTLstart_slot
+*/
+static inline void comm_add (Pmpithread *pt, const int slot, MPI_Comm comm, const Timer *timer,
+			     const double bytes)
+{
+  Commattr *attr;
+
+  if ( ! comm_stats || ! (attr = get_commattr (comm)))
+    return;
+
+  if ( ! pt->comm && ! (pt->comm = (Commstats *) calloc (COMM_MAX+1, sizeof (Commstats))))
+    return;
+
+  ++pt->comm[attr->idx].count[slot];
+  pt->comm[attr->idx].time[slot] += timer->wall.latest;
+  pt->comm[attr->idx].bytes[slot] += bytes;
+}
+
+/*
+** peer_add: Add a point-to-point call just timed by timer to the thread's stats of the
+**   peer if GPTLpeer_stats is set. Peers are hashed by MPI_COMM_WORLD rank into a table of
+**   PEER_MAX entries, so storage is bounded however many ranks the job has. Once the table
+**   is 3/4 full, new peers are lumped into one extra entry.
+**
+** Input arguments:
+**   comm:  communicator of the call
+**   rank:  peer rank in comm. Negative values (MPI_PROC_NULL, MPI_ANY_SOURCE) are skipped
+**   send:  true for a send to the peer, false for a receive from it
+**   bytes: bytes sent or received
+**   timer: timer of the routine, just stopped
+**
+** Input/output arguments:
+**   pt: per-thread state from GPTLstart_slot
+*/
+static inline void peer_add (Pmpithread *pt, MPI_Comm comm, int rank, const bool send,
+			     const double bytes, const Timer *timer)
+{
+  Commattr *attr;
+  Peerstats *peer;
+  int wrank;          /* MPI_COMM_WORLD rank of the peer */
+  unsigned int h;     /* hash table index */
+
+  if ( ! peer_stats || rank < 0 || ! (attr = get_commattr (comm)) || attr->inter)
+    return;
+
+  wrank = rank;
+  if (attr->group != MPI_GROUP_NULL &&
+      (PMPI_Group_translate_ranks (attr->group, 1, &rank, worldgroup, &wrank) != MPI_SUCCESS ||
+       wrank == MPI_UNDEFINED))
+    return;
+
+  if ( ! pt->peer && ! (pt->peer = (Peerstats *) calloc (PEER_MAX+1, sizeof (Peerstats))))
+    return;
+
+  for (h = ((unsigned int) wrank * 2654435761u) & (PEER_MAX-1);
+       pt->peer[h].rank1 != 0 && pt->peer[h].rank1 != wrank+1;
+       h = (h + 1) & (PEER_MAX-1))
+    ;
+  peer = &pt->peer[h];
+  if (peer->rank1 == 0) {
+    if (pt->npeer < 3 * PEER_MAX / 4) {
+      peer->rank1 = wrank + 1;
+      ++pt->npeer;
+    } else {
+      peer = &pt->peer[PEER_MAX];
+    }
+  }
+
+  if (send) {
+    ++peer->nsend;
+    peer->sendbytes += bytes;
+    peer->sendtime  += timer->wall.latest;
+  } else {
+    ++peer->nrecv;
+    peer->recvbytes += bytes;
+    peer->recvtime  += timer->wall.latest;
+  }
+}
+
+/*
+** sumcounts: bytes in the blocks of a vector collective
+**
+** Input arguments:
+**   counts: element count of each block
+**   n:      number of blocks
+**   skip:   block not counted (the caller's own), or -1 to count all
+**   size:   bytes per element
+*/
+static inline double sumcounts (const int *counts, const int n, const int skip, const int size)
+{
+  double sum = 0.;
+  int i;
+
+  for (i = 0; i < n; ++i)
+    if (i != skip)
+      sum += (double) counts[i];
+  return sum * size;
+}
+
+/*
+** neighbors: number of neighbors of the process topology attached to comm, as used by
+**   the neighborhood collectives. A Cartesian topology has 2 per dimension.
+**
+** Input arguments:
+**   comm: communicator
+**
+** Output arguments:
+**   indegree:  number of ranks received from
+**   outdegree: number of ranks sent to
+*/
+static void neighbors (MPI_Comm comm, int *indegree, int *outdegree)
+{
+  int status;
+  int iam;
+  int weighted;
+
+  *indegree = 0;
+  *outdegree = 0;
+  if (PMPI_Topo_test (comm, &status) != MPI_SUCCESS)
+    return;
+  if (status == MPI_CART) {
+    (void) PMPI_Cartdim_get (comm, indegree);
+    *indegree *= 2;
+    *outdegree = *indegree;
+  } else if (status == MPI_GRAPH) {
+    (void) PMPI_Comm_rank (comm, &iam);
+    (void) PMPI_Graph_neighbors_count (comm, iam, indegree);
+    *outdegree = *indegree;
+  } else if (status == MPI_DIST_GRAPH) {
+    (void) PMPI_Dist_graph_neighbors_count (comm, indegree, outdegree, &weighted);
+  }
+}
+
+/* Home index of a request handle in the table of requests in flight */
+static inline unsigned int req_hash (const uintptr_t key)
+{
+  return (unsigned int) ((key ^ (key >> 7) ^ (key >> 17)) * 2654435761u) & (REQ_MAX-1);
+}
+
+/*
+** req_find: index of request handle key in the thread's table of requests in flight
+**
+** Return value: index, or -1 if the request is not tracked
+*/
+static inline int req_find (const Pmpithread *pt, const uintptr_t key)
+{
+  unsigned int h;
+
+  for (h = req_hash (key); pt->req[h].req != 0; h = (h + 1) & (REQ_MAX-1))
+    if (pt->req[h].req == key)
+      return (int) h;
+  return -1;
+}
+
+/*
+** req_post: Start tracking a nonblocking request just posted, if GPTLreq_stats is set.
+**   Requests are hashed by handle into a table of REQ_MAX entries. Once it is 3/4 full,
+**   new requests are only counted as untracked.
+**
+** Input arguments:
+**   slot:    slot of the posting routine
+**   timer:   timer of the posting routine, just stopped
+**   request: the new request
+**
+** Input/output arguments:
+**   pt: per-thread state from GPTLstart_slot
+*/
+static inline void req_post (Pmpithread *pt, const int slot, const Timer *timer,
+			     MPI_Request request)
+{
+  uintptr_t key = (uintptr_t) request;
+  unsigned int h;
+
+  if ( ! req_stats || request == MPI_REQUEST_NULL)
+    return;
+
+  if ( ! pt->req) {
+    if ( ! (pt->reqstats = (Reqstats *) calloc (1, sizeof (Reqstats))))
+      return;
+    if ( ! (pt->req = (Reqinfo *) calloc (REQ_MAX, sizeof (Reqinfo)))) {
+      free (pt->reqstats);
+      pt->reqstats = NULL;
+      return;
+    }
+  }
+
+  /*
+  ** A handle already in the table belongs to a request completed or freed outside the
+  ** wrappers, whose handle MPI has reused: replace it
+  */
+  for (h = req_hash (key); pt->req[h].req != 0 && pt->req[h].req != key;
+       h = (h + 1) & (REQ_MAX-1))
+    ;
+  if (pt->req[h].req == 0) {
+    if (pt->nreq >= 3 * REQ_MAX / 4) {
+      ++pt->untracked;
+      return;
+    }
+    ++pt->nreq;
+  }
+  pt->req[h].req     = key;
+  pt->req[h].slot    = slot;
+  pt->req[h].post    = timer->wall.last + timer->wall.latest;
+  pt->req[h].blocked = 0.;
+}
+
+/*
+** req_keys: Copy request handles before a wait or test call, which may set completed
+**   ones to MPI_REQUEST_NULL
+**
+** Input arguments:
+**   n:        number of requests
+**   requests: request handles
+**
+** Input/output arguments:
+**   pt: per-thread state from GPTLstart_slot, holding the copy
+**
+** Return value: the copy, or NULL if requests are not tracked
+*/
+static uintptr_t *req_keys (Pmpithread *pt, const int n, const MPI_Request *requests)
+{
+  uintptr_t *reqkey;
+  int i;
+
+  if ( ! req_stats || ! pt || ! pt->req || n < 1)
+    return NULL;
+
+  if (n > pt->maxreqkey) {
+    if ( ! (reqkey = (uintptr_t *) realloc (pt->reqkey, n * sizeof (uintptr_t))))
+      return NULL;
+    pt->reqkey = reqkey;
+    pt->maxreqkey = n;
+  }
+  for (i = 0; i < n; ++i)
+    pt->reqkey[i] = (uintptr_t) requests[i];
+  return pt->reqkey;
+}
+
+/*
+** req_wait: Charge a wait or test call just timed by timer evenly to the tracked
+**   requests it was given, and move those it completed from the table to the stats of
+**   their posting routine
+**
+** Input arguments:
+**   timer: timer of the wait or test routine, just stopped
+**   n:     number of requests given to the call
+**   keys:  their handles from before the call (from req_keys)
+**   ndone: number of requests completed
+**   done:  indices into keys of the completed requests, or NULL for the first ndone
+**
+** Input/output arguments:
+**   pt: per-thread state from GPTLstart_slot
+*/
+static void req_wait (Pmpithread *pt, const Timer *timer, const int n, const uintptr_t *keys,
+		      const int ndone, const int *done)
+{
+  int ntracked = 0;   /* tracked requests among keys */
+  double share;       /* of the call's time per tracked request */
+  double now;         /* end of the call */
+  unsigned int h, e, home;
+  int i, idx;
+  Reqinfo *r;
+
+  if ( ! timer || ! keys)
+    return;
+
+  for (i = 0; i < n; ++i)
+    if (keys[i] != 0 && req_find (pt, keys[i]) >= 0)
+      ++ntracked;
+  if (ntracked == 0)
+    return;
+
+  share = timer->wall.latest / ntracked;
+  for (i = 0; i < n; ++i)
+    if (keys[i] != 0 && (idx = req_find (pt, keys[i])) >= 0)
+      pt->req[idx].blocked += share;
+
+  now = timer->wall.last + timer->wall.latest;
+  for (i = 0; i < ndone; ++i) {
+    if (keys[done ? done[i] : i] == 0 || (idx = req_find (pt, keys[done ? done[i] : i])) < 0)
+      continue;
+    r = &pt->req[idx];
+    ++pt->reqstats->count[r->slot];
+    pt->reqstats->inflight[r->slot] += now - r->post;
+    pt->reqstats->blocked[r->slot]  += r->blocked;
+
+    /* Delete by shifting back later entries of the probe sequence, so lookups stay exact */
+    h = (unsigned int) idx;
+    for (e = (h + 1) & (REQ_MAX-1); pt->req[e].req != 0; e = (e + 1) & (REQ_MAX-1)) {
+      home = req_hash (pt->req[e].req);
+      /* Entry e may move to the hole at h unless its home lies cyclically in (h, e] */
+      if (((e - home) & (REQ_MAX-1)) >= ((e - h) & (REQ_MAX-1))) {
+	pt->req[h] = pt->req[e];
+	h = e;
+      }
+    }
+    memset (&pt->req[h], 0, sizeof (Reqinfo));
+    --pt->nreq;
+  }
+}
+
+/*
+** clock_ping: Estimate the offset of each rank's clock from rank 0's by ping-pong
+**   (Cristian's algorithm). Rank 0 exchanges CLOCK_NPING messages with each rank in
+**   turn and keeps the round trip which took least time, assuming it was symmetric.
+**   Collective over MPI_COMM_WORLD, on a duplicate so no user message can match.
+**   Every message of the exchange is sent even after a failure, with the result flagged,
+**   so no rank is left waiting, and all ranks agree on whether the clocks were aligned.
+**
+** Output arguments:
+**   offset: rank 0 time minus own time, 0 on rank 0
+**   when:   own time at which offset was measured
+**   err:    bound on the error of offset: half the best round trip, 0 on rank 0
+**
+** Return value: 0 (success on all ranks) or -1 (failure)
+*/
+static int clock_ping (double *offset, double *when, double *err)
+{
+  MPI_Comm comm;
+  int iam, nranks;
+  int r, k;
+  int ok;           /* this round trip went through */
+  int ret = 0;      /* 0 if every exchange of this rank succeeded */
+  int allret;       /* max of ret over all ranks */
+  double t0, t1;    /* send and receive time on rank 0 */
+  double remote;    /* receive time on the other rank */
+  double best[4];   /* offset, remote time and half round trip of the best round, error flag */
+
+  *offset = 0.;
+  *when = GPTLtime_now ();
+  *err = 0.;
+  if (PMPI_Comm_dup (MPI_COMM_WORLD, &comm) != MPI_SUCCESS)
+    return -1;
+  if (PMPI_Comm_rank (comm, &iam) != MPI_SUCCESS ||
+      PMPI_Comm_size (comm, &nranks) != MPI_SUCCESS) {
+    (void) PMPI_Comm_free (&comm);
+    return -1;
+  }
+
+  if (iam == 0) {
+    for (r = 1; r < nranks; ++r) {
+      best[2] = DBL_MAX;
+      best[3] = 0.;
+      for (k = 0; k < CLOCK_NPING; ++k) {
+	t0 = GPTLtime_now ();
+	ok = (PMPI_Send (NULL, 0, MPI_DOUBLE, r, k, comm) == MPI_SUCCESS);
+	ok = (PMPI_Recv (&remote, 1, MPI_DOUBLE, r, k, comm, MPI_STATUS_IGNORE) == MPI_SUCCESS) && ok;
+	t1 = GPTLtime_now ();
+	if ( ! ok)
+	  best[3] = 1.;
+	else if (0.5 * (t1 - t0) < best[2]) {
+	  best[0] = 0.5 * (t0 + t1) - remote;
+	  best[1] = remote;
+	  best[2] = 0.5 * (t1 - t0);
+	}
+      }
+      if (best[3] != 0.)
+	ret = -1;
+      if (PMPI_Send (best, 4, MPI_DOUBLE, r, CLOCK_NPING, comm) != MPI_SUCCESS)
+	ret = -1;
+    }
+  } else {
+    for (k = 0; k < CLOCK_NPING; ++k) {
+      if (PMPI_Recv (NULL, 0, MPI_DOUBLE, 0, k, comm, MPI_STATUS_IGNORE) != MPI_SUCCESS)
+	ret = -1;
+      remote = GPTLtime_now ();
+      if (PMPI_Send (&remote, 1, MPI_DOUBLE, 0, k, comm) != MPI_SUCCESS)
+	ret = -1;
+    }
+    if (PMPI_Recv (best, 4, MPI_DOUBLE, 0, CLOCK_NPING, comm, MPI_STATUS_IGNORE) != MPI_SUCCESS ||
+	best[3] != 0.)
+      ret = -1;
+  }
+
+  /* Agree on the outcome before anyone uses it */
+  if (PMPI_Allreduce (&ret, &allret, 1, MPI_INT, MPI_MAX, comm) != MPI_SUCCESS)
+    allret = -1;
+  if (allret == 0 && iam != 0) {
+    *offset = best[0];
+    *when = best[1];
+    *err = best[2];
+  }
+  (void) PMPI_Comm_free (&comm);
+  return (allret == 0) ? 0 : -1;
+}
+
+/*
+** clock_init: Put the timestamps of all ranks on a shared clock. With GPTLclock_sync,
+**   measure the offset from rank 0's clock. Otherwise, for GPTLlate_stats only, shift
+**   each rank's timer origin to the earliest one. Called from MPI_Init.
+*/
+static void clock_init (void)
+{
+  double origin;
+  double base;
+
+  if (clock_sync) {
+    if (clock_ping (&clockoffset, &clockwhen, &clockerr) == 0)
+      clocksynced = 1;
+    else
+      GPTLwarn ("clock_init: ping-pong with rank 0 failed. Clocks are not aligned\n");
+    return;
+  }
+  if ( ! late_stats)
+    return;
+
+  origin = GPTLtime_origin ();
+  if (PMPI_Allreduce (&origin, &base, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD) == MPI_SUCCESS)
+    clockoffset = origin - base;
+}
+
+/*
+** clock_drift: With GPTLclock_sync = 2, measure the offset from rank 0's clock again and
+**   fit the drift between the two measurements. Called from MPI_Finalize.
+*/
+static void clock_drift (void)
+{
+  double offset, when, err;
+
+  if (clock_sync < 2 || clocksynced != 1)
+    return;
+
+  if (clock_ping (&offset, &when, &err) != 0) {
+    GPTLwarn ("clock_drift: ping-pong with rank 0 failed. Drift is not estimated\n");
+    return;
+  }
+  if (when > clockwhen) {
+    clockdrift = (offset - clockoffset) / (when - clockwhen);
+    clockoffset -= clockdrift * clockwhen;
+    clockwhen = 0.;
+    clockerr = MAX (clockerr, err);
+    clocksynced = 2;
+  }
+}
+
+/* Convert a timestamp of this rank to the clock shared by all ranks */
+static inline double globaltime (const double t)
+{
+  return t + clockoffset + clockdrift * (t - clockwhen);
+}
+
+/*
+** late_add: Log a collective call just made on comm if GPTLlate_stats is set. Must be
+**   called for every call, timed or not, so that all ranks log the same calls.
+**
+** Input arguments:
+**   slot:  slot of the routine
+**   comm:  communicator of the call
+**   timer: timer of the routine, just stopped, or NULL if the call was not timed
+*/
+static inline void late_add (const int slot, MPI_Comm comm, const Timer *timer)
+{
+  Commattr *attr;
+  Latelog *log;
+
+  if ( ! late_stats || ! (attr = get_commattr (comm)) || attr->inter)
+    return;
+
+  if ( ! (log = attr->late)) {
+    if ( ! (log = attr->late = (Latelog *) calloc (1, sizeof (Latelog))))
+      return;
+    attr->comm = comm;
+    attr->nextlate = latelist;
+    latelist = attr;
+  }
+
+  if (timer) {
+    log->slot[log->n]  = slot;
+    log->entry[log->n] = timer->wall.last;
+    log->time[log->n]  = timer->wall.latest;
+  } else {
+    log->slot[log->n]  = -1;
+    log->entry[log->n] = -1.e300;   /* neutral for MPI_MAX */
+    log->time[log->n]  = 0.;
+  }
+  if (++log->n == LATE_MAX)
+    late_flush (attr);
+}
+
+/* Put the entry times of the logged calls on the shared clock, just before exchanging them */
+static void late_globaltime (Latelog *log)
+{
+  int i;
+
+  for (i = 0; i < log->n; ++i)
+    if (log->slot[i] >= 0)
+      log->entry[i] = globaltime (log->entry[i]);
+}
+
+/*
+** late_tally: Add the wait estimates of the logged calls to the stats of their routines,
+**   and empty the log. A call waited from its entry until the last rank entered, but not
+**   longer than it took.
+**
+** Input arguments:
+**   last: latest entry time over all ranks of each logged call
+**
+** Input/output arguments:
+**   log: calls logged on a communicator
+*/
+static void late_tally (Latelog *log, const double *last)
+{
+  double wait;
+  int i;
+
+  for (i = 0; i < log->n; ++i) {
+    if (log->slot[i] < 0)
+      continue;
+    wait = MIN (MAX (last[i] - log->entry[i], 0.), log->time[i]);
+    ++latecount[log->slot[i]];
+    latetime[log->slot[i]] += log->time[i];
+    latewait[log->slot[i]] += wait;
+  }
+  log->n = 0;
+}
 
 int GPTLpmpi_setoption (const int option,
 			const int val)
@@ -25,6 +664,35 @@ int GPTLpmpi_setoption (const int option,
     sync_mpi = (bool) val;
     retval = 0;
     break;
+  case GPTLshared_output:
+#ifndef HAVE_LIBMPI
+    if (val)
+      GPTLwarn ("GPTLpmpi_setoption: GPTLshared_output needs GPTL built with HAVE_LIBMPI. "
+		"Writing one file per rank\n");
+#endif
+    shared_output = (bool) val;
+    retval = 0;
+    break;
+  case GPTLcomm_stats:
+    comm_stats = (bool) val;
+    retval = 0;
+    break;
+  case GPTLpeer_stats:
+    peer_stats = (bool) val;
+    retval = 0;
+    break;
+  case GPTLreq_stats:
+    req_stats = (bool) val;
+    retval = 0;
+    break;
+  case GPTLlate_stats:
+    late_stats = (bool) val;
+    retval = 0;
+    break;
+  case GPTLclock_sync:
+    clock_sync = val;
+    retval = 0;
+    break;
   default:
     retval = 1;
   }
@@ -43,6 +711,7 @@ int MPI_Init (int *argc, char ***argv)
   ret = PMPI_Init (argc, argv);
   if ( ! GPTLis_initialized ())
     ignoreret = GPTLinitialize ();
+  clock_init ();
 
   ignoreret = GPTLstart ("MPI_Init_thru_Finalize");
 
@@ -57,6 +726,7 @@ int MPI_Init_thread (int *argc, char ***argv, int required, int *provided)
   ret = PMPI_Init_thread (argc, argv, required, provided);
   if ( ! GPTLis_initialized ())
     ignoreret = GPTLinitialize ();
+  clock_init ();
   
   ignoreret = GPTLstart ("MPI_Init_thru_Finalize");
   
@@ -68,15 +738,19 @@ int MPI_Send (const void *buf, int count, MPI_Datatype datatype, int dest, int t
 {
   int ret;
   int size;
-  int ignoreret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Send");
+  pt = GPTLstart_slot ("MPI_Send", SLOT_Send);
   ret = PMPI_Send (buf, count, datatype, dest, tag, comm);
-  ignoreret = GPTLstop ("MPI_Send");
-  if ((timer = GPTLgetentry ("MPI_Send"))) {
-    ignoreret = PMPI_Type_size (datatype, &size);
-    timer->nbytes += ((double) count) * size;
+  if ((timer = GPTLstop_slot (pt, SLOT_Send))) {
+    size = typesize (pt, datatype);
+    bytes = ((double) count) * size;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Send, comm, timer, bytes);
+    peer_add (pt, comm, dest, true, bytes, timer);
   }
   return ret;
 }
@@ -87,21 +761,29 @@ int MPI_Recv (void *buf, int count, MPI_Datatype datatype, int source, int tag,
   int ret;
   int ignoreret;
   int size;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Recv");
+    pt = GPTLstart_slot ("sync_Recv", SLOT_sync_Recv);
     /* Ignore status */
     ignoreret = PMPI_Probe (source, tag, comm, status);
-    ignoreret = GPTLstop ("sync_Recv");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Recv)))
+      comm_add (pt, SLOT_sync_Recv, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Recv");
+  pt = GPTLstart_slot ("MPI_Recv", SLOT_Recv);
   ret = PMPI_Recv (buf, count, datatype, source, tag, comm, status);
-  ignoreret = GPTLstop ("MPI_Recv");
-  if ((timer = GPTLgetentry ("MPI_Recv"))) {
-    ignoreret = PMPI_Type_size (datatype, &size);
-    timer->nbytes += ((double) count) * size;
+  if ((timer = GPTLstop_slot (pt, SLOT_Recv))) {
+    size = typesize (pt, datatype);
+    bytes = ((double) count) * size;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Recv, comm, timer, bytes);
+    if (source == MPI_ANY_SOURCE && status != MPI_STATUS_IGNORE)
+      source = status->MPI_SOURCE;
+    peer_add (pt, comm, source, false, bytes, timer);
   }
   return ret;
 }
@@ -111,19 +793,26 @@ int MPI_Sendrecv (const void *sendbuf, int sendcount, MPI_Datatype sendtype, int
 		  MPI_Comm comm, MPI_Status *status )
 {
   int ret;
-  int ignoreret;
   int sendsize, recvsize;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Sendrecv");
+  pt = GPTLstart_slot ("MPI_Sendrecv", SLOT_Sendrecv);
   ret = PMPI_Sendrecv (sendbuf, sendcount, sendtype, dest, sendtag, 
 		       recvbuf, recvcount, recvtype, source, recvtag, comm, status);
-  ignoreret = GPTLstop ("MPI_Sendrecv");
-  if ((timer = GPTLgetentry ("MPI_Sendrecv"))) {
-    ignoreret = PMPI_Type_size (sendtype, &sendsize);
-    ignoreret = PMPI_Type_size (recvtype, &recvsize);
-
-    timer->nbytes += ((double) recvcount * recvsize) + ((double) sendcount * sendsize);
+  if ((timer = GPTLstop_slot (pt, SLOT_Sendrecv))) {
+    sendsize = typesize (pt, sendtype);
+    recvsize = typesize (pt, recvtype);
+
+    bytes = ((double) recvcount * recvsize) + ((double) sendcount * sendsize);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, MAX ((double) sendcount * sendsize, (double) recvcount * recvsize));
+    comm_add (pt, SLOT_Sendrecv, comm, timer, bytes);
+    peer_add (pt, comm, dest, true, (double) sendcount * sendsize, timer);
+    if (source == MPI_ANY_SOURCE && status != MPI_STATUS_IGNORE)
+      source = status->MPI_SOURCE;
+    peer_add (pt, comm, source, false, (double) recvcount * recvsize, timer);
   }
   return ret;
 }
@@ -132,16 +821,21 @@ int MPI_Isend (const void *buf, int count, MPI_Datatype datatype, int dest, int
 	       MPI_Comm comm, MPI_Request *request)
 {
   int ret;
-  int ignoreret;
   int size;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Isend");
+  pt = GPTLstart_slot ("MPI_Isend", SLOT_Isend);
   ret = PMPI_Isend (buf, count, datatype, dest, tag, comm, request);
-  ignoreret = GPTLstop ("MPI_Isend");
-  if ((timer = GPTLgetentry ("MPI_Isend"))) {
-    ignoreret = PMPI_Type_size (datatype, &size);
-    timer->nbytes += ((double) count) * size;
+  if ((timer = GPTLstop_slot (pt, SLOT_Isend))) {
+    size = typesize (pt, datatype);
+    bytes = ((double) count) * size;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Isend, comm, timer, bytes);
+    peer_add (pt, comm, dest, true, bytes, timer);
+    req_post (pt, SLOT_Isend, timer, *request);
   }
   return ret;
 }
@@ -150,16 +844,21 @@ int MPI_Issend (const void *buf, int count, MPI_Datatype datatype, int dest, int
 		MPI_Comm comm, MPI_Request *request)
 {
   int ret;
-  int ignoreret;
   int size;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Issend");
+  pt = GPTLstart_slot ("MPI_Issend", SLOT_Issend);
   ret = PMPI_Issend (buf, count, datatype, dest, tag, comm, request);
-  ignoreret = GPTLstop ("MPI_Issend");
-  if ((timer = GPTLgetentry ("MPI_Issend"))) {
-    ignoreret = PMPI_Type_size (datatype, &size);
-    timer->nbytes += ((double) count) * size;
+  if ((timer = GPTLstop_slot (pt, SLOT_Issend))) {
+    size = typesize (pt, datatype);
+    bytes = ((double) count) * size;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Issend, comm, timer, bytes);
+    peer_add (pt, comm, dest, true, bytes, timer);
+    req_post (pt, SLOT_Issend, timer, *request);
   }
   return ret;
 }
@@ -168,16 +867,21 @@ int MPI_Irecv (void *buf, int count, MPI_Datatype datatype, int source, int tag,
 	      MPI_Comm comm, MPI_Request *request)
 {
   int ret;
-  int ignoreret;
   int size;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Irecv");
+  pt = GPTLstart_slot ("MPI_Irecv", SLOT_Irecv);
   ret = PMPI_Irecv (buf, count, datatype, source, tag, comm, request);
-  ignoreret = GPTLstop ("MPI_Irecv");
-  if ((timer = GPTLgetentry ("MPI_Irecv"))) {
-    ignoreret = PMPI_Type_size (datatype, &size);
-    timer->nbytes += ((double) count) * size;
+  if ((timer = GPTLstop_slot (pt, SLOT_Irecv))) {
+    size = typesize (pt, datatype);
+    bytes = ((double) count) * size;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Irecv, comm, timer, bytes);
+    peer_add (pt, comm, source, false, bytes, timer);
+    req_post (pt, SLOT_Irecv, timer, *request);
   }
   return ret;
 }
@@ -185,11 +889,15 @@ int MPI_Irecv (void *buf, int count, MPI_Datatype datatype, int source, int tag,
 int MPI_Wait (MPI_Request *request, MPI_Status *status)
 {
   int ret;
-  int ignoreret;
+  uintptr_t *keys;
+  Pmpithread *pt;
+  Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Wait");
+  pt = GPTLstart_slot ("MPI_Wait", SLOT_Wait);
+  keys = req_keys (pt, 1, request);
   ret = PMPI_Wait (request, status);
-  ignoreret = GPTLstop ("MPI_Wait");
+  if ((timer = GPTLstop_slot (pt, SLOT_Wait)) && ret == MPI_SUCCESS)
+    req_wait (pt, timer, 1, keys, 1, NULL);
   return ret;
 }
 
@@ -198,22 +906,29 @@ int MPI_Waitall(int count,
 		MPI_Status array_of_statuses[])
 {
   int ret;
-  int ignoreret;
+  uintptr_t *keys;
+  Pmpithread *pt;
+  Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Waitall");
+  pt = GPTLstart_slot ("MPI_Waitall", SLOT_Waitall);
+  keys = req_keys (pt, count, array_of_requests);
   ret = PMPI_Waitall (count, array_of_requests, array_of_statuses);
-  ignoreret = GPTLstop ("MPI_Waitall");
+  if ((timer = GPTLstop_slot (pt, SLOT_Waitall)) && ret == MPI_SUCCESS)
+    req_wait (pt, timer, count, keys, count, NULL);
   return ret;
 }
 
 int MPI_Barrier (MPI_Comm comm)
 {
   int ret;
-  int ignoreret;
+  Pmpithread *pt;
+  Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Barrier");
+  pt = GPTLstart_slot ("MPI_Barrier", SLOT_Barrier);
   ret = PMPI_Barrier (comm);
-  ignoreret = GPTLstop ("MPI_Barrier");
+  if ((timer = GPTLstop_slot (pt, SLOT_Barrier)))
+    comm_add (pt, SLOT_Barrier, comm, timer, 0.);
+  late_add (SLOT_Barrier, comm, timer);
   return ret;
 }
 
@@ -223,21 +938,27 @@ int MPI_Bcast (void *buffer, int count, MPI_Datatype datatype, int root,
   int ret;
   int ignoreret;
   int size;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Bcast");
+    pt = GPTLstart_slot ("sync_Bcast", SLOT_sync_Bcast);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Bcast");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Bcast)))
+      comm_add (pt, SLOT_sync_Bcast, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Bcast");
+  pt = GPTLstart_slot ("MPI_Bcast", SLOT_Bcast);
   ret = PMPI_Bcast (buffer, count, datatype, root, comm);
-  ignoreret = GPTLstop ("MPI_Bcast");
-  if ((timer = GPTLgetentry ("MPI_Bcast"))) {
-    ignoreret = PMPI_Type_size (datatype, &size);
-    timer->nbytes += ((double) count) * size;
+  if ((timer = GPTLstop_slot (pt, SLOT_Bcast))) {
+    size = typesize (pt, datatype);
+    bytes = ((double) count) * size;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Bcast, comm, timer, bytes);
   }
+  late_add (SLOT_Bcast, comm, timer);
   return ret;
 }
 
@@ -247,22 +968,28 @@ int MPI_Allreduce (const void *sendbuf, void *recvbuf, int count, MPI_Datatype d
   int ret;
   int ignoreret;
   int size;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Allreduce");
+    pt = GPTLstart_slot ("sync_Allreduce", SLOT_sync_Allreduce);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Allreduce");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Allreduce)))
+      comm_add (pt, SLOT_sync_Allreduce, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Allreduce");
+  pt = GPTLstart_slot ("MPI_Allreduce", SLOT_Allreduce);
   ret = PMPI_Allreduce (sendbuf, recvbuf, count, datatype, op, comm);
-  ignoreret = GPTLstop ("MPI_Allreduce");
-  if ((timer = GPTLgetentry ("MPI_Allreduce"))) {
-    ignoreret = PMPI_Type_size (datatype, &size);
+  if ((timer = GPTLstop_slot (pt, SLOT_Allreduce))) {
+    size = typesize (pt, datatype);
     /* Estimate size as 1 send plus 1 recv */
-    timer->nbytes += 2.*((double) count) * size;
+    bytes = 2.*((double) count) * size;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, ((double) count) * size);
+    comm_add (pt, SLOT_Allreduce, comm, timer, bytes);
   }
+  late_add (SLOT_Allreduce, comm, timer);
   return ret;
 }
 
@@ -275,29 +1002,34 @@ int MPI_Gather (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
   int sendsize, recvsize;
   int commsize;
   int ignoreret;
+  double bytes = 0.;     /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Gather");
+    pt = GPTLstart_slot ("sync_Gather", SLOT_sync_Gather);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Gather");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Gather)))
+      comm_add (pt, SLOT_sync_Gather, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Gather");
+  pt = GPTLstart_slot ("MPI_Gather", SLOT_Gather);
   ret = PMPI_Gather (sendbuf, sendcount, sendtype, 
 		     recvbuf, recvcount, recvtype, root, comm);
-  ignoreret = GPTLstop ("MPI_Gather");
-
-  if ((timer = GPTLgetentry ("MPI_Gather"))) {
+  if ((timer = GPTLstop_slot (pt, SLOT_Gather))) {
     ignoreret = PMPI_Comm_rank (comm, &iam);
     ignoreret = PMPI_Comm_size (comm, &commsize);
-    ignoreret = PMPI_Type_size (sendtype, &sendsize);
-    ignoreret = PMPI_Type_size (recvtype, &recvsize);
-    timer->nbytes += (double) sendcount * sendsize;
+    sendsize = typesize (pt, sendtype);
+    recvsize = typesize (pt, recvtype);
+    bytes += (double) sendcount * sendsize;
     if (iam == root) {
-      timer->nbytes += (double) recvcount * recvsize * (commsize-1);
+      bytes += (double) recvcount * recvsize * (commsize-1);
     }
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, (double) sendcount * sendsize);
+    comm_add (pt, SLOT_Gather, comm, timer, bytes);
   }
+  late_add (SLOT_Gather, comm, timer);
   return ret;
 }
 
@@ -311,33 +1043,38 @@ int MPI_Gatherv (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
   int sendsize, recvsize;
   int commsize;
   int ignoreret;
+  double bytes = 0.;     /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Gatherv");
+    pt = GPTLstart_slot ("sync_Gatherv", SLOT_sync_Gatherv);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Gatherv");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Gatherv)))
+      comm_add (pt, SLOT_sync_Gatherv, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Gatherv");
+  pt = GPTLstart_slot ("MPI_Gatherv", SLOT_Gatherv);
   ret = PMPI_Gatherv (sendbuf, sendcount, sendtype, 
 		      recvbuf, recvcounts, displs, 
 		      recvtype, root, comm);
-  ignoreret = GPTLstop ("MPI_Gatherv");
-
-  if ((timer = GPTLgetentry ("MPI_Gatherv"))) {
+  if ((timer = GPTLstop_slot (pt, SLOT_Gatherv))) {
     ignoreret = PMPI_Comm_rank (comm, &iam);
     ignoreret = PMPI_Comm_size (comm, &commsize);
-    ignoreret = PMPI_Type_size (sendtype, &sendsize);
-    ignoreret = PMPI_Type_size (recvtype, &recvsize);
+    sendsize = typesize (pt, sendtype);
+    recvsize = typesize (pt, recvtype);
     if (iam == root) {
       for (i = 0; i < commsize; ++i)
 	if (i != iam)
-	  timer->nbytes += (double) recvcounts[i] * recvsize;
+	  bytes += (double) recvcounts[i] * recvsize;
     } else {
-      timer->nbytes += (double) sendcount * sendsize;
+      bytes += (double) sendcount * sendsize;
     }
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, (double) sendcount * sendsize);
+    comm_add (pt, SLOT_Gatherv, comm, timer, bytes);
   }
+  late_add (SLOT_Gatherv, comm, timer);
   return ret;
 }
 
@@ -349,27 +1086,33 @@ int MPI_Scatter (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
   int iam;
   int sendsize, recvsize;
   int ignoreret;
+  double bytes = 0.;     /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Scatter");
+    pt = GPTLstart_slot ("sync_Scatter", SLOT_sync_Scatter);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Scatter");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Scatter)))
+      comm_add (pt, SLOT_sync_Scatter, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Scatter");
+  pt = GPTLstart_slot ("MPI_Scatter", SLOT_Scatter);
   ret = PMPI_Scatter (sendbuf, sendcount, sendtype, 
 		      recvbuf, recvcount, recvtype, root, comm);
-  ignoreret = GPTLstop ("MPI_Scatter");
-  if ((timer = GPTLgetentry ("MPI_Scatter"))) {
+  if ((timer = GPTLstop_slot (pt, SLOT_Scatter))) {
     ignoreret = PMPI_Comm_rank (comm, &iam);
-    ignoreret = PMPI_Type_size (recvtype, &recvsize);
-    timer->nbytes += (double) recvcount * recvsize;
+    recvsize = typesize (pt, recvtype);
+    bytes += (double) recvcount * recvsize;
     if (iam == root) {
-      ignoreret = PMPI_Type_size (sendtype, &sendsize);
-      timer->nbytes += (double) sendcount * sendsize;
+      sendsize = typesize (pt, sendtype);
+      bytes += (double) sendcount * sendsize;
     }
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, (double) recvcount * recvsize);
+    comm_add (pt, SLOT_Scatter, comm, timer, bytes);
   }
+  late_add (SLOT_Scatter, comm, timer);
   return ret;
 }
 
@@ -381,26 +1124,32 @@ int MPI_Alltoall (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
   int sendsize, recvsize;
   int commsize;
   int ignoreret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Alltoall");
+    pt = GPTLstart_slot ("sync_Alltoall", SLOT_sync_Alltoall);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Alltoall");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Alltoall)))
+      comm_add (pt, SLOT_sync_Alltoall, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Alltoall");
+  pt = GPTLstart_slot ("MPI_Alltoall", SLOT_Alltoall);
   ret = PMPI_Alltoall (sendbuf, sendcount, sendtype, 
 		       recvbuf, recvcount, recvtype, comm);
-  ignoreret = GPTLstop ("MPI_Alltoall");
-  if ((timer = GPTLgetentry ("MPI_Alltoall"))) {
+  if ((timer = GPTLstop_slot (pt, SLOT_Alltoall))) {
     ignoreret = PMPI_Comm_size (comm, &commsize);
-    ignoreret = PMPI_Type_size (sendtype, &sendsize);
-    ignoreret = PMPI_Type_size (recvtype, &recvsize);
-
-    timer->nbytes += ((double) sendcount * sendsize * (commsize-1)) + 
-                     ((double) recvcount * recvsize * (commsize-1));
+    sendsize = typesize (pt, sendtype);
+    recvsize = typesize (pt, recvtype);
+
+    bytes = ((double) sendcount * sendsize * (commsize-1)) + 
+            ((double) recvcount * recvsize * (commsize-1));
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, (double) sendcount * sendsize);
+    comm_add (pt, SLOT_Alltoall, comm, timer, bytes);
   }
+  late_add (SLOT_Alltoall, comm, timer);
   return ret;
 }
 
@@ -410,42 +1159,67 @@ int MPI_Reduce (const void *sendbuf, void *recvbuf, int count, MPI_Datatype data
   int ret;
   int size;
   int ignoreret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Reduce");
+    pt = GPTLstart_slot ("sync_Reduce", SLOT_sync_Reduce);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Reduce");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Reduce)))
+      comm_add (pt, SLOT_sync_Reduce, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Reduce");
+  pt = GPTLstart_slot ("MPI_Reduce", SLOT_Reduce);
   ret = PMPI_Reduce (sendbuf, recvbuf, count, datatype, op, root, comm);
-  ignoreret = GPTLstop ("MPI_Reduce");
-  if ((timer = GPTLgetentry ("MPI_Reduce"))) {
-    ignoreret = PMPI_Type_size (datatype, &size);
+  if ((timer = GPTLstop_slot (pt, SLOT_Reduce))) {
+    size = typesize (pt, datatype);
     /* Estimate byte count as 1 send */
-    timer->nbytes += ((double) count) * size;
+    bytes = ((double) count) * size;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Reduce, comm, timer, bytes);
   }
+  late_add (SLOT_Reduce, comm, timer);
   return ret;
 }
 
 /*
 ** Additions to MPI_Finalize: Stop the timer started in MPI_Init, and
-** call GPTLpr() if it hasn't already been called.
+** call GPTLpr() if it hasn't already been called. If GPTLshared_output
+** is set, all ranks instead write a single indexed file "timing.shared".
 */
 int MPI_Finalize (void)
 {
   int ret, ignoreret;
   int iam;
+  int wasdisabled;     /* timers were disabled by the user */
 
   ignoreret = GPTLstop ("MPI_Init_thru_Finalize");
+  clock_drift ();
+  late_flush_all ();
 
   if ( ! GPTLpr_has_been_called ()) {
-    PMPI_Comm_rank (MPI_COMM_WORLD, &iam);
-    ignoreret = GPTLpr (iam);
+#ifdef HAVE_LIBMPI
+    if (shared_output) {
+      ignoreret = GPTLpr_shared_file (MPI_COMM_WORLD, "timing.shared");
+    } else
+#endif
+    {
+      PMPI_Comm_rank (MPI_COMM_WORLD, &iam);
+      ignoreret = GPTLpr (iam);
+    }
   }
-  /* Since we're in MPI_Finalize it's safe to call GPTLpr_summary for MPI_COMM_WORLD */
+  /* 
+  ** Since we're in MPI_Finalize it's safe to call GPTLpr_summary for MPI_COMM_WORLD.
+  ** Its messages are not timed, so a report printed after MPI_Finalize shows only the
+  ** application's MPI calls.
+  */
+  wasdisabled = GPTLis_disabled ();
+  ignoreret = GPTLdisable ();
   ignoreret = GPTLpr_summary (MPI_COMM_WORLD);
+  if ( ! wasdisabled)
+    ignoreret = GPTLenable ();
 
   ret = PMPI_Finalize();
   return ret;
@@ -459,26 +1233,31 @@ int MPI_Allgather (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
   int sendsize, recvsize;
   int commsize;
   int ignoreret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Allgather");
+    pt = GPTLstart_slot ("sync_Allgather", SLOT_sync_Allgather);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Allgather");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Allgather)))
+      comm_add (pt, SLOT_sync_Allgather, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Allgather");
+  pt = GPTLstart_slot ("MPI_Allgather", SLOT_Allgather);
   ret = PMPI_Allgather (sendbuf, sendcount, sendtype, 
 			recvbuf, recvcount, recvtype, comm);
-  ignoreret = GPTLstop ("MPI_Allgather");
-
-  if ((timer = GPTLgetentry ("MPI_Allgather"))) {
+  if ((timer = GPTLstop_slot (pt, SLOT_Allgather))) {
     ignoreret = PMPI_Comm_size (comm, &commsize);
-    ignoreret = PMPI_Type_size (sendtype, &sendsize);
-    ignoreret = PMPI_Type_size (recvtype, &recvsize);
-    timer->nbytes += (double) sendcount * sendsize * (commsize-1)+ 
-                     (double) recvcount * recvsize * (commsize-1);
+    sendsize = typesize (pt, sendtype);
+    recvsize = typesize (pt, recvtype);
+    bytes = (double) sendcount * sendsize * (commsize-1)+ 
+            (double) recvcount * recvsize * (commsize-1);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, (double) sendcount * sendsize);
+    comm_add (pt, SLOT_Allgather, comm, timer, bytes);
   }
+  late_add (SLOT_Allgather, comm, timer);
   return ret;
 }
 
@@ -492,30 +1271,35 @@ int MPI_Allgatherv (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
   int sendsize, recvsize;
   int commsize;
   int ignoreret;
+  double bytes = 0.;     /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Allgatherv");
+    pt = GPTLstart_slot ("sync_Allgatherv", SLOT_sync_Allgatherv);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Allgatherv");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Allgatherv)))
+      comm_add (pt, SLOT_sync_Allgatherv, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Allgatherv");
+  pt = GPTLstart_slot ("MPI_Allgatherv", SLOT_Allgatherv);
   ret = PMPI_Allgatherv (sendbuf, sendcount, sendtype, 
 			 recvbuf, recvcounts, displs, 
 			 recvtype, comm);
-  ignoreret = GPTLstop ("MPI_Allgatherv");
-
-  if ((timer = GPTLgetentry ("MPI_Allgatherv"))) {
+  if ((timer = GPTLstop_slot (pt, SLOT_Allgatherv))) {
     ignoreret = PMPI_Comm_rank (comm, &iam);
     ignoreret = PMPI_Comm_size (comm, &commsize);
-    ignoreret = PMPI_Type_size (sendtype, &sendsize);
-    ignoreret = PMPI_Type_size (recvtype, &recvsize);
-    timer->nbytes += (double) sendcount * sendsize * (commsize-1);
+    sendsize = typesize (pt, sendtype);
+    recvsize = typesize (pt, recvtype);
+    bytes += (double) sendcount * sendsize * (commsize-1);
     for (i = 0; i < commsize; ++i)
       if (i != iam)
-	timer->nbytes += (double) recvcounts[i] * recvsize;
+	bytes += (double) recvcounts[i] * recvsize;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, (double) sendcount * sendsize);
+    comm_add (pt, SLOT_Allgatherv, comm, timer, bytes);
   }
+  late_add (SLOT_Allgatherv, comm, timer);
   return ret;
 }
 
@@ -523,22 +1307,26 @@ int MPI_Iprobe (int source, int tag, MPI_Comm comm, int *flag,
 		MPI_Status *status)
 {
   int ret;
-  int ignoreret;
+  Pmpithread *pt;
+  Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Iprobe");
+  pt = GPTLstart_slot ("MPI_Iprobe", SLOT_Iprobe);
   ret = PMPI_Iprobe (source, tag, comm, flag, status);
-  ignoreret = GPTLstop ("MPI_Iprobe");
+  if ((timer = GPTLstop_slot (pt, SLOT_Iprobe)))
+    comm_add (pt, SLOT_Iprobe, comm, timer, 0.);
   return ret;
 }
 
 int MPI_Probe (int source, int tag, MPI_Comm comm, MPI_Status *status)
 {
   int ret;
-  int ignoreret;
+  Pmpithread *pt;
+  Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Probe");
+  pt = GPTLstart_slot ("MPI_Probe", SLOT_Probe);
   ret = PMPI_Probe (source, tag, comm, status);
-  ignoreret = GPTLstop ("MPI_Probe");
+  if ((timer = GPTLstop_slot (pt, SLOT_Probe)))
+    comm_add (pt, SLOT_Probe, comm, timer, 0.);
   return ret;
 }
 
@@ -546,16 +1334,20 @@ int MPI_Ssend (const void *buf, int count, MPI_Datatype datatype,
 	       int dest, int tag, MPI_Comm comm)
 {
   int ret;
-  int ignoreret;
   int size;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Ssend");
+  pt = GPTLstart_slot ("MPI_Ssend", SLOT_Ssend);
   ret = PMPI_Ssend (buf, count, datatype, dest, tag, comm);
-  ignoreret = GPTLstop ("MPI_Ssend");
-  if ((timer = GPTLgetentry ("MPI_Ssend"))) {
-    ignoreret = PMPI_Type_size (datatype, &size);
-    timer->nbytes += ((double) count) * size;
+  if ((timer = GPTLstop_slot (pt, SLOT_Ssend))) {
+    size = typesize (pt, datatype);
+    bytes = ((double) count) * size;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Ssend, comm, timer, bytes);
+    peer_add (pt, comm, dest, true, bytes, timer);
   }
   return ret;
 }
@@ -570,32 +1362,41 @@ int MPI_Alltoallv (const void *sendbuf, const int *sendcounts, const int *sdispl
   int sendsize, recvsize;
   int commsize;
   int ignoreret;
+  double sendbytes = 0.;   /* bytes in all blocks sent, including to self */
+  double bytes = 0.;       /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
   
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Alltoallv");
+    pt = GPTLstart_slot ("sync_Alltoallv", SLOT_sync_Alltoallv);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Alltoallv");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Alltoallv)))
+      comm_add (pt, SLOT_sync_Alltoallv, comm, timer, 0.);
   }
   
-  ignoreret = GPTLstart ("MPI_Alltoallv");
+  pt = GPTLstart_slot ("MPI_Alltoallv", SLOT_Alltoallv);
   ret = PMPI_Alltoallv (sendbuf, sendcounts, sdispls,
 			sendtype, recvbuf, recvcounts,
 			rdispls, recvtype, comm);
   
-  ignoreret = GPTLstop ("MPI_Alltoallv");
-  if ((timer = GPTLgetentry ("MPI_Alltoallv"))) {
+  if ((timer = GPTLstop_slot (pt, SLOT_Alltoallv))) {
     ignoreret = PMPI_Comm_rank (comm, &iam);
     ignoreret = PMPI_Comm_size (comm, &commsize);
-    ignoreret = PMPI_Type_size (sendtype, &sendsize);
-    ignoreret = PMPI_Type_size (recvtype, &recvsize);
+    sendsize = typesize (pt, sendtype);
+    recvsize = typesize (pt, recvtype);
     for (i = 0; i < commsize; ++i) {
+      sendbytes += (double) sendcounts[i] * sendsize;
       if (i != iam) {
-	timer->nbytes += (double) sendcounts[i] * sendsize;
-	timer->nbytes += (double) recvcounts[i] * recvsize;
+	bytes += (double) sendcounts[i] * sendsize;
+	bytes += (double) recvcounts[i] * recvsize;
       }
     }
+    timer->nbytes += bytes;
+    /* Blocks differ in size: histogram the mean block */
+    GPTLmsghist_add (timer, sendbytes / commsize);
+    comm_add (pt, SLOT_Alltoallv, comm, timer, bytes);
   }
+  late_add (SLOT_Alltoallv, comm, timer);
   return ret;
 }
 
@@ -609,54 +1410,1393 @@ int MPI_Scatterv (const void *sendbuf, const int *sendcounts, const int *displs,
   int sendsize, recvsize;
   int commsize;
   int ignoreret;
+  double bytes = 0.;     /* bytes of the call */
+  Pmpithread *pt;
   Timer *timer;
 
   if (sync_mpi) {
-    ignoreret = GPTLstart ("sync_Scatterv");
+    pt = GPTLstart_slot ("sync_Scatterv", SLOT_sync_Scatterv);
     ignoreret = PMPI_Barrier (comm);
-    ignoreret = GPTLstop ("sync_Scatterv");
+    if ((timer = GPTLstop_slot (pt, SLOT_sync_Scatterv)))
+      comm_add (pt, SLOT_sync_Scatterv, comm, timer, 0.);
   }
     
-  ignoreret = GPTLstart ("MPI_Scatterv");
+  pt = GPTLstart_slot ("MPI_Scatterv", SLOT_Scatterv);
   ret = PMPI_Scatterv (sendbuf, sendcounts, displs,
 		       sendtype, recvbuf, recvcount, 
 		       recvtype, root, comm);
-  ignoreret = GPTLstop ("MPI_Scatterv");
-  if ((timer = GPTLgetentry ("MPI_Scatterv"))) {
+  if ((timer = GPTLstop_slot (pt, SLOT_Scatterv))) {
     ignoreret = PMPI_Comm_rank (comm, &iam);
     ignoreret = PMPI_Comm_size (comm, &commsize);
-    ignoreret = PMPI_Type_size (sendtype, &sendsize);
-    ignoreret = PMPI_Type_size (recvtype, &recvsize);
-    timer->nbytes += (double) recvcount * recvsize;
+    sendsize = typesize (pt, sendtype);
+    recvsize = typesize (pt, recvtype);
+    bytes += (double) recvcount * recvsize;
     if (iam == root) {
       for (i = 0; i < commsize; ++i)
 	if (i != iam)
-	  timer->nbytes += (double) sendcounts[i] * sendsize;
+	  bytes += (double) sendcounts[i] * sendsize;
     } else {
-      timer->nbytes += (double) recvcount * recvsize;
+      bytes += (double) recvcount * recvsize;
     }
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, (double) recvcount * recvsize);
+    comm_add (pt, SLOT_Scatterv, comm, timer, bytes);
   }
+  late_add (SLOT_Scatterv, comm, timer);
   return ret;
 }
 
 int MPI_Test (MPI_Request *request, int *flag, MPI_Status *status)
 {
   int ret;
-  int ignoreret;
+  uintptr_t *keys;
+  Pmpithread *pt;
+  Timer *timer;
 
-  ignoreret = GPTLstart ("MPI_Test");
+  pt = GPTLstart_slot ("MPI_Test", SLOT_Test);
+  keys = req_keys (pt, 1, request);
   ret = PMPI_Test (request, flag, status);
-  ignoreret = GPTLstop ("MPI_Test");
+  if ((timer = GPTLstop_slot (pt, SLOT_Test)) && ret == MPI_SUCCESS)
+    req_wait (pt, timer, 1, keys, *flag ? 1 : 0, NULL);
   return ret;
 }
 
-#else   /* ENABLE_PMPI not set */
+int MPI_Waitany (int count, MPI_Request array_of_requests[], int *indx, MPI_Status *status)
+{
+  int ret;
+  uintptr_t *keys;
+  Pmpithread *pt;
+  Timer *timer;
 
-int GPTLpmpi_setoption (const int option,
-			const int val)
+  pt = GPTLstart_slot ("MPI_Waitany", SLOT_Waitany);
+  keys = req_keys (pt, count, array_of_requests);
+  ret = PMPI_Waitany (count, array_of_requests, indx, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_Waitany)) && ret == MPI_SUCCESS)
+    req_wait (pt, timer, count, keys, *indx != MPI_UNDEFINED ? 1 : 0, indx);
+  return ret;
+}
+
+int MPI_Waitsome (int incount, MPI_Request array_of_requests[], int *outcount,
+		  int array_of_indices[], MPI_Status array_of_statuses[])
 {
-  return GPTLerror ("GPTLpmpi_setoption: GPTL needs to be built with ENABLE_PMPI=yes "
-		    "to set option %d\n", option);
+  int ret;
+  uintptr_t *keys;
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Waitsome", SLOT_Waitsome);
+  keys = req_keys (pt, incount, array_of_requests);
+  ret = PMPI_Waitsome (incount, array_of_requests, outcount, array_of_indices, array_of_statuses);
+  if ((timer = GPTLstop_slot (pt, SLOT_Waitsome)) && ret == MPI_SUCCESS)
+    req_wait (pt, timer, incount, keys, *outcount != MPI_UNDEFINED ? *outcount : 0,
+	      array_of_indices);
+  return ret;
+}
+
+int MPI_Testall (int count, MPI_Request array_of_requests[], int *flag,
+		 MPI_Status array_of_statuses[])
+{
+  int ret;
+  uintptr_t *keys;
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Testall", SLOT_Testall);
+  keys = req_keys (pt, count, array_of_requests);
+  ret = PMPI_Testall (count, array_of_requests, flag, array_of_statuses);
+  if ((timer = GPTLstop_slot (pt, SLOT_Testall)) && ret == MPI_SUCCESS)
+    req_wait (pt, timer, count, keys, *flag ? count : 0, NULL);
+  return ret;
+}
+
+int MPI_Testany (int count, MPI_Request array_of_requests[], int *indx, int *flag,
+		 MPI_Status *status)
+{
+  int ret;
+  uintptr_t *keys;
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Testany", SLOT_Testany);
+  keys = req_keys (pt, count, array_of_requests);
+  ret = PMPI_Testany (count, array_of_requests, indx, flag, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_Testany)) && ret == MPI_SUCCESS)
+    req_wait (pt, timer, count, keys, (*flag && *indx != MPI_UNDEFINED) ? 1 : 0, indx);
+  return ret;
+}
+
+int MPI_Testsome (int incount, MPI_Request array_of_requests[], int *outcount,
+		  int array_of_indices[], MPI_Status array_of_statuses[])
+{
+  int ret;
+  uintptr_t *keys;
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Testsome", SLOT_Testsome);
+  keys = req_keys (pt, incount, array_of_requests);
+  ret = PMPI_Testsome (incount, array_of_requests, outcount, array_of_indices, array_of_statuses);
+  if ((timer = GPTLstop_slot (pt, SLOT_Testsome)) && ret == MPI_SUCCESS)
+    req_wait (pt, timer, incount, keys, *outcount != MPI_UNDEFINED ? *outcount : 0,
+	      array_of_indices);
+  return ret;
+}
+
+int MPI_Reduce_scatter (const void *sendbuf, void *recvbuf, const int recvcounts[],
+			MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+  int ret;
+  int iam;
+  int size;
+  int commsize;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Reduce_scatter", SLOT_Reduce_scatter);
+  ret = PMPI_Reduce_scatter (sendbuf, recvbuf, recvcounts, datatype, op, comm);
+  if ((timer = GPTLstop_slot (pt, SLOT_Reduce_scatter))) {
+    (void) PMPI_Comm_rank (comm, &iam);
+    (void) PMPI_Comm_size (comm, &commsize);
+    size = typesize (pt, datatype);
+    /* Estimate byte count as 1 send of the whole vector */
+    bytes = sumcounts (recvcounts, commsize, -1, size);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, (double) recvcounts[iam] * size);
+    comm_add (pt, SLOT_Reduce_scatter, comm, timer, bytes);
+  }
+  late_add (SLOT_Reduce_scatter, comm, timer);
+  return ret;
+}
+
+int MPI_Reduce_scatter_block (const void *sendbuf, void *recvbuf, int recvcount,
+			      MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+  int ret;
+  int size;
+  int commsize;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Reduce_scatter_block", SLOT_Reduce_scatter_block);
+  ret = PMPI_Reduce_scatter_block (sendbuf, recvbuf, recvcount, datatype, op, comm);
+  if ((timer = GPTLstop_slot (pt, SLOT_Reduce_scatter_block))) {
+    (void) PMPI_Comm_size (comm, &commsize);
+    size = typesize (pt, datatype);
+    bytes = (double) recvcount * size * commsize;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, (double) recvcount * size);
+    comm_add (pt, SLOT_Reduce_scatter_block, comm, timer, bytes);
+  }
+  late_add (SLOT_Reduce_scatter_block, comm, timer);
+  return ret;
+}
+
+int MPI_Scan (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype,
+	      MPI_Op op, MPI_Comm comm)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Scan", SLOT_Scan);
+  ret = PMPI_Scan (sendbuf, recvbuf, count, datatype, op, comm);
+  if ((timer = GPTLstop_slot (pt, SLOT_Scan))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Scan, comm, timer, bytes);
+  }
+  late_add (SLOT_Scan, comm, timer);
+  return ret;
+}
+
+int MPI_Exscan (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype,
+		MPI_Op op, MPI_Comm comm)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Exscan", SLOT_Exscan);
+  ret = PMPI_Exscan (sendbuf, recvbuf, count, datatype, op, comm);
+  if ((timer = GPTLstop_slot (pt, SLOT_Exscan))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Exscan, comm, timer, bytes);
+  }
+  late_add (SLOT_Exscan, comm, timer);
+  return ret;
+}
+
+/*
+** Nonblocking collectives: the time is that of starting the operation, and bytes
+** are counted as for the blocking version.
+*/
+int MPI_Ibarrier (MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Ibarrier", SLOT_Ibarrier);
+  ret = PMPI_Ibarrier (comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Ibarrier))) {
+    comm_add (pt, SLOT_Ibarrier, comm, timer, 0.);
+    req_post (pt, SLOT_Ibarrier, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Ibcast (void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm,
+		MPI_Request *request)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Ibcast", SLOT_Ibcast);
+  ret = PMPI_Ibcast (buffer, count, datatype, root, comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Ibcast))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Ibcast, comm, timer, bytes);
+    req_post (pt, SLOT_Ibcast, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Iallreduce (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype,
+		    MPI_Op op, MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Iallreduce", SLOT_Iallreduce);
+  ret = PMPI_Iallreduce (sendbuf, recvbuf, count, datatype, op, comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Iallreduce))) {
+    bytes = (double) count * typesize (pt, datatype);
+    /* Estimate size as 1 send plus 1 recv */
+    timer->nbytes += 2. * bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Iallreduce, comm, timer, 2. * bytes);
+    req_post (pt, SLOT_Iallreduce, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Ireduce (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype,
+		 MPI_Op op, int root, MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Ireduce", SLOT_Ireduce);
+  ret = PMPI_Ireduce (sendbuf, recvbuf, count, datatype, op, root, comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Ireduce))) {
+    /* Estimate byte count as 1 send */
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    comm_add (pt, SLOT_Ireduce, comm, timer, bytes);
+    req_post (pt, SLOT_Ireduce, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Igather (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		 void *recvbuf, int recvcount, MPI_Datatype recvtype,
+		 int root, MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  int iam;
+  int commsize;
+  double bytes;          /* bytes of the call */
+  double msgbytes;       /* message size for the histogram */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Igather", SLOT_Igather);
+  ret = PMPI_Igather (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype,
+		      root, comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Igather))) {
+    (void) PMPI_Comm_rank (comm, &iam);
+    (void) PMPI_Comm_size (comm, &commsize);
+    msgbytes = (double) sendcount * typesize (pt, sendtype);
+    bytes = msgbytes;
+    if (iam == root)
+      bytes += (double) recvcount * typesize (pt, recvtype) * (commsize-1);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, msgbytes);
+    comm_add (pt, SLOT_Igather, comm, timer, bytes);
+    req_post (pt, SLOT_Igather, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Igatherv (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		  void *recvbuf, const int recvcounts[], const int displs[],
+		  MPI_Datatype recvtype, int root, MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  int iam;
+  int commsize;
+  double bytes;          /* bytes of the call */
+  double msgbytes;       /* message size for the histogram */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Igatherv", SLOT_Igatherv);
+  ret = PMPI_Igatherv (sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs,
+		       recvtype, root, comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Igatherv))) {
+    (void) PMPI_Comm_rank (comm, &iam);
+    (void) PMPI_Comm_size (comm, &commsize);
+    msgbytes = (double) sendcount * typesize (pt, sendtype);
+    if (iam == root)
+      bytes = sumcounts (recvcounts, commsize, iam, typesize (pt, recvtype));
+    else
+      bytes = msgbytes;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, msgbytes);
+    comm_add (pt, SLOT_Igatherv, comm, timer, bytes);
+    req_post (pt, SLOT_Igatherv, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Iscatter (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		  void *recvbuf, int recvcount, MPI_Datatype recvtype,
+		  int root, MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  int iam;
+  double bytes;          /* bytes of the call */
+  double msgbytes;       /* message size for the histogram */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Iscatter", SLOT_Iscatter);
+  ret = PMPI_Iscatter (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype,
+		       root, comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Iscatter))) {
+    (void) PMPI_Comm_rank (comm, &iam);
+    msgbytes = (double) recvcount * typesize (pt, recvtype);
+    bytes = msgbytes;
+    if (iam == root)
+      bytes += (double) sendcount * typesize (pt, sendtype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, msgbytes);
+    comm_add (pt, SLOT_Iscatter, comm, timer, bytes);
+    req_post (pt, SLOT_Iscatter, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Iscatterv (const void *sendbuf, const int sendcounts[], const int displs[],
+		   MPI_Datatype sendtype, void *recvbuf, int recvcount,
+		   MPI_Datatype recvtype, int root, MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  int iam;
+  int commsize;
+  double bytes;          /* bytes of the call */
+  double msgbytes;       /* message size for the histogram */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Iscatterv", SLOT_Iscatterv);
+  ret = PMPI_Iscatterv (sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount,
+			recvtype, root, comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Iscatterv))) {
+    (void) PMPI_Comm_rank (comm, &iam);
+    (void) PMPI_Comm_size (comm, &commsize);
+    msgbytes = (double) recvcount * typesize (pt, recvtype);
+    bytes = msgbytes;
+    if (iam == root)
+      bytes += sumcounts (sendcounts, commsize, iam, typesize (pt, sendtype));
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, msgbytes);
+    comm_add (pt, SLOT_Iscatterv, comm, timer, bytes);
+    req_post (pt, SLOT_Iscatterv, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Iallgather (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		    void *recvbuf, int recvcount, MPI_Datatype recvtype,
+		    MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  int commsize;
+  double bytes;          /* bytes of the call */
+  double msgbytes;       /* message size for the histogram */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Iallgather", SLOT_Iallgather);
+  ret = PMPI_Iallgather (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype,
+			 comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Iallgather))) {
+    (void) PMPI_Comm_size (comm, &commsize);
+    msgbytes = (double) sendcount * typesize (pt, sendtype);
+    bytes = (msgbytes + (double) recvcount * typesize (pt, recvtype)) * (commsize-1);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, msgbytes);
+    comm_add (pt, SLOT_Iallgather, comm, timer, bytes);
+    req_post (pt, SLOT_Iallgather, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Iallgatherv (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		     void *recvbuf, const int recvcounts[], const int displs[],
+		     MPI_Datatype recvtype, MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  int iam;
+  int commsize;
+  double bytes;          /* bytes of the call */
+  double msgbytes;       /* message size for the histogram */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Iallgatherv", SLOT_Iallgatherv);
+  ret = PMPI_Iallgatherv (sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs,
+			  recvtype, comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Iallgatherv))) {
+    (void) PMPI_Comm_rank (comm, &iam);
+    (void) PMPI_Comm_size (comm, &commsize);
+    msgbytes = (double) sendcount * typesize (pt, sendtype);
+    bytes = msgbytes * (commsize-1) + sumcounts (recvcounts, commsize, iam, typesize (pt, recvtype));
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, msgbytes);
+    comm_add (pt, SLOT_Iallgatherv, comm, timer, bytes);
+    req_post (pt, SLOT_Iallgatherv, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Ialltoall (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		   void *recvbuf, int recvcount, MPI_Datatype recvtype,
+		   MPI_Comm comm, MPI_Request *request)
+{
+  int ret;
+  int commsize;
+  double bytes;          /* bytes of the call */
+  double msgbytes;       /* message size for the histogram */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Ialltoall", SLOT_Ialltoall);
+  ret = PMPI_Ialltoall (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype,
+			comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Ialltoall))) {
+    (void) PMPI_Comm_size (comm, &commsize);
+    msgbytes = (double) sendcount * typesize (pt, sendtype);
+    bytes = (msgbytes + (double) recvcount * typesize (pt, recvtype)) * (commsize-1);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, msgbytes);
+    comm_add (pt, SLOT_Ialltoall, comm, timer, bytes);
+    req_post (pt, SLOT_Ialltoall, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_Ialltoallv (const void *sendbuf, const int sendcounts[], const int sdispls[],
+		    MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
+		    const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm,
+		    MPI_Request *request)
+{
+  int ret;
+  int iam;
+  int sendsize;
+  int commsize;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Ialltoallv", SLOT_Ialltoallv);
+  ret = PMPI_Ialltoallv (sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts,
+			 rdispls, recvtype, comm, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_Ialltoallv))) {
+    (void) PMPI_Comm_rank (comm, &iam);
+    (void) PMPI_Comm_size (comm, &commsize);
+    sendsize = typesize (pt, sendtype);
+    bytes = sumcounts (sendcounts, commsize, iam, sendsize) +
+            sumcounts (recvcounts, commsize, iam, typesize (pt, recvtype));
+    timer->nbytes += bytes;
+    /* Blocks differ in size: histogram the mean block */
+    GPTLmsghist_add (timer, sumcounts (sendcounts, commsize, -1, sendsize) / commsize);
+    comm_add (pt, SLOT_Ialltoallv, comm, timer, bytes);
+    req_post (pt, SLOT_Ialltoallv, timer, *request);
+  }
+  return ret;
+}
+
+/*
+** Neighborhood collectives: bytes are counted per neighbor of the process topology
+** attached to comm.
+*/
+int MPI_Neighbor_allgather (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+			    void *recvbuf, int recvcount, MPI_Datatype recvtype,
+			    MPI_Comm comm)
+{
+  int ret;
+  int indegree, outdegree;
+  double bytes;          /* bytes of the call */
+  double msgbytes;       /* message size for the histogram */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Neighbor_allgather", SLOT_Neighbor_allgather);
+  ret = PMPI_Neighbor_allgather (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype,
+				 comm);
+  if ((timer = GPTLstop_slot (pt, SLOT_Neighbor_allgather))) {
+    neighbors (comm, &indegree, &outdegree);
+    msgbytes = (double) sendcount * typesize (pt, sendtype);
+    bytes = msgbytes * outdegree + (double) recvcount * typesize (pt, recvtype) * indegree;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, msgbytes);
+    comm_add (pt, SLOT_Neighbor_allgather, comm, timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_Neighbor_alltoall (const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+			   void *recvbuf, int recvcount, MPI_Datatype recvtype,
+			   MPI_Comm comm)
+{
+  int ret;
+  int indegree, outdegree;
+  double bytes;          /* bytes of the call */
+  double msgbytes;       /* message size for the histogram */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Neighbor_alltoall", SLOT_Neighbor_alltoall);
+  ret = PMPI_Neighbor_alltoall (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype,
+				comm);
+  if ((timer = GPTLstop_slot (pt, SLOT_Neighbor_alltoall))) {
+    neighbors (comm, &indegree, &outdegree);
+    msgbytes = (double) sendcount * typesize (pt, sendtype);
+    bytes = msgbytes * outdegree + (double) recvcount * typesize (pt, recvtype) * indegree;
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, msgbytes);
+    comm_add (pt, SLOT_Neighbor_alltoall, comm, timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_Neighbor_alltoallv (const void *sendbuf, const int sendcounts[], const int sdispls[],
+			    MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
+			    const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm)
+{
+  int ret;
+  int indegree, outdegree;
+  int sendsize;
+  double sendbytes;      /* bytes sent to all neighbors */
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Neighbor_alltoallv", SLOT_Neighbor_alltoallv);
+  ret = PMPI_Neighbor_alltoallv (sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts,
+				 rdispls, recvtype, comm);
+  if ((timer = GPTLstop_slot (pt, SLOT_Neighbor_alltoallv))) {
+    neighbors (comm, &indegree, &outdegree);
+    sendsize = typesize (pt, sendtype);
+    sendbytes = sumcounts (sendcounts, outdegree, -1, sendsize);
+    bytes = sendbytes + sumcounts (recvcounts, indegree, -1, typesize (pt, recvtype));
+    timer->nbytes += bytes;
+    /* Blocks differ in size: histogram the mean block */
+    GPTLmsghist_add (timer, outdegree > 0 ? sendbytes / outdegree : 0.);
+    comm_add (pt, SLOT_Neighbor_alltoallv, comm, timer, bytes);
+  }
+  return ret;
+}
+
+/*
+** One-sided communication. Put, Get and Accumulate count the bytes of the origin
+** buffer. Their time is that of issuing the operation: with most MPI libraries the
+** transfer is completed, and its time spent, in the synchronization routine.
+*/
+int MPI_Put (const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+	     int target_rank, MPI_Aint target_disp, int target_count,
+	     MPI_Datatype target_datatype, MPI_Win win)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Put", SLOT_Put);
+  ret = PMPI_Put (origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+		  target_count, target_datatype, win);
+  if ((timer = GPTLstop_slot (pt, SLOT_Put))) {
+    bytes = (double) origin_count * typesize (pt, origin_datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_Get (void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+	     int target_rank, MPI_Aint target_disp, int target_count,
+	     MPI_Datatype target_datatype, MPI_Win win)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Get", SLOT_Get);
+  ret = PMPI_Get (origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+		  target_count, target_datatype, win);
+  if ((timer = GPTLstop_slot (pt, SLOT_Get))) {
+    bytes = (double) origin_count * typesize (pt, origin_datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_Accumulate (const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+		    int target_rank, MPI_Aint target_disp, int target_count,
+		    MPI_Datatype target_datatype, MPI_Op op, MPI_Win win)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_Accumulate", SLOT_Accumulate);
+  ret = PMPI_Accumulate (origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+			 target_count, target_datatype, op, win);
+  if ((timer = GPTLstop_slot (pt, SLOT_Accumulate))) {
+    bytes = (double) origin_count * typesize (pt, origin_datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_Win_fence (int assert, MPI_Win win)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_Win_fence", SLOT_Win_fence);
+  ret = PMPI_Win_fence (assert, win);
+  (void) GPTLstop_slot (pt, SLOT_Win_fence);
+  return ret;
+}
+
+int MPI_Win_lock (int lock_type, int rank, int assert, MPI_Win win)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_Win_lock", SLOT_Win_lock);
+  ret = PMPI_Win_lock (lock_type, rank, assert, win);
+  (void) GPTLstop_slot (pt, SLOT_Win_lock);
+  return ret;
+}
+
+int MPI_Win_unlock (int rank, MPI_Win win)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_Win_unlock", SLOT_Win_unlock);
+  ret = PMPI_Win_unlock (rank, win);
+  (void) GPTLstop_slot (pt, SLOT_Win_unlock);
+  return ret;
+}
+
+int MPI_Win_flush (int rank, MPI_Win win)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_Win_flush", SLOT_Win_flush);
+  ret = PMPI_Win_flush (rank, win);
+  (void) GPTLstop_slot (pt, SLOT_Win_flush);
+  return ret;
+}
+
+int MPI_Win_post (MPI_Group group, int assert, MPI_Win win)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_Win_post", SLOT_Win_post);
+  ret = PMPI_Win_post (group, assert, win);
+  (void) GPTLstop_slot (pt, SLOT_Win_post);
+  return ret;
+}
+
+int MPI_Win_start (MPI_Group group, int assert, MPI_Win win)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_Win_start", SLOT_Win_start);
+  ret = PMPI_Win_start (group, assert, win);
+  (void) GPTLstop_slot (pt, SLOT_Win_start);
+  return ret;
+}
+
+int MPI_Win_complete (MPI_Win win)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_Win_complete", SLOT_Win_complete);
+  ret = PMPI_Win_complete (win);
+  (void) GPTLstop_slot (pt, SLOT_Win_complete);
+  return ret;
+}
+
+int MPI_Win_wait (MPI_Win win)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_Win_wait", SLOT_Win_wait);
+  ret = PMPI_Win_wait (win);
+  (void) GPTLstop_slot (pt, SLOT_Win_wait);
+  return ret;
+}
+
+#ifdef MPI_FILE_NULL
+/*
+** MPI-IO. Reads and writes count the bytes of the user's buffer. MPI_File_open is
+** collective over comm, so it is also counted by communicator.
+*/
+int MPI_File_open (MPI_Comm comm, const char *filename, int amode, MPI_Info info,
+		   MPI_File *fh)
+{
+  int ret;
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_open", SLOT_File_open);
+  ret = PMPI_File_open (comm, filename, amode, info, fh);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_open)))
+    comm_add (pt, SLOT_File_open, comm, timer, 0.);
+  return ret;
+}
+
+int MPI_File_close (MPI_File *fh)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_File_close", SLOT_File_close);
+  ret = PMPI_File_close (fh);
+  (void) GPTLstop_slot (pt, SLOT_File_close);
+  return ret;
+}
+
+int MPI_File_sync (MPI_File fh)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_File_sync", SLOT_File_sync);
+  ret = PMPI_File_sync (fh);
+  (void) GPTLstop_slot (pt, SLOT_File_sync);
+  return ret;
+}
+
+int MPI_File_set_view (MPI_File fh, MPI_Offset disp, MPI_Datatype etype,
+		       MPI_Datatype filetype, const char *datarep, MPI_Info info)
+{
+  int ret;
+  Pmpithread *pt;
+
+  pt = GPTLstart_slot ("MPI_File_set_view", SLOT_File_set_view);
+  ret = PMPI_File_set_view (fh, disp, etype, filetype, datarep, info);
+  (void) GPTLstop_slot (pt, SLOT_File_set_view);
+  return ret;
+}
+
+int MPI_File_read (MPI_File fh, void *buf, int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_read", SLOT_File_read);
+  ret = PMPI_File_read (fh, buf, count, datatype, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_read))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_File_write (MPI_File fh, const void *buf, int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_write", SLOT_File_write);
+  ret = PMPI_File_write (fh, buf, count, datatype, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_write))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_File_read_at (MPI_File fh, MPI_Offset offset, void *buf, int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_read_at", SLOT_File_read_at);
+  ret = PMPI_File_read_at (fh, offset, buf, count, datatype, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_read_at))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_File_write_at (MPI_File fh, MPI_Offset offset, const void *buf, int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_write_at", SLOT_File_write_at);
+  ret = PMPI_File_write_at (fh, offset, buf, count, datatype, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_write_at))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_File_read_all (MPI_File fh, void *buf, int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_read_all", SLOT_File_read_all);
+  ret = PMPI_File_read_all (fh, buf, count, datatype, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_read_all))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_File_write_all (MPI_File fh, const void *buf, int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_write_all", SLOT_File_write_all);
+  ret = PMPI_File_write_all (fh, buf, count, datatype, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_write_all))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_File_read_at_all (MPI_File fh, MPI_Offset offset, void *buf, int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_read_at_all", SLOT_File_read_at_all);
+  ret = PMPI_File_read_at_all (fh, offset, buf, count, datatype, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_read_at_all))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_File_write_at_all (MPI_File fh, MPI_Offset offset, const void *buf, int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_write_at_all", SLOT_File_write_at_all);
+  ret = PMPI_File_write_at_all (fh, offset, buf, count, datatype, status);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_write_at_all))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+  }
+  return ret;
+}
+
+int MPI_File_iread_at (MPI_File fh, MPI_Offset offset, void *buf, int count, MPI_Datatype datatype,
+			MPI_Request *request)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_iread_at", SLOT_File_iread_at);
+  ret = PMPI_File_iread_at (fh, offset, buf, count, datatype, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_iread_at))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    req_post (pt, SLOT_File_iread_at, timer, *request);
+  }
+  return ret;
+}
+
+int MPI_File_iwrite_at (MPI_File fh, MPI_Offset offset, const void *buf, int count, MPI_Datatype datatype,
+			MPI_Request *request)
+{
+  int ret;
+  double bytes;          /* bytes of the call */
+  Pmpithread *pt;
+  Timer *timer;
+
+  pt = GPTLstart_slot ("MPI_File_iwrite_at", SLOT_File_iwrite_at);
+  ret = PMPI_File_iwrite_at (fh, offset, buf, count, datatype, request);
+  if ((timer = GPTLstop_slot (pt, SLOT_File_iwrite_at))) {
+    bytes = (double) count * typesize (pt, datatype);
+    timer->nbytes += bytes;
+    GPTLmsghist_add (timer, bytes);
+    req_post (pt, SLOT_File_iwrite_at, timer, *request);
+  }
+  return ret;
+}
+#endif
+
+/*
+** get_commattr: Return the attribute cached on comm, numbering comm and caching one on
+**   it if this is its first use. Duplicates of comm do not inherit the attribute, so
+**   they are numbered separately. Under MPI_THREAD_MULTIPLE, threads using a new
+**   communicator for the first time at once may number it twice.
+**
+** Return value: attribute, or NULL on failure
+*/
+static Commattr *get_commattr (MPI_Comm comm)
+{
+  Commattr *attr;
+  int flag;
+  int result;     /* from PMPI_Comm_compare */
+  int len;        /* from PMPI_Comm_get_name */
+  static const char *thisfunc = "get_commattr";
+
+  if (keyval == MPI_KEYVAL_INVALID &&
+      PMPI_Comm_create_keyval (MPI_COMM_NULL_COPY_FN, delete_commattr, &keyval, NULL) != MPI_SUCCESS)
+    return NULL;
+
+  if (PMPI_Comm_get_attr (comm, keyval, &attr, &flag) != MPI_SUCCESS)
+    return NULL;
+  if (flag)
+    return attr;
+
+  if ( ! (attr = (Commattr *) GPTLallocate (sizeof (Commattr), thisfunc)))
+    return NULL;
+
+  attr->idx = MIN (ncomm, COMM_MAX);
+  attr->group = MPI_GROUP_NULL;
+  attr->comm = MPI_COMM_NULL;
+  attr->late = NULL;
+  attr->nextlate = NULL;
+  if (PMPI_Comm_test_inter (comm, &flag) != MPI_SUCCESS)
+    flag = 1;
+  attr->inter = (bool) flag;
+  if ( ! attr->inter && PMPI_Comm_compare (comm, MPI_COMM_WORLD, &result) == MPI_SUCCESS &&
+       result != MPI_IDENT && result != MPI_CONGRUENT) {
+    if (worldgroup == MPI_GROUP_NULL)
+      (void) PMPI_Comm_group (MPI_COMM_WORLD, &worldgroup);
+    (void) PMPI_Comm_group (comm, &attr->group);
+  }
+
+  if (attr->idx < COMM_MAX) {
+    (void) PMPI_Comm_size (comm, &comminfo[attr->idx].size);
+    if (PMPI_Comm_get_name (comm, comminfo[attr->idx].name, &len) != MPI_SUCCESS)
+      comminfo[attr->idx].name[0] = '\0';
+  }
+  ++ncomm;
+
+  if (PMPI_Comm_set_attr (comm, keyval, attr) != MPI_SUCCESS) {
+    delete_commattr (comm, keyval, attr, NULL);
+    return NULL;
+  }
+  return attr;
+}
+
+/* Attribute delete callback: called when a communicator is freed */
+static int delete_commattr (MPI_Comm comm, int comm_keyval, void *attr_val, void *extra_state)
+{
+  Commattr *attr = (Commattr *) attr_val;
+  Commattr **pp;
+
+  if (attr->late) {
+    /* MPI_Comm_free is collective, so all ranks flush here together */
+    late_flush (attr);
+    for (pp = &latelist; *pp; pp = &(*pp)->nextlate)
+      if (*pp == attr) {
+	*pp = attr->nextlate;
+	break;
+      }
+    free (attr->late);
+  }
+  if (attr->group != MPI_GROUP_NULL)
+    (void) PMPI_Group_free (&attr->group);
+  free (attr);
+  return MPI_SUCCESS;
+}
+
+/*
+** late_flush: Exchange the entry times logged on a communicator, which all its ranks
+**   do at the same point, and tally the waits
+**
+** Input/output arguments:
+**   attr: attribute of the communicator, holding the log
+*/
+static void late_flush (Commattr *attr)
+{
+  double last[LATE_MAX];   /* latest entry time of each call */
+
+  if (attr->late->n == 0)
+    return;
+
+  late_globaltime (attr->late);
+  if (PMPI_Allreduce (attr->late->entry, last, attr->late->n, MPI_DOUBLE, MPI_MAX,
+		      attr->comm) == MPI_SUCCESS)
+    late_tally (attr->late, last);
+  else
+    attr->late->n = 0;
+}
+
+/*
+** late_flush_all: Flush the logs of all communicators still alive, at MPI_Finalize.
+**   Ranks may list their communicators in different orders, so the exchanges are
+**   nonblocking and completed together.
+*/
+static void late_flush_all (void)
+{
+  Commattr *attr;
+  MPI_Request *reqs;
+  double *last;            /* LATE_MAX latest entry times per communicator */
+  int n, i;
+  static const char *thisfunc = "late_flush_all";
+
+  for (attr = latelist, n = 0; attr; attr = attr->nextlate)
+    ++n;
+  if (n == 0)
+    return;
+
+  if ( ! (reqs = (MPI_Request *) GPTLallocate (n * sizeof (MPI_Request), thisfunc)))
+    return;
+  if ( ! (last = (double *) GPTLallocate (n * LATE_MAX * sizeof (double), thisfunc))) {
+    free (reqs);
+    return;
+  }
+
+  for (attr = latelist, i = 0; attr; attr = attr->nextlate, ++i) {
+    late_globaltime (attr->late);
+    if (attr->late->n == 0 ||
+	PMPI_Iallreduce (attr->late->entry, &last[i*LATE_MAX], attr->late->n, MPI_DOUBLE,
+			 MPI_MAX, attr->comm, &reqs[i]) != MPI_SUCCESS)
+      reqs[i] = MPI_REQUEST_NULL;
+  }
+
+  if (PMPI_Waitall (n, reqs, MPI_STATUSES_IGNORE) == MPI_SUCCESS)
+    for (attr = latelist, i = 0; attr; attr = attr->nextlate, ++i)
+      late_tally (attr->late, &last[i*LATE_MAX]);
+  for (attr = latelist; attr; attr = attr->nextlate)
+    attr->late->n = 0;
+
+  free (reqs);
+  free (last);
+}
+
+/* Sort key: MPI_COMM_WORLD rank */
+static int cmp_peer (const void *a, const void *b)
+{
+  return ((const Peerstats *) a)->rank1 - ((const Peerstats *) b)->rank1;
+}
+
+/*
+** GPTLprint_commstats: Print MPI stats by communicator (GPTLcomm_stats) and by peer
+**   (GPTLpeer_stats), summed over threads
+**
+** Input arguments:
+**   fp:       file descriptor to write to
+**   pmpi:     per-thread state of the wrappers
+**   nthreads: number of threads
+*/
+void GPTLprint_commstats (FILE *fp, const Pmpithread *pmpi, const int nthreads)
+{
+  Commstats sum;          /* stats of one communicator summed over threads */
+  Peerstats *peers;       /* peers of all threads */
+  Peerstats other;        /* peers beyond the hash tables */
+  int npeers;
+  int idx, slot, t, n, i;
+  static const char *thisfunc = "GPTLprint_commstats";
+
+  if (comm_stats) {
+    fprintf (fp, "\nMPI calls, time and bytes by communicator, summed over threads. Communicators\n"
+	     "are numbered in order of first use on this rank (%d used).\n", ncomm);
+    for (idx = 0; idx < MIN (ncomm, COMM_MAX+1); ++idx) {
+      memset (&sum, 0, sizeof (sum));
+      for (t = 0; t < nthreads; ++t)
+	if (pmpi[t].comm)
+	  for (slot = 0; slot < NSLOT; ++slot) {
+	    sum.count[slot] += pmpi[t].comm[idx].count[slot];
+	    sum.time[slot]  += pmpi[t].comm[idx].time[slot];
+	    sum.bytes[slot] += pmpi[t].comm[idx].bytes[slot];
+	  }
+
+      if (idx < COMM_MAX)
+	fprintf (fp, "\ncomm %d%s%s: %d ranks\n", idx, comminfo[idx].name[0] ? " " : "",
+		 comminfo[idx].name, comminfo[idx].size);
+      else
+	fprintf (fp, "\n%d communicators beyond the first %d:\n", ncomm - COMM_MAX, COMM_MAX);
+      fprintf (fp, "  %-24s %10s %10s %10s\n", "routine", "calls", "time", "bytes");
+      for (slot = 0; slot < NSLOT; ++slot) {
+	if (sum.count[slot] == 0)
+	  continue;
+	fprintf (fp, "  %-24s %10lu %10.3e %10.3e\n", slotname[slot], sum.count[slot],
+		 sum.time[slot], sum.bytes[slot]);
+      }
+    }
+  }
+
+  if (peer_stats) {
+    for (t = 0, npeers = 0; t < nthreads; ++t)
+      npeers += pmpi[t].npeer;
+    if ( ! (peers = (Peerstats *) GPTLallocate (MAX (npeers, 1) * sizeof (Peerstats), thisfunc)))
+      return;
+
+    memset (&other, 0, sizeof (other));
+    for (t = 0, n = 0; t < nthreads; ++t) {
+      if ( ! pmpi[t].peer)
+	continue;
+      for (i = 0; i < PEER_MAX; ++i)
+	if (pmpi[t].peer[i].rank1 != 0)
+	  peers[n++] = pmpi[t].peer[i];
+      other.nsend     += pmpi[t].peer[PEER_MAX].nsend;
+      other.nrecv     += pmpi[t].peer[PEER_MAX].nrecv;
+      other.sendbytes += pmpi[t].peer[PEER_MAX].sendbytes;
+      other.recvbytes += pmpi[t].peer[PEER_MAX].recvbytes;
+      other.sendtime  += pmpi[t].peer[PEER_MAX].sendtime;
+      other.recvtime  += pmpi[t].peer[PEER_MAX].recvtime;
+    }
+    qsort (peers, npeers, sizeof (Peerstats), cmp_peer);
+
+    /* Merge entries of the same peer from different threads */
+    for (i = 0, n = 0; i < npeers; ++i) {
+      if (n > 0 && peers[n-1].rank1 == peers[i].rank1) {
+	peers[n-1].nsend     += peers[i].nsend;
+	peers[n-1].nrecv     += peers[i].nrecv;
+	peers[n-1].sendbytes += peers[i].sendbytes;
+	peers[n-1].recvbytes += peers[i].recvbytes;
+	peers[n-1].sendtime  += peers[i].sendtime;
+	peers[n-1].recvtime  += peers[i].recvtime;
+      } else {
+	peers[n++] = peers[i];
+      }
+    }
+
+    fprintf (fp, "\nMPI point-to-point calls, time and bytes by peer (MPI_COMM_WORLD rank), summed\n"
+	     "over threads. MPI_Sendrecv counts as a send and a receive, each with the whole\n"
+	     "call time. Nonblocking calls count the time to post them, and MPI_ANY_SOURCE\n"
+	     "receives are counted only where the status gives the source.\n");
+    fprintf (fp, "%8s %10s %10s %10s %10s %10s %10s\n", "peer", "sends", "send_bytes", "send_time",
+	     "recvs", "recv_bytes", "recv_time");
+    for (i = 0; i < n; ++i)
+      fprintf (fp, "%8d %10lu %10.3e %10.3e %10lu %10.3e %10.3e\n", peers[i].rank1 - 1,
+	       peers[i].nsend, peers[i].sendbytes, peers[i].sendtime,
+	       peers[i].nrecv, peers[i].recvbytes, peers[i].recvtime);
+    if (other.nsend + other.nrecv > 0)
+      fprintf (fp, "%8s %10lu %10.3e %10.3e %10lu %10.3e %10.3e\n", "other",
+	       other.nsend, other.sendbytes, other.sendtime,
+	       other.nrecv, other.recvbytes, other.recvtime);
+    fprintf (fp, "\n");
+    free (peers);
+  }
+}
+
+/*
+** GPTLprint_reqstats: Print the lifecycle of nonblocking requests (GPTLreq_stats) by
+**   posting routine, summed over threads
+**
+** Input arguments:
+**   fp:       file descriptor to write to
+**   pmpi:     per-thread state of the wrappers
+**   nthreads: number of threads
+*/
+void GPTLprint_reqstats (FILE *fp, const Pmpithread *pmpi, const int nthreads)
+{
+  Reqstats sum;             /* summed over threads */
+  unsigned long inflight;   /* requests not completed yet */
+  unsigned long untracked;
+  int slot, t;
+
+  if ( ! req_stats)
+    return;
+
+  memset (&sum, 0, sizeof (sum));
+  inflight = 0;
+  untracked = 0;
+  for (t = 0; t < nthreads; ++t) {
+    if ( ! pmpi[t].reqstats)
+      continue;
+    for (slot = 0; slot < NSLOT; ++slot) {
+      sum.count[slot]    += pmpi[t].reqstats->count[slot];
+      sum.inflight[slot] += pmpi[t].reqstats->inflight[slot];
+      sum.blocked[slot]  += pmpi[t].reqstats->blocked[slot];
+    }
+    inflight  += pmpi[t].nreq;
+    untracked += pmpi[t].untracked;
+  }
+
+  fprintf (fp, "\nMPI nonblocking requests by posting routine, summed over threads. in_flight\n"
+	   "is the time from the end of the post to the end of the wait or test call which\n"
+	   "completed the request. blocked is the time in wait and test calls on it, each\n"
+	   "call's time shared evenly among its tracked requests. overlap is the part of\n"
+	   "in_flight not blocked, i.e. available to overlap with computation.\n");
+  fprintf (fp, "  %-24s %10s %10s %10s %8s\n", "routine", "requests", "in_flight", "blocked",
+	   "overlap%");
+  for (slot = 0; slot < NSLOT; ++slot) {
+    if (sum.count[slot] == 0)
+      continue;
+    fprintf (fp, "  %-24s %10lu %10.3e %10.3e ", slotname[slot], sum.count[slot],
+	     sum.inflight[slot], sum.blocked[slot]);
+    if (sum.inflight[slot] > 0.)
+      fprintf (fp, "%8.1f\n", 100. * MAX (0., 1. - sum.blocked[slot] / sum.inflight[slot]));
+    else
+      fprintf (fp, "%8s\n", "-");
+  }
+  if (inflight > 0)
+    fprintf (fp, "%lu requests were still in flight, or were completed outside the wrappers\n",
+	     inflight);
+  if (untracked > 0)
+    fprintf (fp, "%lu requests were not tracked: more than %d in flight on a thread\n",
+	     untracked, 3 * REQ_MAX / 4);
+  fprintf (fp, "\n");
+}
+
+/*
+** GPTLget_clock_offset: Get this rank's clock offset from rank 0, measured at MPI_Init
+**   if GPTLclock_sync was set, so timestamps of all ranks can be put on one clock:
+**   rank 0 time = t + offset + drift * t for a wallclock timestamp t of this rank, as
+**   returned by GPTLstamp. Drift is 0 until MPI_Finalize with GPTLclock_sync = 2.
+**
+** Output arguments:
+**   offset: offset in seconds at timestamp 0
+**   drift:  rate of change of the offset, seconds per second
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+int GPTLget_clock_offset (double *offset, double *drift)
+{
+  if (clocksynced == 0)
+    return GPTLerror ("GPTLget_clock_offset: clocks were not synchronized. "
+		      "Set GPTLclock_sync before MPI_Init\n");
+
+  *offset = globaltime (0.);
+  *drift = clockdrift;
+  return 0;
+}
+
+/*
+** GPTLprint_latestats: Print the clock offset from rank 0 (GPTLclock_sync), and the
+**   estimated wait for the last rank in each collective routine (GPTLlate_stats). Calls
+**   count once their communicator's log has been exchanged, i.e. all of them when
+**   printed from MPI_Finalize.
+**
+** Input arguments:
+**   fp: file descriptor to write to
+*/
+void GPTLprint_latestats (FILE *fp)
+{
+  int slot;
+
+  if (clocksynced > 0) {
+    fprintf (fp, "\nClock offset from rank 0 by ping-pong: %.6e seconds +- %.1e",
+	     globaltime (0.), clockerr);
+    if (clocksynced > 1)
+      fprintf (fp, ", drift %.3e seconds per second\n", clockdrift);
+    else
+      fprintf (fp, ", drift not estimated\n");
+  }
+
+  if ( ! late_stats)
+    return;
+
+  fprintf (fp, "\nMPI collective wait for the last rank, estimated without barriers from the\n"
+	   "entry times of all ranks: wait is the time in the call before the last rank\n"
+	   "entered it. For rooted collectives it is an upper bound. %s\n",
+	   (clocksynced > 0) ? "Clocks are aligned\nto rank 0 by ping-pong (GPTLclock_sync)." :
+	   "Clocks of different\nnodes are assumed to agree.");
+  fprintf (fp, "  %-24s %10s %10s %10s %8s\n", "routine", "calls", "time", "wait", "%wait");
+  for (slot = 0; slot < NSLOT; ++slot) {
+    if (latecount[slot] == 0)
+      continue;
+    fprintf (fp, "  %-24s %10lu %10.3e %10.3e ", slotname[slot], latecount[slot],
+	     latetime[slot], latewait[slot]);
+    if (latetime[slot] > 0.)
+      fprintf (fp, "%8.1f\n", 100. * latewait[slot] / latetime[slot]);
+    else
+      fprintf (fp, "%8s\n", "-");
+  }
+  fprintf (fp, "\n");
+}
+
+#else   /* ENABLE_PMPI not set */
+
+int GPTLpmpi_setoption (const int option,
+			const int val)
+{
+  return GPTLerror ("GPTLpmpi_setoption: GPTL needs to be built with ENABLE_PMPI=yes "
+		    "to set option %d\n", option);
+}
+
+int GPTLget_clock_offset (double *offset, double *drift)
+{
+  return GPTLerror ("GPTLget_clock_offset: GPTL needs to be built with ENABLE_PMPI=yes\n");
 }
 
 #endif
@@ -0,0 +1,322 @@
+/*
+** pr_shared.c
+**
+** Write the per-rank reports of GPTLpr_file into a single indexed file, and extract
+** one rank's report from such a file. With tens of thousands of ranks, creating one
+** timing.<rank> file each at MPI_Finalize is a metadata storm on a parallel file system.
+**
+** File layout: a fixed-length header line, then one fixed-length index line per rank,
+** then the sections. Every line of the header and index is LINELEN bytes (space
+** padded, newline terminated), so entry r is at LINELEN*(1+r) and any rank's report
+** can be located with two seeks. Each section is a one-line banner followed by the
+** report exactly as GPTLpr_file would have written it; the index points at the report.
+*/
+
+#include "config.h" /* Must be first include. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <sys/types.h>     /* off_t */
+
+#include "private.h"
+#include "gptl.h"
+
+#define LINELEN 80         /* bytes per header or index line, including newline */
+#define COPYBUF (1024*1024)
+
+static const char *magic = "GPTL shared timing file version 1";
+
+static int render (const int, Outbuf *, size_t *);
+static void fmtline (char *, const char *, ...);
+
+#ifdef HAVE_LIBMPI
+#include <mpi.h>
+
+/*
+** GPTLpr_shared_file: Collectively write the reports of all ranks of comm into outfile
+**   with MPI-IO. Each rank renders its report in memory, an exclusive prefix sum of the
+**   report sizes gives each rank its file offset, and every rank writes its index entry
+**   and its section with one collective call each.
+**
+** Input arguments:
+**   comm:    communicator (e.g. MPI_COMM_WORLD). If zero or MPI_COMM_NULL, use MPI_COMM_WORLD
+**   outfile: name of file to be written
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+int GPTLpr_shared_file (MPI_Comm comm, const char *outfile)
+{
+  int ret;                  /* return code */
+  int iam;                  /* my rank */
+  int nranks;               /* number of ranks in communicator */
+  Outbuf ob;                /* my section, rendered in memory */
+  size_t bannerlen;         /* length of the banner preceding my report */
+  long long mylen;          /* length of my section */
+  long long myoff = 0;      /* offset of my section from the start of the sections */
+  long long start;          /* file offset of the first section */
+  char head[2*LINELEN+1];   /* header line (rank 0 only) and my index line */
+  char *entry;              /* my index line within head */
+  int nhead;                /* bytes of head to write */
+  int ok;                   /* whether all ranks rendered and wrote successfully */
+  int allok;
+  MPI_File fh;
+  MPI_Offset off;           /* file offset for my writes */
+  static const char *thisfunc = "GPTLpr_shared_file";
+
+  if ( ! GPTLis_initialized ())
+    return GPTLerror ("%s: GPTLinitialize() has not been called\n", thisfunc);
+
+  /* Compare as handles: MPI_Comm is an integer in some MPIs and a pointer in others */
+  if (comm == MPI_COMM_NULL || comm == (MPI_Comm) 0)
+    comm = MPI_COMM_WORLD;
+
+  if ((ret = MPI_Comm_rank (comm, &iam)) != MPI_SUCCESS)
+    return GPTLerror ("%s: Bad return from MPI_Comm_rank=%d\n", thisfunc, ret);
+
+  if ((ret = MPI_Comm_size (comm, &nranks)) != MPI_SUCCESS)
+    return GPTLerror ("%s rank %d: Bad return from MPI_Comm_size=%d\n", thisfunc, iam, ret);
+
+  /* A rank which fails to render still takes part in the collectives, with an empty section */
+  ok = (render (iam, &ob, &bannerlen) == 0);
+  if ( ! ok || ob.len > (size_t) 0x7fffffff) {
+    free (ob.buf);
+    ob.buf = 0;
+    ob.len = 0;
+    bannerlen = 0;
+    ok = 0;
+  }
+  mylen = (long long) ob.len;
+
+  if ((ret = MPI_Exscan (&mylen, &myoff, 1, MPI_LONG_LONG, MPI_SUM, comm)) != MPI_SUCCESS)
+    return GPTLerror ("%s rank %d: Bad return from MPI_Exscan=%d\n", thisfunc, iam, ret);
+  if (iam == 0)
+    myoff = 0;       /* MPI_Exscan leaves rank 0's result undefined */
+  start = (long long) LINELEN * (1 + nranks);
+
+  /* Rank 0 writes the header line contiguous with its own index line */
+  nhead = 0;
+  if (iam == 0) {
+    fmtline (head, "%s: nranks=%d linelen=%d", magic, nranks, LINELEN);
+    nhead = LINELEN;
+  }
+  entry = head + nhead;
+  fmtline (entry, "rank=%d offset=%lld length=%lld", iam,
+	   start + myoff + (long long) bannerlen, mylen - (long long) bannerlen);
+  nhead += LINELEN;
+
+  if ((ret = MPI_File_open (comm, (char *) outfile, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+			    MPI_INFO_NULL, &fh)) != MPI_SUCCESS) {
+    free (ob.buf);
+    return GPTLerror ("%s rank %d: cannot open %s: MPI_File_open=%d\n",
+		      thisfunc, iam, outfile, ret);
+  }
+
+  /* Discard any longer file left by an earlier run */
+  if (MPI_File_set_size (fh, 0) != MPI_SUCCESS)
+    ok = 0;
+
+  off = (iam == 0) ? 0 : (MPI_Offset) LINELEN * (1 + iam);
+  if (MPI_File_write_at_all (fh, off, head, nhead, MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS)
+    ok = 0;
+
+  off = (MPI_Offset) (start + myoff);
+  if (MPI_File_write_at_all (fh, off, ob.buf, (int) ob.len, MPI_BYTE,
+			     MPI_STATUS_IGNORE) != MPI_SUCCESS)
+    ok = 0;
+
+  if (MPI_File_close (&fh) != MPI_SUCCESS)
+    ok = 0;
+  free (ob.buf);
+
+  if ((ret = MPI_Allreduce (&ok, &allok, 1, MPI_INT, MPI_LAND, comm)) != MPI_SUCCESS)
+    return GPTLerror ("%s rank %d: Bad return from MPI_Allreduce=%d\n", thisfunc, iam, ret);
+  if ( ! ok)
+    return GPTLerror ("%s rank %d: failed to write my section of %s\n", thisfunc, iam, outfile);
+  if ( ! allok)
+    return GPTLerror ("%s rank %d: some ranks failed to write their section of %s\n",
+		      thisfunc, iam, outfile);
+  return 0;
+}
+
+#else
+
+/*
+** GPTLpr_shared_file: No MPI. Write a shared file holding the single report of this
+**   process, so the same reader can be used with and without MPI.
+**
+** Input arguments:
+**   outfile: name of file to be written
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+int GPTLpr_shared_file (const char *outfile)
+{
+  FILE *fp;                 /* file handle to write to */
+  Outbuf ob;                /* the report, rendered in memory */
+  Outbuf out;               /* buffered output state for fp */
+  size_t bannerlen;         /* length of the banner preceding the report */
+  char line[LINELEN+1];
+  int ret = 0;
+  static const char *thisfunc = "GPTLpr_shared_file";
+
+  if ( ! GPTLis_initialized ())
+    return GPTLerror ("%s: GPTLinitialize() has not been called\n", thisfunc);
+
+  if (render (0, &ob, &bannerlen) != 0) {
+    free (ob.buf);
+    return GPTLerror ("%s: failure rendering report\n", thisfunc);
+  }
+
+  if ( ! (fp = GPTLoutbuf_open (&out, outfile))) {
+    free (ob.buf);
+    return GPTLerror ("%s: cannot open %s\n", thisfunc, outfile);
+  }
+
+  fmtline (line, "%s: nranks=%d linelen=%d", magic, 1, LINELEN);
+  fwrite (line, 1, LINELEN, fp);
+  fmtline (line, "rank=%d offset=%lld length=%lld", 0,
+	   (long long) (2*LINELEN + bannerlen), (long long) (ob.len - bannerlen));
+  fwrite (line, 1, LINELEN, fp);
+  fwrite (ob.buf, 1, ob.len, fp);
+  free (ob.buf);
+
+  if (GPTLoutbuf_close (&out) != 0)
+    ret = GPTLerror ("%s: Attempt to close %s failed\n", thisfunc, outfile);
+  return ret;
+}
+
+#endif
+
+/*
+** GPTLextract_shared: Copy one rank's report out of a file written by GPTLpr_shared_file.
+**   Only the header, that rank's index line and its report are read.
+**
+** Input arguments:
+**   infile:  shared file to read
+**   rank:    rank whose report is wanted
+**   outfile: file to write the report to (e.g. "timing.<rank>")
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+int GPTLextract_shared (const char *infile, const int rank, const char *outfile)
+{
+  FILE *in;                 /* shared file */
+  FILE *out;                /* extracted report */
+  Outbuf ob;                /* buffered output state for out */
+  char line[LINELEN+1];
+  char *buf;                /* copy buffer */
+  int nranks;               /* number of ranks in the shared file */
+  int linelen;              /* line length recorded in the shared file */
+  int r;                    /* rank recorded in the index line */
+  long long offset, length; /* location of the report */
+  size_t n;                 /* bytes to copy this iteration */
+  int ret = 0;
+  static const char *thisfunc = "GPTLextract_shared";
+
+  if ( ! (in = fopen (infile, "r")))
+    return GPTLerror ("%s: cannot open %s\n", thisfunc, infile);
+
+  line[LINELEN] = '\0';
+  if (fread (line, 1, LINELEN, in) != LINELEN ||
+      strncmp (line, magic, strlen (magic)) != 0 ||
+      sscanf (line + strlen (magic), ": nranks=%d linelen=%d", &nranks, &linelen) != 2 ||
+      linelen != LINELEN) {
+    (void) fclose (in);
+    return GPTLerror ("%s: %s is not a GPTL shared timing file\n", thisfunc, infile);
+  }
+
+  if (rank < 0 || rank >= nranks) {
+    (void) fclose (in);
+    return GPTLerror ("%s: rank %d is not in %s, which holds %d ranks\n",
+		      thisfunc, rank, infile, nranks);
+  }
+
+  if (fseeko (in, (off_t) LINELEN * (1 + rank), SEEK_SET) != 0 ||
+      fread (line, 1, LINELEN, in) != LINELEN ||
+      sscanf (line, "rank=%d offset=%lld length=%lld", &r, &offset, &length) != 3 ||
+      r != rank || offset < 0 || length < 0 ||
+      fseeko (in, (off_t) offset, SEEK_SET) != 0) {
+    (void) fclose (in);
+    return GPTLerror ("%s: bad index entry for rank %d in %s\n", thisfunc, rank, infile);
+  }
+
+  if ( ! (buf = (char *) GPTLallocate (COPYBUF, thisfunc))) {
+    (void) fclose (in);
+    return -1;
+  }
+
+  if ( ! (out = GPTLoutbuf_open (&ob, outfile))) {
+    free (buf);
+    (void) fclose (in);
+    return GPTLerror ("%s: cannot open %s\n", thisfunc, outfile);
+  }
+
+  while (length > 0) {
+    n = (size_t) MIN (length, COPYBUF);
+    if (fread (buf, 1, n, in) != n) {
+      ret = GPTLerror ("%s: %s is truncated in the report for rank %d\n",
+		       thisfunc, infile, rank);
+      break;
+    }
+    fwrite (buf, 1, n, out);
+    length -= n;
+  }
+
+  if (GPTLoutbuf_close (&ob) != 0 && ret == 0)
+    ret = GPTLerror ("%s: Attempt to close %s failed\n", thisfunc, outfile);
+  free (buf);
+  (void) fclose (in);
+  return ret;
+}
+
+/*
+** render: Format this process's report into memory, preceded by a banner line
+**
+** Input arguments:
+**   iam: rank number for the banner
+**
+** Output arguments:
+**   ob:        ob->buf and ob->len hold the section. Caller frees ob->buf.
+**   bannerlen: length of the banner
+**
+** Return value: 0 (success) or -1 (failure)
+*/
+static int render (const int iam, Outbuf *ob, size_t *bannerlen)
+{
+  FILE *fp;
+  int nc;
+  int ret;
+
+  *bannerlen = 0;
+  if ( ! (fp = GPTLoutbuf_openmem (ob)))
+    return -1;
+
+  if ((nc = fprintf (fp, "\n======== GPTL timing for rank %d ========\n", iam)) > 0)
+    *bannerlen = nc;
+  ret = GPTLprint_report (fp);
+  if (GPTLoutbuf_closemem (ob) != 0)
+    return -1;
+  return ret;
+}
+
+/*
+** fmtline: Format a header or index line: space padded to LINELEN-1, then newline
+*/
+static void fmtline (char *line, const char *fmt, ...)
+{
+  va_list args;
+  int nc;
+
+  va_start (args, fmt);
+  nc = vsnprintf (line, LINELEN, fmt, args);
+  va_end (args);
+
+  if (nc < 0)
+    nc = 0;
+  nc = MIN (nc, LINELEN-1);
+  memset (line + nc, ' ', LINELEN-1 - nc);
+  line[LINELEN-1] = '\n';
+  line[LINELEN] = '\0';
+}
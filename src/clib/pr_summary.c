@@ -7,9 +7,18 @@
 #include "private.h"
 #include "gptl.h"
 
+/* Compensated (Kahan-Neumaier) sum: the value is sum + c */
+typedef struct {
+  double sum;              /* running sum */
+  double c;                /* accumulated rounding error of sum */
+} Ksum;
+
 /* MPI summary stats */
 typedef struct {
-  unsigned long totcalls;  /* number of calls to the region across threads and tasks */
+  unsigned long long totcalls; /* number of calls to the region across threads and tasks */
+  Ksum wallsum;            /* time summed across threads, tasks (for hotspots) */
+  Ksum exclsum;            /* exclusive time summed across threads, tasks */
+  Ksum ohdsum;             /* estimated GPTL overhead summed across threads, tasks */
 #ifdef HAVE_PAPI
   double papimax[MAX_AUX]; /* max counter value across threads, tasks */
   double papimin[MAX_AUX]; /* max counter value across threads, tasks */
@@ -20,18 +29,23 @@ typedef struct {
 #endif
   unsigned int notstopped; /* number of ranks+threads for whom the timer is ON */
   unsigned int tottsk;     /* number of tasks which invoked this region */
-  float wallmax;           /* max time across threads, tasks */
-  float wallmin;           /* min time across threads, tasks */
-  float mean;              /* accumulated mean */
-  float m2;                /* from Chan, et. al. */
+  double wallmax;          /* max time across threads, tasks */
+  double wallmin;          /* min time across threads, tasks */
+  double mean;             /* accumulated mean */
+  double m2;               /* from Chan, et. al. */
+  Sketch sketch;           /* per-rank max time across threads, for median and p95 */
   int wallmax_p;           /* task producing wallmax */
   int wallmax_t;           /* thread producing wallmax */
   int wallmin_p;           /* task producing wallmin */
   int wallmin_t;           /* thread producing wallmin */
+  double nodeimb;          /* max across nodes of node imbalance: % wallmax exceeds mean */
+  int nodeimb_p;           /* task (node leader) of the node producing nodeimb */
   char name[MAX_CHARS+1];  /* timer name */
 } Global;
 
-static void get_threadstats (int, char *, Timer **, Global *);
+static void get_threadstats (int, char *, Timer **, double, Global *);
+static void ksum_add (Ksum *, const double);
+static double ksum_val (const Ksum *);
 static Timer *getentry_slowway (Timer *, char *);
 static int nthreads;  /* Used by both GPTLpr_summary() and get_threadstats() */
 
@@ -45,7 +59,9 @@ static int nthreads;  /* Used by both GPTLpr_summary() and get_threadstats() */
 **                      When MPI enabled, gather and print summary stats across threads
 **                      and MPI tasks. The communication algorithm is O(log nranks) so
 **                      it easily scales to thousands of ranks. Added local memory usage 
-**                      is 2*(number_of_regions)*sizeof(Global) on each rank.
+**                      is 2*(number_of_regions)*sizeof(Global) on each rank. With MPI-3
+**                      the merge is done within each node first, then across nodes,
+**                      which also yields a per-node load imbalance column.
 **
 ** Input arguments:
 **   comm:    communicator (e.g. MPI_COMM_WORLD). If zero, use MPI_COMM_WORLD
@@ -54,38 +70,60 @@ static int nthreads;  /* Used by both GPTLpr_summary() and get_threadstats() */
 
 #ifdef HAVE_LIBMPI
 #include <mpi.h>
+
+/* Upper bound on the packed size of one Global: each field packs to no more than its size */
+#define PACK_MAX (sizeof (Global) + 2)
+
+/* Max ranks sending to one rank in tree_merge: one per bit of a rank number */
+#define MAXCHILD (8 * sizeof (int))
+
+/*
+** A rank's send of its merged stats to its parent in tree_merge. Each rank sends at most
+** once per summary, and the send is completed only by send_complete at the end of
+** GPTLpr_summary_file, so the rank goes on while the parent receives.
+*/
+typedef struct {
+  MPI_Request reqs[2];  /* header and packed stats */
+  int hdr[3];           /* message header: nregions, multithread, bytes of packed stats */
+  char *buf;            /* packed stats, freed once sent */
+} Sendreq;
+
+static int tree_merge (MPI_Comm, const int, Global **, int *, int *, int *, Sendreq *);
+static int send_complete (Sendreq *, const int);
+#if ( MPI_VERSION >= 3 )
+static int node_merge (MPI_Comm, const int, Global **, int *, int *, int *, Sendreq *, int *);
+#endif
+static int merge_stats (const char *, const int *, const int, const int,
+			Global **, int *, int *, int *);
+static size_t pack_global (char *, const Global *);
+static size_t unpack_global (const char *, Global *);
+static void ksum_merge (Ksum *, const Ksum *);
+
 int GPTLpr_summary_file (MPI_Comm comm, const char *outfile)       /* communicator */
 {
   int ret;             /* return code */
   int iam;             /* my rank */
   int nranks;          /* number of ranks in communicator */
   int nregions;        /* number of regions aggregated across all tasks */
-  int nregions_p;      /* number of regions for a single task */
-  int n, nn;           /* region index */
-  int i;               /* index */
+  int n;               /* region index */
   Timer *ptr;          /* linked list pointer */
   Timer **timers;
-  int incr;            /* increment for tree sum */
-  int twoincr;         /* 2*incr */
-  int dosend;          /* logical indicating whether to send this iteration */
-  int dorecv;          /* logical indicating whether to recv this iteration */
-  int sendto;          /* rank to send to */
-  int p;               /* rank to recv fm */
   int mnl;             /* max name length across all threads and tasks */
-  MPI_Status status;   /* required by MPI_Recv */
-  int extraspace;      /* for padding to length of longest name */
   int multithread;     /* flag indicates multithreaded or not for any task */
-  int multithread_p;   /* recvd flag for other processor indicates multithreaded or not */
   Global *global;      /* stats to be printed accumulated across tasks */
-  Global *global_p;    /* stats to be printed for a single task */
-  Global *sptr;        /* realloc intermediate */
-  float delta;         /* from Chan, et. al. */
-  float sigma;         /* st. dev. */
-  unsigned int tsksum; /* part of Chan, et. al. equation */
-  static const int tag = 98789;                         /* tag for MPI message */
-  static const int nbytes = sizeof (Global);            /* number of bytes to be sent/recvd */
+  Hotspot *spots;      /* regions to be ranked by GPTLprint_hotspots */
+  int nspots;          /* number of entries in spots */
+  Imbal *imb;          /* regions to be ranked by GPTLprint_imbalance */
+  Dumprec *recs;       /* regions to be written by GPTLwrite_dump */
+  double self_ohd;     /* estimated per-call overhead in the timer itself */
+  double parent_ohd;   /* estimated per-call overhead subsumed into the parent */
+  double sigma;        /* st. dev. */
+  double median, p95;   /* percentiles across ranks */
+  int nnodes;          /* number of shared-memory nodes (0 if not merged by node) */
+  Sendreq send = {{MPI_REQUEST_NULL, MPI_REQUEST_NULL}, {0, 0, 0}, 0};  /* to my parent */
   static const char *thisfunc = "GPTLpr_summary_file";  /* this function */
   FILE *fp = 0;        /* file handle to write to */
+  Outbuf ob;           /* buffered output state for fp */
 #ifdef HAVE_PAPI
   int e;               /* event index */
 #endif
@@ -117,134 +155,43 @@ int GPTLpr_summary_file (MPI_Comm comm, const char *outfile)       /* communicat
   timers = GPTLget_timersaddr ();
   nthreads = GPTLget_nthreads ();   /* get_threadstats() needs to know this value too */
   multithread = (nthreads > 1);
+  (void) GPTLget_overhead_est (&self_ohd, &parent_ohd);
 
   for (ptr = timers[0]->next; ptr; ptr = ptr->next) {
-    get_threadstats (iam, ptr->name, timers, &global[n]);
+    get_threadstats (iam, ptr->name, timers, self_ohd + parent_ohd, &global[n]);
     mnl = MAX (strlen (ptr->name), mnl);
 
     /* Initialize for calculating mean, st. dev. */
     global[n].mean   = global[n].wallmax;
     global[n].m2     = 0.;
     global[n].tottsk = 1;
+    GPTLsketch_init (&global[n].sketch, global[n].wallmax);
     ++n;
   }
   if (n != nregions)
     GPTLwarn ("%s rank %d: Bad logic caused n=%d and nregions=%d\n", thisfunc, iam, n, nregions);
 
   /*
-  ** If all ranks participate in a region, could use MPI_Reduce to get mean and variance.
-  ** But we can't assume that, so instead code the parallel algorithm by hand. 
-  ** Log(ntask) algorithm to gather results to a single task is Jim Rosinski's concoction.
-  ** One-pass algorithm for gathering mean and standard deviation comes from Chan et. al.
-  ** (1979) described in: http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
-  ** Discovered by googling for "one pass standard deviation" which found the Wikipedia
-  ** page pointing to the Chan et. al. work. I'm not enough of a statistical whiz to
-  ** be able to map the simple 3-line algorithm in the Wikipedia page (see "Parallel 
-  ** algorithm") to anything in the Chan et. al. work, but it does work.
+  ** Merge first within each shared-memory node, then across node leaders: with many ranks
+  ** per node this cuts inter-node messages by a factor of ranks-per-node, and the node-level
+  ** results give each node's load imbalance. Rank 0 of comm is rank 0 of its node, so it
+  ** ends up holding the global result either way.
   */
-  for (incr = 1; incr < nranks; incr = twoincr) {
-    twoincr = 2*incr;
-    sendto = iam - incr;
-    p = iam + incr;      /* could rename p as recvfm */
-
-    /* 
-    ** The && part of the next 2 stmts prevents sending to or receiving from
-    ** outside communicator bounds when nranks is not a power of 2
-    */
-    dorecv = ((iam + twoincr) % twoincr == 0) && (p < nranks);
-    dosend = ((iam + incr) % twoincr == 0) && (sendto > -1);
-    if (dosend) {
-      if (dorecv)
-        printf ("%s: WARNING: iam=%d: dosend and dorecv both true: possible hang?\n", thisfunc, iam);
-
-      if ((ret = MPI_Send (&nregions, 1, MPI_INT, sendto, tag, comm)) != MPI_SUCCESS)
-        return GPTLerror ("%s rank %d: Bad return from MPI_Send=%d\n", thisfunc, iam, ret);
-      if ((ret = MPI_Send (&multithread, 1, MPI_INT, sendto, tag, comm)) != MPI_SUCCESS)
-        return GPTLerror ("%s rank %d: Bad return from MPI_Send=%d\n", thisfunc, iam, ret);
-      if ((ret = MPI_Send (global, nbytes*nregions, MPI_BYTE, sendto, tag, comm)) != MPI_SUCCESS)
-        return GPTLerror ("%s rank %d: Bad return from MPI_Send=%d\n", thisfunc, iam, ret);
-    }
-
-    if (dorecv) {
-      if (dosend)
-        printf ("%s: WARNING: iam=%d: dosend and dorecv both true: possible hang?\n", thisfunc, iam);
-
-      if ((ret = MPI_Recv (&nregions_p, 1, MPI_INT, p, tag, comm, &status)) != MPI_SUCCESS)
-        return GPTLerror ("%s rank %d: Bad return from MPI_Recv=%d\n", thisfunc, iam, ret);
-      if ((ret = MPI_Recv (&multithread_p, 1, MPI_INT, p, tag, comm, &status)) != MPI_SUCCESS)
-        return GPTLerror ("%s rank %d: Bad return from MPI_Recv=%d\n", thisfunc, iam, ret);
-      if (multithread_p)
-        multithread = true;
-
-      global_p = (Global *) GPTLallocate (nregions_p * sizeof (Global), thisfunc);
-      ret = MPI_Recv (global_p, nbytes*nregions_p, MPI_BYTE, p, tag, comm, &status);
-      if (ret != MPI_SUCCESS)
-        return GPTLerror ("%s rank %d: Bad return from MPI_Recv=%d\n", thisfunc, iam, ret);
-      
-      /* Merge stats for task p with our current stats */
-      for (n = 0; n < nregions_p; ++n) {
-        for (nn = 0; nn < nregions; ++nn) {
-          if (STRMATCH (global_p[n].name, global[nn].name)) {
-            break;
-          }
-        }
-
-        if (nn == nregions) {  /* new region: reallocate and copy stats */
-          ++nregions;
-          sptr = realloc (global, nregions * sizeof (Global));
-          if ( ! sptr)
-            return GPTLerror ("%s: realloc error", thisfunc);
-          global = sptr;
-          /* IMPORTANT: structure copy only works because it contains NO pointers (only arrays) */
-          global[nn] = global_p[n];
-          mnl = MAX (strlen (global[nn].name), mnl);
-
-        } else {               /* adjust stats for region */
-
-	  /* Won't print this entry if it was on for any rank or thread */
-	  global[nn].notstopped += global_p[n].notstopped;
-          global[nn].totcalls   += global_p[n].totcalls; /* count is cumulative */
-          if (global_p[n].wallmax > global[nn].wallmax) {
-            global[nn].wallmax   = global_p[n].wallmax;
-            global[nn].wallmax_p = global_p[n].wallmax_p;
-            global[nn].wallmax_t = global_p[n].wallmax_t;
-          }
-          if (global_p[n].wallmin < global[nn].wallmin) {
-            global[nn].wallmin   = global_p[n].wallmin;
-            global[nn].wallmin_p = global_p[n].wallmin_p;
-            global[nn].wallmin_t = global_p[n].wallmin_t;
-          }
-
-          /* Mean, variance calcs. Cast to float avoids possible integer overflow */
-          tsksum = global_p[n].tottsk + global[nn].tottsk;
-          delta  = global_p[n].mean   - global[nn].mean;
-          global[nn].mean += (delta * global_p[n].tottsk) / tsksum;
-          global[nn].m2   += global_p[n].m2 + 
-            delta * delta * ((float) global_p[n].tottsk * global[nn].tottsk) / tsksum;
-          global[nn].tottsk = tsksum;
-
-#ifdef HAVE_PAPI
-          for (e = 0; e < GPTLnevents; ++e) {
-            if (global_p[n].papimax[e] > global[nn].papimax[e]) {
-              global[nn].papimax[e]   = global_p[n].papimax[e];
-              global[nn].papimax_p[e] = global_p[n].papimax_p[e];
-              global[nn].papimax_t[e] = global_p[n].papimax_t[e];
-            }
-            if (global_p[n].papimin[e] < global[nn].papimin[e]) {
-              global[nn].papimin[e]   = global_p[n].papimin[e];
-              global[nn].papimin_p[e] = global_p[n].papimin_p[e];
-              global[nn].papimin_t[e] = global_p[n].papimin_t[e];
-            }
-          }
+  nnodes = 0;
+  ret = 1;
+#if ( MPI_VERSION >= 3 )
+  ret = node_merge (comm, iam, &global, &nregions, &multithread, &mnl, &send, &nnodes);
 #endif
-        }
-      }
-      free (global_p); /* done with received data this iteration */
-    }
+  if (ret > 0)
+    ret = tree_merge (comm, iam, &global, &nregions, &multithread, &mnl, &send);
+  if (ret != 0) {
+    (void) send_complete (&send, iam);
+    free (global);
+    return GPTLerror ("%s rank %d: failure merging across ranks\n", thisfunc, iam);
   }
 
   if (iam == 0) {
-    if ( ! (fp = fopen (outfile, "w"))) {
+    if ( ! (fp = GPTLoutbuf_open (&ob, outfile))) {
       fp = stderr;
       printf ("%s: WARNING: file=%s cannot be opened for writing. Using stderr instead\n",
 	      thisfunc, outfile);
@@ -258,24 +205,28 @@ int GPTLpr_summary_file (MPI_Comm comm, const char *outfile)       /* communicat
 
     /* Print heading */
     fprintf (fp, "Total ranks in communicator=%d\n", nranks);
+    if (nnodes > 0)
+      fprintf (fp, "Total shared-memory nodes=%d\n", nnodes);
     fprintf (fp, "nthreads on rank 0=%d\n", nthreads);
     fprintf (fp, "'N' used for mean, std. dev. calcs.: 'ncalls'/'nthreads'\n");
     fprintf (fp, "'ncalls': number of times the region was invoked across tasks and threads.\n");
     fprintf (fp, "'nranks': number of ranks which invoked the region.\n");
     fprintf (fp, "mean, std. dev: computed using per-rank max time across all threads on each rank\n");
+    fprintf (fp, "median, p95: percentiles across ranks of the same per-rank max time (exact up to %d ranks)\n",
+	     SKETCH_SIZE);
     fprintf (fp, "wallmax and wallmin: max, min time across tasks and threads.\n");
+    if (nnodes > 0)
+      fprintf (fp, "nodeimb: worst node's %% by which its max exceeds its mean, (rank) of its first task.\n");
 
-    fprintf (fp, "\nname");
-    extraspace = mnl - strlen ("name");
-    for (n = 0; n < extraspace; ++n)
-      fprintf (fp, " ");
-    fprintf (fp, "   ncalls nranks mean_time   std_dev   wallmax (rank  ");
+    fprintf (fp, "\n%-*s   ncalls nranks mean_time   std_dev    median       p95   wallmax (rank  ", mnl, "name");
     if (multithread)
       fprintf (fp, "thread");
     fprintf (fp, ")   wallmin (rank  ");
     if (multithread)
       fprintf (fp, "thread");
     fprintf (fp, ")");
+    if (nnodes > 0)
+      fprintf (fp, "   nodeimb (rank  )");
 
 #ifdef HAVE_PAPI
     for (e = 0; e < GPTLnevents; ++e) {
@@ -294,11 +245,7 @@ int GPTLpr_summary_file (MPI_Comm comm, const char *outfile)       /* communicat
 
     /* Loop over regions and print summarized timing stats */
     for (n = 0; n < nregions; ++n) {
-      fprintf (fp, "%s", global[n].name);
-      extraspace = mnl - strlen (global[n].name);
-
-      for (i = 0; i < extraspace; ++i)
-        fprintf (fp, " ");
+      fprintf (fp, "%-*s", mnl, global[n].name);
 
       /* 
       ** Don't print stats if the timer is currently on for any thread or task: too dangerous 
@@ -314,32 +261,36 @@ int GPTLpr_summary_file (MPI_Comm comm, const char *outfile)       /* communicat
         sigma = sqrt ((double) global[n].m2 / (global[n].tottsk - 1));
       else
         sigma = 0.;
+      median = GPTLsketch_quantile (&global[n].sketch, 0.5);
+      p95    = GPTLsketch_quantile (&global[n].sketch, 0.95);
 
       if (multithread) {  /* Threads and tasks */
         if (global[n].totcalls < PRTHRESH) {
-          fprintf (fp, " %8lu %6u %9.3f %9.3f %9.3f (%6d %5d) %9.3f (%6d %5d)", 
-                   global[n].totcalls, global[n].tottsk, global[n].mean, sigma, 
+          fprintf (fp, " %8llu %6u %9.3f %9.3f %9.3f %9.3f %9.3f (%6d %5d) %9.3f (%6d %5d)", 
+                   global[n].totcalls, global[n].tottsk, global[n].mean, sigma, median, p95,
                    global[n].wallmax, global[n].wallmax_p, global[n].wallmax_t, 
                    global[n].wallmin, global[n].wallmin_p, global[n].wallmin_t);
         } else {
-          fprintf (fp, " %8.1e %6u %9.3f %9.3f %9.3f (%6d %5d) %9.3f (%6d %5d)", 
-                   (float) global[n].totcalls, global[n].tottsk, global[n].mean, sigma, 
+          fprintf (fp, " %8.1e %6u %9.3f %9.3f %9.3f %9.3f %9.3f (%6d %5d) %9.3f (%6d %5d)", 
+                   (float) global[n].totcalls, global[n].tottsk, global[n].mean, sigma, median, p95,
                    global[n].wallmax, global[n].wallmax_p, global[n].wallmax_t, 
                    global[n].wallmin, global[n].wallmin_p, global[n].wallmin_t);
         }
       } else {  /* No threads */
         if (global[n].totcalls < PRTHRESH) {
-          fprintf (fp, " %8lu %6u %9.3f %9.3f %9.3f (%6d) %9.3f (%6d)", 
-                   global[n].totcalls, global[n].tottsk, global[n].mean, sigma, 
+          fprintf (fp, " %8llu %6u %9.3f %9.3f %9.3f %9.3f %9.3f (%6d) %9.3f (%6d)", 
+                   global[n].totcalls, global[n].tottsk, global[n].mean, sigma, median, p95,
                    global[n].wallmax, global[n].wallmax_p, 
                    global[n].wallmin, global[n].wallmin_p);
         } else {
-          fprintf (fp, " %8.1e %6u %9.3f %9.3f %9.3f (%6d) %9.3f (%6d)", 
-                   (float) global[n].totcalls, global[n].tottsk, global[n].mean, sigma, 
+          fprintf (fp, " %8.1e %6u %9.3f %9.3f %9.3f %9.3f %9.3f (%6d) %9.3f (%6d)", 
+                   (float) global[n].totcalls, global[n].tottsk, global[n].mean, sigma, median, p95,
                    global[n].wallmax, global[n].wallmax_p, 
                    global[n].wallmin, global[n].wallmin_p);
         }
       }
+      if (nnodes > 0)
+        fprintf (fp, " %9.2f (%6d)", global[n].nodeimb, global[n].nodeimb_p);
 
 #ifdef HAVE_PAPI
       for (e = 0; e < GPTLnevents; ++e) {
@@ -362,13 +313,535 @@ int GPTLpr_summary_file (MPI_Comm comm, const char *outfile)       /* communicat
 #endif
       fprintf (fp, "\n");
     }
-    if (fp != stderr && fclose (fp) != 0)
+
+    spots = (Hotspot *) GPTLallocate (MAX (nregions, 1) * sizeof (Hotspot), thisfunc);
+    nspots = 0;
+    for (n = 0; n < nregions; ++n) {
+      if (global[n].notstopped == 0) {
+	spots[nspots].name  = global[n].name;
+	spots[nspots].incl  = ksum_val (&global[n].wallsum);
+	spots[nspots].excl  = ksum_val (&global[n].exclsum);
+	spots[nspots].ohd   = ksum_val (&global[n].ohdsum);
+	spots[nspots].count = global[n].totcalls;
+	++nspots;
+      }
+    }
+    GPTLprint_hotspots (fp, spots, nspots, "summed over ranks and threads");
+    GPTLprint_ohdwarn (fp, spots, nspots, self_ohd + parent_ohd);
+    free (spots);
+
+    /* Imbalance across ranks of each rank's max over its threads */
+    imb = (Imbal *) GPTLallocate (MAX (nregions, 1) * sizeof (Imbal), thisfunc);
+    nspots = 0;
+    for (n = 0; imb && n < nregions; ++n) {
+      if (global[n].notstopped == 0) {
+	imb[nspots].name = global[n].name;
+	imb[nspots].max  = global[n].wallmax;
+	imb[nspots].mean = global[n].mean;
+	imb[nspots].n    = global[n].tottsk;
+	imb[nspots].maxp = global[n].wallmax_p;
+	imb[nspots].maxt = global[n].wallmax_t;
+	imb[nspots].minp = global[n].wallmin_p;
+	imb[nspots].mint = global[n].wallmin_t;
+	++nspots;
+      }
+    }
+    if (imb)
+      GPTLprint_imbalance (fp, imb, nspots, "ranks", true, multithread);
+    free (imb);
+
+    if (GPTLdump_enabled () &&
+	(recs = (Dumprec *) GPTLallocate (MAX (nregions, 1) * sizeof (Dumprec), thisfunc))) {
+      memset (recs, 0, MAX (nregions, 1) * sizeof (Dumprec));
+      nspots = 0;
+      for (n = 0; n < nregions; ++n) {
+	if (global[n].notstopped == 0) {
+	  strcpy (recs[nspots].name, global[n].name);
+	  recs[nspots].nranks  = global[n].tottsk;
+	  recs[nspots].ncalls  = global[n].totcalls;
+	  recs[nspots].mean    = global[n].mean;
+	  recs[nspots].stddev  = (global[n].tottsk > 1) ? 
+	    sqrt (global[n].m2 / (global[n].tottsk - 1)) : 0.;
+	  recs[nspots].median  = GPTLsketch_quantile (&global[n].sketch, 0.5);
+	  recs[nspots].p95     = GPTLsketch_quantile (&global[n].sketch, 0.95);
+	  recs[nspots].wallmax = global[n].wallmax;
+	  recs[nspots].wallmin = global[n].wallmin;
+	  ++nspots;
+	}
+      }
+      (void) GPTLwrite_dump (outfile, recs, nspots, nranks);
+      free (recs);
+    }
+
+    if (fp != stderr && GPTLoutbuf_close (&ob) != 0)
       fprintf (stderr, "Attempt to close %s failed\n", outfile);
   }
   free (global);
+  return send_complete (&send, iam);
+}
+
+/*
+** tree_merge: Merge the region stats of all ranks of comm onto rank 0 of comm
+**
+** Input arguments:
+**   comm:        communicator to merge over
+**   iam:         rank in the summary communicator (for messages)
+**
+** Input/output arguments:
+**   global:      region stats: on return to rank 0 of comm, merged over comm. May be realloc'd
+**   nregions:    number of entries in global
+**   multithread: whether any rank merged so far is multithreaded
+**   mnl:         max name length over the regions merged so far
+**
+** Output arguments:
+**   send:        on ranks other than 0 of comm, the posted send of the merged stats
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+static int tree_merge (MPI_Comm comm, const int iam, Global **global_io, int *nregions_io,
+		       int *multithread, int *mnl, Sendreq *send)
+{
+  int ret;             /* return code from MPI */
+  int err = 0;         /* return code of the receive phase */
+  int me;              /* my rank in comm */
+  int nranks;          /* number of ranks in comm */
+  int incr;            /* increment for tree sum */
+  int nchild;          /* number of ranks which send to me */
+  int i;               /* child index: child i is rank me + 2^i */
+  int next;            /* next child whose stats are to be merged */
+  int n;               /* region index */
+  int hdrs[MAXCHILD][3];          /* headers received from children */
+  char *bufs[MAXCHILD];           /* packed stats received from children */
+  int done[MAXCHILD];             /* whether bufs[i] has arrived */
+  MPI_Request reqs[2*MAXCHILD];   /* header receives, then stats receives */
+  MPI_Status status;   /* required by MPI_Waitany */
+  size_t nbytes;       /* bytes of packed stats to send */
+  static const int tag = 98789;                         /* tag for MPI message */
+  static const char *thisfunc = "tree_merge";
+
+  if ((ret = MPI_Comm_rank (comm, &me)) != MPI_SUCCESS)
+    return GPTLerror ("%s: Bad return from MPI_Comm_rank=%d\n", thisfunc, ret);
+  if ((ret = MPI_Comm_size (comm, &nranks)) != MPI_SUCCESS)
+    return GPTLerror ("%s rank %d: Bad return from MPI_Comm_size=%d\n", thisfunc, iam, ret);
+
+  /* 
+  ** If all ranks participate in a region, could use MPI_Reduce to get mean and variance.
+  ** But we can't assume that, so instead code the parallel algorithm by hand. 
+  ** Log(ntask) algorithm to gather results to a single task is Jim Rosinski's concoction.
+  ** One-pass algorithm for gathering mean and standard deviation comes from Chan et. al.
+  ** (1979) described in: http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
+  ** Discovered by googling for "one pass standard deviation" which found the Wikipedia
+  ** page pointing to the Chan et. al. work. I'm not enough of a statistical whiz to
+  ** be able to map the simple 3-line algorithm in the Wikipedia page (see "Parallel 
+  ** algorithm") to anything in the Chan et. al. work, but it does work.
+  **
+  ** Rank me receives from me+incr for each incr = 1, 2, 4, ... until (me % 2*incr) != 0,
+  ** then sends its merged stats to me-incr. All receives are posted up front and each
+  ** child's stats are received as soon as its header arrives, so children never wait
+  ** in a send while earlier children are being merged. Merging is still done in child
+  ** order so the region order of the report does not depend on message arrival order.
+  ** The me + incr < nranks test prevents receiving from outside communicator bounds
+  ** when nranks is not a power of 2.
+  */
+  nchild = 0;
+  for (incr = 1; incr < nranks && me % (2*incr) == 0; incr *= 2)
+    if (me + incr < nranks)
+      ++nchild;
+
+  for (i = 0; i < nchild; ++i) {
+    bufs[i] = 0;
+    done[i] = false;
+    reqs[i] = MPI_REQUEST_NULL;
+    reqs[nchild+i] = MPI_REQUEST_NULL;
+  }
+  for (i = 0; i < nchild && err == 0; ++i)
+    if ((ret = MPI_Irecv (hdrs[i], 3, MPI_INT, me + (1 << i), tag, comm, &reqs[i])) != MPI_SUCCESS)
+      err = GPTLerror ("%s rank %d: Bad return from MPI_Irecv=%d\n", thisfunc, iam, ret);
+
+  for (next = 0; next < nchild && err == 0; ) {
+    if ((ret = MPI_Waitany (2*nchild, reqs, &i, &status)) != MPI_SUCCESS) {
+      err = GPTLerror ("%s rank %d: Bad return from MPI_Waitany=%d\n", thisfunc, iam, ret);
+      break;
+    }
+
+    if (i < nchild) {      /* header: post the receive of the stats it describes */
+      if ( ! (bufs[i] = (char *) GPTLallocate (MAX (hdrs[i][2], 1), thisfunc))) {
+        err = GPTLerror ("%s rank %d: cannot allocate receive buffer\n", thisfunc, iam);
+        break;
+      }
+      ret = MPI_Irecv (bufs[i], hdrs[i][2], MPI_BYTE, me + (1 << i), tag, comm, &reqs[nchild+i]);
+      if (ret != MPI_SUCCESS) {
+        err = GPTLerror ("%s rank %d: Bad return from MPI_Irecv=%d\n", thisfunc, iam, ret);
+        break;
+      }
+    } else {
+      done[i-nchild] = true;
+    }
+
+    /* Merge whatever is now available in child order, overlapping outstanding receives */
+    for ( ; next < nchild && done[next] && err == 0; ++next) {
+      err = merge_stats (bufs[next], hdrs[next], me + (1 << next), iam,
+                         global_io, nregions_io, multithread, mnl);
+      free (bufs[next]);
+      bufs[next] = 0;
+    }
+  }
+
+  /* On failure, cancel the receives still posted before freeing the buffers they fill */
+  if (err != 0) {
+    for (i = 0; i < 2*nchild; ++i)
+      if (reqs[i] != MPI_REQUEST_NULL)
+        (void) MPI_Cancel (&reqs[i]);
+    (void) MPI_Waitall (2*nchild, reqs, MPI_STATUSES_IGNORE);
+    for (i = 0; i < nchild; ++i)
+      free (bufs[i]);
+    return err;
+  }
+
+  if (me == 0)
+    return 0;
+
+  /*
+  ** Send packed stats rather than raw structs: most of each name and sketch is unused.
+  ** The sends are left outstanding (see Sendreq): waiting here would hold this rank until
+  ** its parent had received, just as a blocking send does for large messages.
+  */
+  if ( ! (send->buf = (char *) GPTLallocate (MAX (*nregions_io, 1) * PACK_MAX, thisfunc)))
+    return GPTLerror ("%s rank %d: cannot allocate send buffer\n", thisfunc, iam);
+  nbytes = 0;
+  for (n = 0; n < *nregions_io; ++n)
+    nbytes += pack_global (send->buf + nbytes, &(*global_io)[n]);
+  send->hdr[0] = *nregions_io;
+  send->hdr[1] = *multithread;
+  send->hdr[2] = (int) nbytes;
+  ret = MPI_Isend (send->hdr, 3, MPI_INT, me - incr, tag, comm, &send->reqs[0]);
+  if (ret != MPI_SUCCESS)
+    return GPTLerror ("%s rank %d: Bad return from MPI_Isend=%d\n", thisfunc, iam, ret);
+  ret = MPI_Isend (send->buf, send->hdr[2], MPI_BYTE, me - incr, tag, comm, &send->reqs[1]);
+  if (ret != MPI_SUCCESS)
+    return GPTLerror ("%s rank %d: Bad return from MPI_Isend=%d\n", thisfunc, iam, ret);
   return 0;
 }
 
+#if ( MPI_VERSION >= 3 )
+/*
+** node_merge: Merge the region stats of all ranks of comm onto rank 0 of comm, first
+**   within each shared-memory node, then across the node leaders (rank 0 of each node),
+**   and set the per-node imbalance on the way
+**
+** Input arguments:
+**   comm:        communicator to merge over
+**   iam:         rank in comm
+**
+** Input/output arguments:
+**   global, nregions, multithread, mnl: as for tree_merge
+**
+** Output arguments:
+**   send:        as for tree_merge
+**   nnodes:      number of nodes, on node leaders
+**
+** Return value: 0 (success), 1 (no node communicator: merge otherwise) or GPTLerror (failure)
+*/
+static int node_merge (MPI_Comm comm, const int iam, Global **global_io, int *nregions_io,
+		       int *multithread, int *mnl, Sendreq *send, int *nnodes)
+{
+  MPI_Comm nodecomm = MPI_COMM_NULL;    /* ranks sharing my node */
+  MPI_Comm leadercomm = MPI_COMM_NULL;  /* rank 0 of each node */
+  int noderank = -1;   /* my rank in nodecomm */
+  int ret;             /* return code from MPI */
+  int err = 0;         /* return code of this function */
+  int n;               /* region index */
+  static const char *thisfunc = "node_merge";
+
+  if (MPI_Comm_split_type (comm, MPI_COMM_TYPE_SHARED, iam, MPI_INFO_NULL, &nodecomm) != MPI_SUCCESS)
+    return 1;
+
+  if ((ret = MPI_Comm_rank (nodecomm, &noderank)) != MPI_SUCCESS)
+    err = GPTLerror ("%s rank %d: Bad return from MPI_Comm_rank=%d\n", thisfunc, iam, ret);
+  else if (tree_merge (nodecomm, iam, global_io, nregions_io, multithread, mnl, send) != 0)
+    err = GPTLerror ("%s rank %d: failure merging within node\n", thisfunc, iam);
+
+  if (err == 0) {
+    if (noderank == 0) {
+      for (n = 0; n < *nregions_io; ++n) {
+	if ((*global_io)[n].mean > 0.)
+	  (*global_io)[n].nodeimb = 100. * ((*global_io)[n].wallmax / (*global_io)[n].mean - 1.);
+	(*global_io)[n].nodeimb_p = iam;
+      }
+    }
+    ret = MPI_Comm_split (comm, noderank == 0 ? 0 : MPI_UNDEFINED, iam, &leadercomm);
+    if (ret != MPI_SUCCESS)
+      err = GPTLerror ("%s rank %d: Bad return from MPI_Comm_split=%d\n", thisfunc, iam, ret);
+  }
+
+  if (err == 0 && noderank == 0) {
+    if ((ret = MPI_Comm_size (leadercomm, nnodes)) != MPI_SUCCESS)
+      err = GPTLerror ("%s rank %d: Bad return from MPI_Comm_size=%d\n", thisfunc, iam, ret);
+    else if (tree_merge (leadercomm, iam, global_io, nregions_io, multithread, mnl, send) != 0)
+      err = GPTLerror ("%s rank %d: failure merging across nodes\n", thisfunc, iam);
+  }
+
+  if (nodecomm != MPI_COMM_NULL)
+    (void) MPI_Comm_free (&nodecomm);
+  if (leadercomm != MPI_COMM_NULL)
+    (void) MPI_Comm_free (&leadercomm);
+  return err;
+}
+#endif
+
+/*
+** send_complete: Wait for the send posted by tree_merge, if any, and free its buffer
+**
+** Input arguments:
+**   iam: rank in the summary communicator (for messages)
+**
+** Input/output arguments:
+**   send: send to complete
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+static int send_complete (Sendreq *send, const int iam)
+{
+  int ret;
+  static const char *thisfunc = "send_complete";
+
+  ret = MPI_Waitall (2, send->reqs, MPI_STATUSES_IGNORE);
+  free (send->buf);
+  send->buf = 0;
+  if (ret != MPI_SUCCESS)
+    return GPTLerror ("%s rank %d: Bad return from MPI_Waitall=%d\n", thisfunc, iam, ret);
+  return 0;
+}
+
+/*
+** merge_stats: Merge the packed stats received from one rank into the stats so far
+**
+** Input arguments:
+**   buf:         packed stats
+**   hdr:         message header: nregions, multithread, bytes in buf
+**   p:           rank in the merge communicator the stats came from (for messages)
+**   iam:         rank in the summary communicator (for messages)
+**
+** Input/output arguments:
+**   global, nregions, multithread, mnl: as for tree_merge
+**
+** Return value: 0 (success) or GPTLerror (failure)
+*/
+static int merge_stats (const char *buf, const int *hdr, const int p, const int iam,
+			Global **global_io, int *nregions_io, int *multithread, int *mnl)
+{
+  int nregions;        /* number of regions aggregated so far */
+  int nregions_p;      /* number of regions for a single task */
+  int n, nn;           /* region index */
+  size_t nbytes;       /* bytes unpacked from buf */
+  Global *global;      /* stats accumulated across tasks */
+  Global *global_p;    /* stats for a single task */
+  Global *sptr;        /* realloc intermediate */
+  double delta;        /* from Chan, et. al. */
+  unsigned int tsksum; /* part of Chan, et. al. equation */
+#ifdef HAVE_PAPI
+  int e;               /* event index */
+#endif
+  static const char *thisfunc = "merge_stats";
+
+  global = *global_io;
+  nregions = *nregions_io;
+  nregions_p = hdr[0];
+  if (hdr[1])
+    *multithread = true;
+
+  if ( ! (global_p = (Global *) GPTLallocate (MAX (nregions_p, 1) * sizeof (Global), thisfunc)))
+    return GPTLerror ("%s rank %d: cannot allocate receive buffers\n", thisfunc, iam);
+  nbytes = 0;
+  for (n = 0; n < nregions_p; ++n)
+    nbytes += unpack_global (buf + nbytes, &global_p[n]);
+  if (nbytes != (size_t) hdr[2]) {
+    free (global_p);
+    return GPTLerror ("%s rank %d: packed stats from rank %d have %d bytes, expected %lu\n",
+                      thisfunc, iam, p, hdr[2], (unsigned long) nbytes);
+  }
+      
+  /* Merge stats for task p with our current stats */
+  for (n = 0; n < nregions_p; ++n) {
+    for (nn = 0; nn < nregions; ++nn) {
+      if (STRMATCH (global_p[n].name, global[nn].name)) {
+        break;
+      }
+    }
+
+    if (nn == nregions) {  /* new region: reallocate and copy stats */
+      ++nregions;
+      sptr = realloc (global, nregions * sizeof (Global));
+      if ( ! sptr) {
+        free (global_p);
+        *global_io = global;
+        *nregions_io = nregions - 1;
+        return GPTLerror ("%s: realloc error", thisfunc);
+      }
+      global = sptr;
+      global[nn] = global_p[n];
+      *mnl = MAX (strlen (global[nn].name), *mnl);
+
+    } else {               /* adjust stats for region */
+
+      /* Won't print this entry if it was on for any rank or thread */
+      global[nn].notstopped += global_p[n].notstopped;
+      global[nn].totcalls   += global_p[n].totcalls; /* count is cumulative */
+      ksum_merge (&global[nn].wallsum, &global_p[n].wallsum);
+      ksum_merge (&global[nn].exclsum, &global_p[n].exclsum);
+      ksum_merge (&global[nn].ohdsum, &global_p[n].ohdsum);
+      if (global_p[n].nodeimb > global[nn].nodeimb) {
+        global[nn].nodeimb   = global_p[n].nodeimb;
+        global[nn].nodeimb_p = global_p[n].nodeimb_p;
+      }
+      if (global_p[n].wallmax > global[nn].wallmax) {
+        global[nn].wallmax   = global_p[n].wallmax;
+        global[nn].wallmax_p = global_p[n].wallmax_p;
+        global[nn].wallmax_t = global_p[n].wallmax_t;
+      }
+      if (global_p[n].wallmin < global[nn].wallmin) {
+        global[nn].wallmin   = global_p[n].wallmin;
+        global[nn].wallmin_p = global_p[n].wallmin_p;
+        global[nn].wallmin_t = global_p[n].wallmin_t;
+      }
+
+      /* Mean, variance calcs. Cast to double avoids possible integer overflow */
+      tsksum = global_p[n].tottsk + global[nn].tottsk;
+      delta  = global_p[n].mean   - global[nn].mean;
+      global[nn].mean += (delta * global_p[n].tottsk) / tsksum;
+      global[nn].m2   += global_p[n].m2 + 
+        delta * delta * ((double) global_p[n].tottsk * global[nn].tottsk) / tsksum;
+      global[nn].tottsk = tsksum;
+      GPTLsketch_merge (&global[nn].sketch, &global_p[n].sketch);
+
+#ifdef HAVE_PAPI
+      for (e = 0; e < GPTLnevents; ++e) {
+        if (global_p[n].papimax[e] > global[nn].papimax[e]) {
+          global[nn].papimax[e]   = global_p[n].papimax[e];
+          global[nn].papimax_p[e] = global_p[n].papimax_p[e];
+          global[nn].papimax_t[e] = global_p[n].papimax_t[e];
+        }
+        if (global_p[n].papimin[e] < global[nn].papimin[e]) {
+          global[nn].papimin[e]   = global_p[n].papimin[e];
+          global[nn].papimin_p[e] = global_p[n].papimin_p[e];
+          global[nn].papimin_t[e] = global_p[n].papimin_t[e];
+        }
+      }
+#endif
+    }
+  }
+  free (global_p);
+
+  *global_io = global;
+  *nregions_io = nregions;
+  return 0;
+}
+
+/*
+** pack_global, unpack_global: Convert one region's stats to and from the wire format
+**   sent by tree_merge: fields in a fixed order, the name without its unused tail, PAPI
+**   stats only for the events in use, and only the occupied centroids of the sketch.
+**   Assumes all ranks share a data representation, as the raw struct copy it replaces did.
+**
+** Return value: number of bytes written to or read from buf
+*/
+#define PUT(X) (memcpy (p, &(X), sizeof (X)), p += sizeof (X))
+#define GET(X) (memcpy (&(X), p, sizeof (X)), p += sizeof (X))
+
+static size_t pack_global (char *buf, const Global *g)
+{
+  char *p = buf;
+  unsigned char len = (unsigned char) strlen (g->name);  /* at most MAX_CHARS */
+  unsigned char nc = (unsigned char) g->sketch.n;        /* at most SKETCH_SIZE */
+#ifdef HAVE_PAPI
+  int e;
+#endif
+
+  PUT (len);
+  memcpy (p, g->name, len);
+  p += len;
+  PUT (g->totcalls);
+  PUT (g->wallsum);
+  PUT (g->exclsum);
+  PUT (g->ohdsum);
+  PUT (g->notstopped);
+  PUT (g->tottsk);
+  PUT (g->wallmax);
+  PUT (g->wallmin);
+  PUT (g->mean);
+  PUT (g->m2);
+  PUT (g->wallmax_p);
+  PUT (g->wallmax_t);
+  PUT (g->wallmin_p);
+  PUT (g->wallmin_t);
+  PUT (g->nodeimb);
+  PUT (g->nodeimb_p);
+#ifdef HAVE_PAPI
+  for (e = 0; e < GPTLnevents; ++e) {
+    PUT (g->papimax[e]);
+    PUT (g->papimin[e]);
+    PUT (g->papimax_p[e]);
+    PUT (g->papimax_t[e]);
+    PUT (g->papimin_p[e]);
+    PUT (g->papimin_t[e]);
+  }
+#endif
+  PUT (nc);
+  memcpy (p, g->sketch.c, nc * sizeof (Centroid));
+  p += nc * sizeof (Centroid);
+  return p - buf;
+}
+
+static size_t unpack_global (const char *buf, Global *g)
+{
+  const char *p = buf;
+  unsigned char len;
+  unsigned char nc;
+#ifdef HAVE_PAPI
+  int e;
+#endif
+
+  memset (g, 0, sizeof (Global));
+  GET (len);
+  memcpy (g->name, p, len);
+  g->name[len] = '\0';
+  p += len;
+  GET (g->totcalls);
+  GET (g->wallsum);
+  GET (g->exclsum);
+  GET (g->ohdsum);
+  GET (g->notstopped);
+  GET (g->tottsk);
+  GET (g->wallmax);
+  GET (g->wallmin);
+  GET (g->mean);
+  GET (g->m2);
+  GET (g->wallmax_p);
+  GET (g->wallmax_t);
+  GET (g->wallmin_p);
+  GET (g->wallmin_t);
+  GET (g->nodeimb);
+  GET (g->nodeimb_p);
+#ifdef HAVE_PAPI
+  for (e = 0; e < GPTLnevents; ++e) {
+    GET (g->papimax[e]);
+    GET (g->papimin[e]);
+    GET (g->papimax_p[e]);
+    GET (g->papimax_t[e]);
+    GET (g->papimin_p[e]);
+    GET (g->papimin_t[e]);
+  }
+#endif
+  GET (nc);
+  g->sketch.n = nc;
+  memcpy (g->sketch.c, p, nc * sizeof (Centroid));
+  p += nc * sizeof (Centroid);
+  return p - buf;
+}
+
+#undef PUT
+#undef GET
+
 int GPTLpr_summary (MPI_Comm comm)       /* communicator */
 {
   static const char *outfile = "timing.summary";   /* file to write to */
@@ -382,16 +855,22 @@ int GPTLpr_summary (MPI_Comm comm)       /* communicator */
 int GPTLpr_summary_file (const char *outfile)
 {
   FILE *fp = 0;        /* file handle */
+  Outbuf ob;           /* buffered output state for fp */
   Timer **timers;
   int multithread;     /* flag indicates multithreaded or not */
   int mnl;             /* max name length across all threads */
-  int extraspace;      /* for padding to length of longest name */
-  int n;
 #ifdef HAVE_PAPI
   int e;               /* event index */
 #endif
   Global global;       /* stats to be printed */
   Timer *ptr;
+  Hotspot *spots;      /* regions to be ranked by GPTLprint_hotspots */
+  int nspots = 0;      /* number of entries in spots */
+  Imbal *imb;          /* regions to be ranked by GPTLprint_imbalance */
+  Dumprec *recs = 0;   /* regions to be written by GPTLwrite_dump */
+  int nregions;        /* number of regions on thread 0 */
+  double self_ohd;     /* estimated per-call overhead in the timer itself */
+  double parent_ohd;   /* estimated per-call overhead subsumed into the parent */
   static const char *thisfunc = "GPTLpr_summary_file";  /* this function */
 
   if ( ! GPTLis_initialized ())
@@ -400,7 +879,7 @@ int GPTLpr_summary_file (const char *outfile)
   nthreads = GPTLget_nthreads ();   /* get_threadstats() needs to know this value too */
   multithread = (nthreads > 1);
 
-  if ( ! (fp = fopen (outfile, "w"))) {
+  if ( ! (fp = GPTLoutbuf_open (&ob, outfile))) {
     fp = stderr;
     printf ("%s: WARNING: file=%s cannot be opened for writing. Using stderr instead\n",
 	    thisfunc, outfile);
@@ -413,16 +892,12 @@ int GPTLpr_summary_file (const char *outfile)
   fprintf (fp, "nthreads=%d\n", nthreads);
   fprintf (fp, "'ncalls': number of times the region was invoked across threads.\n");
 
-  fprintf (fp, "\nname");
-
   mnl = 0;
   timers = GPTLget_timersaddr ();
   for (ptr = timers[0]->next; ptr; ptr = ptr->next)
     mnl = MAX (strlen (ptr->name), mnl);
 
-  extraspace = mnl - strlen ("name");
-  for (n = 0; n < extraspace; ++n)
-    fprintf (fp, " ");
+  fprintf (fp, "\n%-*s", mnl, "name");
 
   if (multithread)
     fprintf (fp, "   ncalls   wallmax (thred)   wallmin (thred)");
@@ -439,13 +914,17 @@ int GPTLpr_summary_file (const char *outfile)
 #endif
   fprintf (fp, "\n");
 
-  for (ptr = timers[0]->next; ptr; ptr = ptr->next) {
-    get_threadstats (0, ptr->name, timers, &global);
-    extraspace = mnl - strlen (global.name);
+  (void) GPTLget_overhead_est (&self_ohd, &parent_ohd);
+  (void) GPTLget_nregions (0, &nregions);
+  spots = (Hotspot *) GPTLallocate (MAX (nregions, 1) * sizeof (Hotspot), thisfunc);
+  imb = (Imbal *) GPTLallocate (MAX (nregions, 1) * sizeof (Imbal), thisfunc);
+  if (GPTLdump_enabled () &&
+      (recs = (Dumprec *) GPTLallocate (MAX (nregions, 1) * sizeof (Dumprec), thisfunc)))
+    memset (recs, 0, MAX (nregions, 1) * sizeof (Dumprec));
 
-    fprintf (fp, "%s", global.name);
-    for (n = 0; n < extraspace; ++n)
-      fprintf (fp, " ");
+  for (ptr = timers[0]->next; ptr; ptr = ptr->next) {
+    get_threadstats (0, ptr->name, timers, self_ohd + parent_ohd, &global);
+    fprintf (fp, "%-*s", mnl, global.name);
 
     /* 
     ** Don't print stats if the timer is currently on for any thread or task: too dangerous 
@@ -456,9 +935,35 @@ int GPTLpr_summary_file (const char *outfile)
       continue;
     }
 
+    /* global.name is overwritten each iteration so point at the timer's copy */
+    spots[nspots].name  = ptr->name;
+    spots[nspots].incl  = ksum_val (&global.wallsum);
+    spots[nspots].excl  = ksum_val (&global.exclsum);
+    spots[nspots].ohd   = ksum_val (&global.ohdsum);
+    spots[nspots].count = global.totcalls;
+    imb[nspots].name = ptr->name;
+    imb[nspots].max  = global.wallmax;
+    imb[nspots].mean = ksum_val (&global.wallsum) / MAX (global.tottsk, 1);
+    imb[nspots].n    = global.tottsk;
+    imb[nspots].maxp = global.wallmax_p;
+    imb[nspots].maxt = global.wallmax_t;
+    imb[nspots].minp = global.wallmin_p;
+    imb[nspots].mint = global.wallmin_t;
+    if (recs) {     /* one rank: its max over threads is the mean and every percentile */
+      strcpy (recs[nspots].name, ptr->name);
+      recs[nspots].nranks  = 1;
+      recs[nspots].ncalls  = global.totcalls;
+      recs[nspots].mean    = global.wallmax;
+      recs[nspots].median  = global.wallmax;
+      recs[nspots].p95     = global.wallmax;
+      recs[nspots].wallmax = global.wallmax;
+      recs[nspots].wallmin = global.wallmin;
+    }
+    ++nspots;
+
     if (multithread) {
       if (global.totcalls < PRTHRESH) {
-	fprintf (fp, " %8lu %9.3f (%5d) %9.3f (%5d)", 
+	fprintf (fp, " %8llu %9.3f (%5d) %9.3f (%5d)", 
 		 global.totcalls, global.wallmax, global.wallmax_t, global.wallmin, global.wallmin_t);
       } else {
 	fprintf (fp, " %8.1e %9.3f (%5d) %9.3f (%5d)", 
@@ -466,7 +971,7 @@ int GPTLpr_summary_file (const char *outfile)
       }
     } else {  /* No threads */
       if (global.totcalls < PRTHRESH) {
-	fprintf (fp, " %8lu %9.3f",          global.totcalls, global.wallmax);
+	fprintf (fp, " %8llu %9.3f",         global.totcalls, global.wallmax);
       } else {
 	fprintf (fp, " %8.1e %9.3f", (float) global.totcalls, global.wallmax);
       }
@@ -484,7 +989,21 @@ int GPTLpr_summary_file (const char *outfile)
 #endif
     fprintf (fp, "\n");
   }
-  if (fp != stderr && fclose (fp) != 0)
+
+  GPTLprint_hotspots (fp, spots, nspots, "summed over threads");
+  GPTLprint_ohdwarn (fp, spots, nspots, self_ohd + parent_ohd);
+  free (spots);
+
+  /* Imbalance across the threads which invoked each region */
+  GPTLprint_imbalance (fp, imb, nspots, "threads", false, true);
+  free (imb);
+
+  if (recs) {
+    (void) GPTLwrite_dump (outfile, recs, nspots, 1);
+    free (recs);
+  }
+
+  if (fp != stderr && GPTLoutbuf_close (&ob) != 0)
     fprintf (stderr, "Attempt to close %s failed\n", outfile);
 
   return 0;
@@ -508,6 +1027,7 @@ int GPTLpr_summary ()       /* communicator */
 **   iam:    my rank
 **   name:   timer name
 **   timers: array of linked lists of timers
+**   ohd:    estimated GPTL overhead per call (self + parent)
 **   global: pointer to struct containing stats
 ** Output arguments:
 **   global: max/min stats over all threads
@@ -515,10 +1035,13 @@ int GPTLpr_summary ()       /* communicator */
 static void get_threadstats (int iam,
 			     char *name,
 			     Timer **timers,
+			     double ohd,
 			     Global *global)
 {
   int t;                /* thread index */
   Timer *ptr;
+  double incl;          /* wallclock, less GPTL overhead if GPTLsubtract_ohd was set */
+  double excl;          /* exclusive wallclock, likewise */
   static const char *thisfunc = "get_threadstats";
 
   /* This memset fortuitiously initializes the process values to master (0) */
@@ -531,17 +1054,22 @@ static void get_threadstats (int iam,
       if (ptr->onflg)
 	++global->notstopped;
 
+      GPTLget_wallstats_adj (ptr, t, &incl, &excl);
       global->totcalls += ptr->count;
+      ++global->tottsk;        /* threads here: the MPI summary resets it to count tasks */
+      ksum_add (&global->wallsum, incl);
+      ksum_add (&global->exclsum, excl);
+      ksum_add (&global->ohdsum, ptr->count * ohd);
 
-      if (ptr->wall.accum > global->wallmax) {
-        global->wallmax   = ptr->wall.accum;
+      if (incl > global->wallmax) {
+        global->wallmax   = incl;
         global->wallmax_p = iam;
         global->wallmax_t = t;
       }
 
       /* global->wallmin = 0 for first thread */
-      if (ptr->wall.accum < global->wallmin || global->wallmin == 0.) {
-        global->wallmin   = ptr->wall.accum;
+      if (incl < global->wallmin || global->wallmin == 0.) {
+        global->wallmin   = incl;
         global->wallmin_p = iam;
         global->wallmin_t = t;
       }
@@ -571,6 +1099,37 @@ static void get_threadstats (int iam,
   }
 }
 
+/*
+** ksum_add: Add x to a compensated sum (Neumaier's variant of Kahan summation, which
+**   is also correct when x is larger in magnitude than the running sum)
+*/
+static void ksum_add (Ksum *ks, const double x)
+{
+  double t = ks->sum + x;
+
+  if (fabs (ks->sum) >= fabs (x))
+    ks->c += (ks->sum - t) + x;
+  else
+    ks->c += (x - t) + ks->sum;
+  ks->sum = t;
+}
+
+#ifdef HAVE_LIBMPI
+/*
+** ksum_merge: Add compensated sum "in" to "ks", keeping the rounding error of both
+*/
+static void ksum_merge (Ksum *ks, const Ksum *in)
+{
+  ksum_add (ks, in->sum);
+  ks->c += in->c;
+}
+#endif
+
+static double ksum_val (const Ksum *ks)
+{
+  return ks->sum + ks->c;
+}
+
 Timer *getentry_slowway (Timer *timer, char *name)
 {
   Timer *ptr = 0;
@@ -0,0 +1,170 @@
+/*
+** sketch.c
+**
+** Mergeable quantile sketch (a merging t-digest) used by GPTLpr_summary_file() to
+** report median and 95th percentile region times across ranks. A sketch is a fixed
+** size array of centroids (mean, weight), so it can be embedded in the structures
+** passed between ranks and its message size does not grow with the rank count.
+** While at most SKETCH_SIZE values have been merged nothing is compressed, and the
+** quantiles are exact.
+*/
+
+#include "config.h" /* Must be first include. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "private.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static int cmp_centroid (const void *, const void *);
+static int compress (Centroid *, int, Centroid *, double);
+static double kinv (double, double);
+
+/*
+** GPTLsketch_init: Set a sketch to hold the single value x
+*/
+void GPTLsketch_init (Sketch *sk, const double x)
+{
+  memset (sk, 0, sizeof (Sketch));
+  sk->c[0].mean = x;
+  sk->c[0].weight = 1.;
+  sk->n = 1;
+}
+
+/*
+** GPTLsketch_merge: Merge sketch "in" into sketch "sk"
+**
+** Input arguments:
+**   in: sketch to be merged
+**
+** Input/output arguments:
+**   sk: on output summarizes the values of both sketches
+*/
+void GPTLsketch_merge (Sketch *sk, const Sketch *in)
+{
+  Centroid all[2*SKETCH_SIZE];   /* centroids of both sketches, sorted by mean */
+  int nall;
+  double delta;                  /* compression parameter: roughly the centroids kept */
+
+  nall = sk->n + in->n;
+  memcpy (all, sk->c, sk->n * sizeof (Centroid));
+  memcpy (all + sk->n, in->c, in->n * sizeof (Centroid));
+  qsort (all, nall, sizeof (Centroid), cmp_centroid);
+
+  if (nall <= SKETCH_SIZE) {
+    memcpy (sk->c, all, nall * sizeof (Centroid));
+    sk->n = nall;
+    return;
+  }
+
+  /* Compress, tightening until the result fits */
+  for (delta = 2*SKETCH_SIZE; (sk->n = compress (all, nall, sk->c, delta)) < 0; delta *= 0.8)
+    ;
+}
+
+/*
+** GPTLsketch_quantile: Estimate the q quantile (0 <= q <= 1) of the values in a sketch,
+**   interpolating linearly between centroid centers
+**
+** Return value: the estimate, or 0 for an empty sketch
+*/
+double GPTLsketch_quantile (const Sketch *sk, const double q)
+{
+  double total = 0.;    /* total weight */
+  double target;        /* weight below the wanted quantile */
+  double cum = 0.;      /* weight below centroid i */
+  double center;        /* cumulative weight at the center of centroid i */
+  double prevcenter = 0.;
+  int i;
+
+  if (sk->n < 1)
+    return 0.;
+
+  for (i = 0; i < sk->n; ++i)
+    total += sk->c[i].weight;
+  target = q * total;
+
+  for (i = 0; i < sk->n; ++i) {
+    center = cum + 0.5 * sk->c[i].weight;
+    if (target <= center) {
+      if (i == 0)
+	return sk->c[0].mean;
+      return sk->c[i-1].mean + (sk->c[i].mean - sk->c[i-1].mean) *
+	(target - prevcenter) / (center - prevcenter);
+    }
+    prevcenter = center;
+    cum += sk->c[i].weight;
+  }
+  return sk->c[sk->n-1].mean;
+}
+
+/*
+** compress: Merge adjacent centroids so that each covers at most one unit of the
+**   t-digest k1 scale function k(q) = delta/(2 pi) asin(2q-1). This keeps centroids
+**   small near the tails, where p95 lives, and large near the median.
+**
+** Input arguments:
+**   in:    centroids sorted by mean
+**   nin:   number of entries in in
+**   delta: compression parameter
+**
+** Output arguments:
+**   out:   at most SKETCH_SIZE merged centroids
+**
+** Return value: number of centroids in out, or -1 if more than SKETCH_SIZE were needed
+*/
+static int compress (Centroid *in, int nin, Centroid *out, double delta)
+{
+  double total = 0.;    /* total weight */
+  double wsofar = 0.;   /* weight emitted before the current output centroid */
+  double wlimit;        /* max cumulative weight the current output centroid may reach */
+  double k;
+  int nout = 0;
+  int i;
+
+  for (i = 0; i < nin; ++i)
+    total += in[i].weight;
+
+  k = delta / (2. * M_PI) * asin (-1.);   /* k(0) */
+  wlimit = total * kinv (k + 1., delta);
+
+  out[0] = in[0];
+  for (i = 1; i < nin; ++i) {
+    if (wsofar + out[nout].weight + in[i].weight <= wlimit) {
+      out[nout].mean += (in[i].mean - out[nout].mean) * in[i].weight /
+	(out[nout].weight + in[i].weight);
+      out[nout].weight += in[i].weight;
+    } else {
+      wsofar += out[nout].weight;
+      if (++nout == SKETCH_SIZE)
+	return -1;
+      out[nout] = in[i];
+      k = delta / (2. * M_PI) * asin (2. * wsofar / total - 1.);
+      wlimit = total * kinv (k + 1., delta);
+    }
+  }
+  return nout + 1;
+}
+
+/*
+** kinv: Inverse of the scale function: the quantile at which k(q) = k
+*/
+static double kinv (double k, double delta)
+{
+  if (k >= delta / 4.)   /* k(1) */
+    return 1.;
+  return 0.5 * (sin (k * 2. * M_PI / delta) + 1.);
+}
+
+static int cmp_centroid (const void *a, const void *b)
+{
+  const Centroid *ca = (const Centroid *) a;
+  const Centroid *cb = (const Centroid *) b;
+
+  return (ca->mean > cb->mean) - (ca->mean < cb->mean);
+}